@@ -21,6 +21,43 @@
 #define DROP_THRESHOLD 0.1f //!< Start dropping frames when detecting at least 100ms lag
 #define SEEK_THRESHOLD 5.0f //!< Start seeking when detecting at least 5s lag
 
+#define VISIBILITY_FRAMES 10 //!< Video counts as hidden when none of its outputs was rendered within the last x frames
+
+#define DECIMATION_HALF 20.0f //!< Present only every 2nd frame of in-world videos farther away than x meters
+#define DECIMATION_QUARTER 40.0f //!< Present only every 4th frame of in-world videos farther away than x meters
+#define DECIMATION_KEYFRAMES 80.0f //!< Present only keyframes of in-world videos farther away than x meters
+
+#define POOL_SIZE 4 //!< Keep up to x unused video renderers (textures and conversion buffers) for reuse
+#define POOL_TIMEOUT 30.0f //!< Free unused pooled video renderers after x seconds
+
+#define LIVE_LATENCY 0.25f //!< Skip ahead to the next keyframe when a live video lags more than x seconds behind its input
+#define LIVE_MAXFRAMES 8 //!< Decode at most x frames of a live video per update, more waiting frames count as lag
+
+#define TRICK_SPEED 2.0f //!< Present only keyframes (fast-forward trick mode) at speeds of at least x
+#define REVERSE_BUDGET 128.0f //!< Memory in MB for the decoded frames of videos playing backwards (presented and prefetched GOP)
+#define LOOP_BUDGET 16.0f //!< Memory in MB shared by the decoded first GOPs of all looping videos (presented while the decoder goes back to the start)
+
+#define CLOCK_DRIFT 0.05f //!< Play at most x (5%) faster or slower to follow the sound clock
+#define CLOCK_RESYNC 0.25f //!< Jump to the sound position if the video clock differs more than x seconds (sound seek, loop or hitch)
+
+#define STATS_WINDOW 256 //!< Percentiles of the video statistics cover the last x samples
+
+#define SHADERITEM_CACHE 64 //!< Keep up to x shader items of material overrides for reuse (least recently used are released first)
+
+#define MEMORY_BUDGET 256.0f //!< Memory in MB for the decoders, conversion buffers and textures of all videos (idle videos hibernate when exceeded)
+#define HIBERNATE_DELAY 5.0f //!< Videos paused or hidden for at least x seconds can hibernate
+#define MEMORY_INTERVAL 0.25f //!< Check the memory budget and idle videos every x seconds
+
+#define LOAD_BUDGET 6.0f //!< Milliseconds per frame for decoding and converting all videos before lower priority classes are degraded
+#define LOAD_HOLD 30 //!< Frames the video load has to exceed the budget before the next degradation level (recovery takes 4 times as long)
+#define LOAD_LEVELS 4 //!< Degradation levels (see eVideoPriority for what each level does)
+
+#define PLAYLIST_CACHE 1 //!< Keep compiled playlists until their file changes
+#define CROSSFADE_BUDGET 6.0f //!< Milliseconds per frame for decoding, converting and blending all videos during playlist crossfades
+#define CROSSFADE_HOLD 10 //!< Frames a crossfade can exceed its budget before it falls back to a cut
+#define WARM_START 1 //!< Preload the next expected menu playlist
+#define PRELOAD_BUDGET 64.0f //!< Memory in MB for compressed video files of a level read ahead during the loading screen
+
 // CryEngine internal stuff that was just exposed in version 3.4 for backward compatibility defines those values here
 #ifndef SDK_VERSION_340
 #define VIRTUAL_SCREEN_WIDTH 800.0f //!< Width of the virtual screen, inside the plugin relative sizes are used.
@@ -67,7 +104,7 @@ namespace VideoplayerPlugin
         VTS_SystemTime = 4, //!< Use system time (supporting playback during pause)
         VTS_SoundOrGameTime = VTS_GameTime | VTS_Sound, //!< Use soundsource and fallback to game time if problems occur
         VTS_SoundOrSystemTime = VTS_SystemTime | VTS_Sound, //!< Use soundsource and fallback to system time if problems occur
-        VTS_Live = 8, //!< Display data as fast as it comes in (supporting playback during pause)
+        VTS_Live = 8, //!< Display data as fast as it comes in, the end of the file only means that no new data arrived yet (supporting playback during pause), WebM can be live-muxed (unknown sizes) and come from a local pipe (\\.\pipe\name)
         VTS_DefaultPlaylist = VTS_SoundOrSystemTime, //!< Current default playlist setting
         VTS_Default = VTS_SoundOrGameTime, //!< Current default setting
     };
@@ -98,10 +135,39 @@ namespace VideoplayerPlugin
         VDM_DropOutput = 4, //!< Multiple decode calls until no difference is detected (postprocessing and output for these frames is disabled). will slow down game even further  to keep sync.
         VDM_DropOrSeek = VDM_Drop | VDM_Seek, //!< Good combination for not so important videos that can show artifacts (old default mode)
         VDM_DropOutputOrSeek = VDM_DropOutput | VDM_Seek, //!< Good combination for important videos (new default mode)
-        VDM_Live = 8, //!< Display most current frame
+        VDM_Live = 8, //!< Display most current frame, skips intermediate frames (droppable ones without decoding) and keeps the latency bounded (implies a live input @see VTS_Live)
         VDM_Default = VDM_DropOutputOrSeek, //!< Current default setting
     };
 
+    /**
+    * @brief Decode policy for videos whose outputs are not rendered
+    * A video is visible if its texture, one of its tracked render nodes or one of its 2D outputs
+    * was rendered within the last frames (cvar: vp_visibilityframes)
+    */
+    enum eVisibilityPolicy
+    {
+        VVP_AlwaysDecode = 0, //!< Decode regardless of visibility (old default mode)
+        VVP_PauseWhenHidden = 1, //!< Pause video and sound while hidden and continue at the same position when visible again
+        VVP_ClockOnlyWhenHidden = 2, //!< Keep the clock and sound running but don't decode while hidden, resync with a keyframe seek when visible again
+        VVP_Default = VVP_AlwaysDecode, //!< Current default setting
+    };
+
+    /**
+    * @brief Priority class of a video when the videos exceed their time budget (cvar: vp_loadbudget)
+    * Higher classes are decoded and uploaded first, lower classes are degraded first:
+    * far videos present every 2nd frame, then only keyframes, then only the clock runs;
+    * near videos follow one level later and UI videos two levels later. Critical videos are never degraded.
+    */
+    enum eVideoPriority
+    {
+        VPR_Critical = 0, //!< Critical 2D output (e.g. cutscene)
+        VPR_UI = 1, //!< Foreground UI
+        VPR_Near = 2, //!< In-world output near the camera
+        VPR_Far = 3, //!< In-world output far away
+        VPR_Auto = 4, //!< Derived from the outputs: 2D outputs count as UI, in-world ones as near or far by distance
+        VPR_Default = VPR_Auto, //!< Current default setting
+    };
+
     /**
     * @ingroup vp_interface
     * @brief Listener Interface for videoplayer events dispatched by a videoplayer
@@ -171,6 +237,8 @@ namespace VideoplayerPlugin
         * @brief Set playback speed
         * This parameter is only available if the video is not synchronized to sound time sources,
         * the reason for this is because the sound playback speed can not be set in a always working manner in CE3.
+        * At speeds of at least vp_trickspeed only keyframes are decoded and presented (fast-forward).
+        * Negative speeds play backwards: each GOP is decoded forward into a cache (vp_reversebudget) and presented in reverse.
         * @param fSpeed Speed as factor (1 means normal 0.5 means half speed and 2 means double speed)
         */
         virtual void SetSpeed( float fSpeed = 1.0f ) = 0;
@@ -278,6 +346,43 @@ namespace VideoplayerPlugin
 
     struct S2DVideo_;
 
+    /**
+    * @brief Percentiles of a rolling statistic window
+    * @see STATS_WINDOW
+    */
+    struct SVideoPercentiles
+    {
+        float fP50; //!< median
+        float fP95; //!< 95th percentile
+        float fP99; //!< 99th percentile
+        unsigned nSamples; //!< samples in the window
+    };
+
+    /**
+    * @brief Performance counters of a video
+    * Times are rolling windows of the last samples, counters are totals since the video was opened.
+    */
+    struct SVideoStats
+    {
+        const char* sFile; //!< video file (valid while the video is open)
+        SVideoPercentiles decode; //!< decode time per decoder call in microseconds
+        SVideoPercentiles convert; //!< YUV to RGB conversion time per presented frame in microseconds
+        SVideoPercentiles upload; //!< texture upload time per frame in microseconds
+        SVideoPercentiles clockdrift; //!< absolute difference between sound and video clock in milliseconds
+        uint64 nBytesRead; //!< compressed bytes read
+        unsigned nFramesDecoded; //!< frames decoded
+        unsigned nFramesPresented; //!< frames converted for presentation
+        unsigned nFramesDropped; //!< frames decoded but never presented
+        unsigned nFramesSkipped; //!< frames read without decoding them (drops, decimation, trick mode, live catchup)
+        unsigned nSeeks; //!< seeks (requested or triggered by the drop modes)
+        float fClockDrift; //!< low-passed difference between sound and video clock in seconds
+        size_t nMemoryDecoder; //!< bytes of the decoder frame buffers and frame caches
+        size_t nMemoryStaging; //!< bytes of the conversion buffer
+        size_t nMemoryTexture; //!< bytes of the texture
+        bool bHibernating; //!< resources are freed until the video resumes @see vp_memorybudget
+        unsigned nHibernations; //!< times the video hibernated
+    };
+
     /**
     * @ingroup vp_interface
     * @brief Video playback specific interface
@@ -306,6 +411,7 @@ namespace VideoplayerPlugin
         * @param fEndAfter End playback/loop at specific position in seconds, Default 0
         * @param nCustomWidth Custom Width for render target (might not be used depending on renderer), Default -1
         * @param nCustomHeight Custom Height for render target (might not be used depending on renderer), Default -1
+        * @see SetPriority
         */
         virtual bool Open( const char* sFile, const char* sSoundOrEvent, bool bLoop = false, bool bSkippable = true, bool bBlockGame = false, eTimeSource eTS = VTS_Default, eDropMode eDM = VDM_Default, float fStartAt = 0, float fEndAfter = 0, int nCustomWidth = -1, int nCustomHeight = -1 ) = 0;
 
@@ -369,6 +475,55 @@ namespace VideoplayerPlugin
         * @param item Interface pointer of listener
         */
         virtual void UnregisterListener( IVideoplayerEventListener* item ) = 0;
+
+        // methods added later are appended, so binaries built against older headers keep their vtable slots
+
+        /**
+        * @brief Set how the video behaves while none of its outputs is visible
+        * @param eVP visibility policy
+        */
+        virtual void SetVisibilityPolicy( eVisibilityPolicy eVP = VVP_Default ) = 0;
+
+        /**
+        * @brief Get the visibility policy
+        * @return visibility policy
+        */
+        virtual eVisibilityPolicy GetVisibilityPolicy() = 0;
+
+        /**
+        * @brief Was any output of this video rendered recently
+        * @return true if the texture, a tracked render node or a 2D output was rendered in the last vp_visibilityframes frames
+        */
+        virtual bool IsVisible() = 0;
+
+        /**
+        * @brief Use the render node of an entity as additional visibility source
+        * Material overrides are detected by the texture itself, but instanced or shared materials are tracked more reliably by their render nodes.
+        * @param nEntityId Entity showing this video
+        * @param bTrack Start or stop tracking
+        */
+        virtual void TrackVisibility( EntityId nEntityId, bool bTrack = true ) = 0;
+
+        /**
+        * @brief Get the performance counters of this video
+        * @param[out] stats counters and percentiles
+        * @return video is open
+        * @see vp_stats
+        */
+        virtual bool GetStats( SVideoStats& stats ) = 0;
+
+        /**
+        * @brief Set which videos are degraded first when the videos exceed their time budget
+        * The priority class is kept when a video is opened again, so it can be set before Open.
+        * @param ePriority priority class
+        */
+        virtual void SetPriority( eVideoPriority ePriority = VPR_Default ) = 0;
+
+        /**
+        * @brief Get the priority class
+        * @return priority class as set (VPR_Auto isn't resolved)
+        */
+        virtual eVideoPriority GetPriority() = 0;
     };
 
     /**
@@ -619,5 +774,36 @@ namespace VideoplayerPlugin
         * @param pVideo video associated to the materials
         */
         virtual void OverrideMaterials( IVideoplayer* pVideo ) = 0;
+
+        // methods added later are appended, so binaries built against older headers keep their vtable slots
+
+        /**
+        * @brief Override material with a video that lowers its presentation rate when far away
+        * @return success
+        * @param pVideo Video to be shown
+        * @param pMaterial Material to be overridden
+        * @param nSubmat Sub material slot to be overridden
+        * @param nTextureslot Texture slot to be overridden
+        * @param bRecommendedSettings Sets shader to illum and set parameters
+        * @param fDecimationScale Scales the distance used to lower the presentation rate of far away videos (0 always presents every frame, >1 decimates earlier)
+        * @see OverrideMaterial
+        * @see vp_decimation
+        */
+        virtual bool OverrideMaterialDecimated( IVideoplayer* pVideo, IMaterial* pMaterial, int nSubmat = 0, int nTextureslot = EFTT_DIFFUSE, bool bRecommendedSettings = true, float fDecimationScale = 1.0f ) = 0;
+
+        /**
+        * @brief Override many materials with the same video in a single pass (e.g. a wall of screens)
+        * Materials with the same shader and parameters share one shader item.
+        * @return number of overridden materials
+        * @param pVideo Video to be shown
+        * @param pMaterials Materials to be overridden
+        * @param nMaterials Number of materials
+        * @param nSubmat Sub material slot to be overridden
+        * @param nTextureslot Texture slot to be overridden
+        * @param bRecommendedSettings Sets shader to illum and set parameters
+        * @param fDecimationScale Scales the distance used to lower the presentation rate of far away videos
+        * @see OverrideMaterial
+        */
+        virtual int OverrideMaterialBatch( IVideoplayer* pVideo, IMaterial** pMaterials, int nMaterials, int nSubmat = 0, int nTextureslot = EFTT_DIFFUSE, bool bRecommendedSettings = true, float fDecimationScale = 1.0f ) = 0;
     };
 };
@@ -3,6 +3,7 @@
 #include <StdAfx.h>
 #include <CPluginVideoplayer.h>
 #include <CVideoplayerSystem.h>
+#include <WebM/CCE3DecoderIO.h>
 
 namespace VideoplayerPlugin
 {
@@ -67,6 +68,10 @@ namespace VideoplayerPlugin
 
         if ( gEnv && gEnv->pSystem && !gEnv->pSystem->IsQuitting() )
         {
+            // decoder file access through the CryPak and log into the plugin log
+            setVPXDecIO( &gCE3DecoderIO );
+            setVPXDecLog( &gCE3DecoderIO );
+
             gVideoplayerSystem = new CVideoplayerSystem();
         }
 
@@ -92,7 +97,7 @@ namespace VideoplayerPlugin
 
     const char* CPluginVideoplayer::ListCVars() const
     {
-        return "vp_playbackmode, vp_seekthreshold, vp_dropthreshold, vp_dropmaxduration";
+        return "vp_playbackmode, vp_seekthreshold, vp_dropthreshold, vp_dropmaxduration, vp_visibilityframes, vp_decimation, vp_decimationhalf, vp_decimationquarter, vp_decimationkeyframes, vp_poolsize, vp_pooltimeout, vp_uploadbudget, vp_uploadtime, vp_nullrenderer, vp_nullchecksum, vp_livelatency, vp_trickspeed, vp_reversebudget, vp_loopbudget, vp_clockdrift, vp_memorybudget, vp_hibernatedelay, vp_loadbudget, vp_playlistcache, vp_crossfadebudget, vp_warmstart, vp_preloadbudget, vp_stats, vp_trace";
     }
 
     const char* CPluginVideoplayer::GetStatus() const
@@ -0,0 +1,77 @@
+/* Videoplayer_Plugin - for licensing and copyright see license.txt */
+
+#include <IPluginVideoplayer.h>
+#include <algorithm>
+
+#pragma once
+
+namespace VideoplayerPlugin
+{
+    /**
+    * @brief Rolling window of the last samples of a statistic
+    * Adding is constant time without allocations, percentiles are only sorted on query.
+    * @see STATS_WINDOW
+    */
+    class CVideoStatWindow
+    {
+        public:
+            CVideoStatWindow()
+            {
+                Reset();
+            }
+
+            /**
+            * @brief Remove all samples
+            */
+            void Reset()
+            {
+                m_nNext = 0;
+                m_nCount = 0;
+            }
+
+            /**
+            * @brief Add a sample, replaces the oldest one once the window is full
+            */
+            void Add( float fSample )
+            {
+                m_fSamples[m_nNext] = fSample;
+                m_nNext = ( m_nNext + 1 ) % STATS_WINDOW;
+                m_nCount = min( m_nCount + 1, unsigned( STATS_WINDOW ) );
+            }
+
+            /**
+            * @brief Nearest rank percentiles of the samples in the window (0 if empty)
+            * @param[out] percentiles p50, p95, p99
+            */
+            void GetPercentiles( SVideoPercentiles& percentiles ) const
+            {
+                percentiles.nSamples = m_nCount;
+
+                if ( !m_nCount )
+                {
+                    percentiles.fP50 = percentiles.fP95 = percentiles.fP99 = 0;
+                    return;
+                }
+
+                float fSorted[STATS_WINDOW];
+                std::copy( m_fSamples, m_fSamples + m_nCount, fSorted );
+                std::sort( fSorted, fSorted + m_nCount );
+
+                percentiles.fP50 = fSorted[Rank( 50 )];
+                percentiles.fP95 = fSorted[Rank( 95 )];
+                percentiles.fP99 = fSorted[Rank( 99 )];
+            }
+
+        private:
+            float m_fSamples[STATS_WINDOW]; //!< ring buffer
+            unsigned m_nNext; //!< next sample is written here
+            unsigned m_nCount; //!< valid samples
+
+            unsigned Rank( unsigned nPercent ) const
+            {
+                unsigned nRank = ( nPercent * m_nCount + 99 ) / 100; // 1 based
+
+                return nRank > 0 ? nRank - 1 : 0;
+            }
+    };
+}
@@ -5,6 +5,9 @@
 #include <CPluginVideoplayer.h>
 #include <WebM/CWebMWrapper.h>
 #include <Playlist/CVideoplayerPlaylist.h>
+#include <WebM/CCE3DecoderIO.h>
+#include <Flownodes/CFlowVideoInputPorts.h>
+#include <IFlowSystem.h>
 
 VideoplayerPlugin::CVideoplayerSystem* gVideoplayerSystem = NULL;
 
@@ -28,6 +31,43 @@ namespace VideoplayerPlugin
 
         // cvar
         vp_playbackmode = VPM_Default;
+        vp_visibilityframes = VISIBILITY_FRAMES;
+        vp_decimation = 0;
+        vp_poolsize = POOL_SIZE;
+        vp_uploadbudget = 0;
+        vp_uploadtime = 0;
+        vp_nullrenderer = 0;
+        vp_nullchecksum = 0;
+        vp_livelatency = LIVE_LATENCY;
+        vp_trickspeed = TRICK_SPEED;
+        vp_reversebudget = REVERSE_BUDGET;
+        vp_loopbudget = LOOP_BUDGET;
+        vp_clockdrift = CLOCK_DRIFT;
+        vp_memorybudget = MEMORY_BUDGET;
+        vp_hibernatedelay = HIBERNATE_DELAY;
+        vp_loadbudget = LOAD_BUDGET;
+        vp_playlistcache = PLAYLIST_CACHE;
+        vp_crossfadebudget = CROSSFADE_BUDGET;
+        vp_warmstart = WARM_START;
+        vp_preloadbudget = PRELOAD_BUDGET;
+
+        m_nLoadLevel = 0;
+        m_fLoadTime = 0;
+        m_nLoadOver = 0;
+        m_nLoadUnder = 0;
+        m_nLoopReserved = 0;
+        m_bAdvanceOrderDirty = false;
+        m_fMemoryCheck = 0;
+
+        m_nShaderItemUse = 0;
+        m_nShaderItemHits = 0;
+        m_nShaderItemMisses = 0;
+
+        m_fTraceEnd = 0;
+
+        m_bPreloading = false;
+        m_bPreloadWorking = false;
+        m_fPreloadExpire = 0;
 
 #if defined(VP_DISABLE_SYSTEM)
         return;
@@ -38,8 +78,23 @@ namespace VideoplayerPlugin
     {
         // Should be called while Game is still active otherwise there maybe leaks/problems
 
+        // the preload worker uses the system
+        {
+            Concurrency::critical_section::scoped_lock lock( m_csPreload );
+            m_bPreloading = false;
+        }
+
+        if ( m_bPreloadWorking )
+        {
+            m_evPreload.wait();
+            m_bPreloadWorking = false;
+        }
+
         gVideoplayerSystem = NULL;
 
+        m_mapPreloaded.clear();
+        gCE3DecoderIO.ClearPrefetched();
+
         m_pVideos.clear();
         m_p2DVideos.clear();
 
@@ -86,6 +141,31 @@ namespace VideoplayerPlugin
                 gEnv->pConsole->UnregisterVariable( "vp_seekthreshold", true );
                 gEnv->pConsole->UnregisterVariable( "vp_dropthreshold", true );
                 gEnv->pConsole->UnregisterVariable( "vp_dropmaxduration", true );
+                gEnv->pConsole->UnregisterVariable( "vp_visibilityframes", true );
+                gEnv->pConsole->UnregisterVariable( "vp_decimation", true );
+                gEnv->pConsole->UnregisterVariable( "vp_decimationhalf", true );
+                gEnv->pConsole->UnregisterVariable( "vp_decimationquarter", true );
+                gEnv->pConsole->UnregisterVariable( "vp_decimationkeyframes", true );
+                gEnv->pConsole->UnregisterVariable( "vp_poolsize", true );
+                gEnv->pConsole->UnregisterVariable( "vp_pooltimeout", true );
+                gEnv->pConsole->UnregisterVariable( "vp_uploadbudget", true );
+                gEnv->pConsole->UnregisterVariable( "vp_uploadtime", true );
+                gEnv->pConsole->UnregisterVariable( "vp_nullrenderer", true );
+                gEnv->pConsole->UnregisterVariable( "vp_nullchecksum", true );
+                gEnv->pConsole->UnregisterVariable( "vp_livelatency", true );
+                gEnv->pConsole->UnregisterVariable( "vp_trickspeed", true );
+                gEnv->pConsole->UnregisterVariable( "vp_reversebudget", true );
+                gEnv->pConsole->UnregisterVariable( "vp_loopbudget", true );
+                gEnv->pConsole->UnregisterVariable( "vp_clockdrift", true );
+                gEnv->pConsole->UnregisterVariable( "vp_memorybudget", true );
+                gEnv->pConsole->UnregisterVariable( "vp_hibernatedelay", true );
+                gEnv->pConsole->UnregisterVariable( "vp_loadbudget", true );
+                gEnv->pConsole->UnregisterVariable( "vp_playlistcache", true );
+                gEnv->pConsole->UnregisterVariable( "vp_crossfadebudget", true );
+                gEnv->pConsole->UnregisterVariable( "vp_warmstart", true );
+                gEnv->pConsole->UnregisterVariable( "vp_preloadbudget", true );
+                gEnv->pConsole->RemoveCommand( "vp_stats" );
+                gEnv->pConsole->RemoveCommand( "vp_trace" );
             }
         }
     }
@@ -103,6 +183,8 @@ namespace VideoplayerPlugin
             ( ( CWebMWrapper* )( *iter ).second )->ReleaseResources();
         }
 
+        // pooled renderers hold device resources too
+        trimVideoRendererPool( true );
         cleanupVideoResources();
     }
 
@@ -151,6 +233,7 @@ namespace VideoplayerPlugin
         switch ( event )
         {
             case ESYSTEM_EVENT_LEVEL_UNLOAD:
+                ClearPreload();
                 SetScreenState( eSS_LoadingScreen );
                 break;
 
@@ -168,6 +251,28 @@ namespace VideoplayerPlugin
 
     void CVideoplayerSystem::OnLoadingComplete( ILevel* pLevel )
     {
+        if ( m_bPreloading )
+        {
+            // all flowgraphs are loaded now, the worker reads the rest before the level starts
+            ScanPreloadFlowgraphs();
+
+            while ( RunPreloadWorker() )
+            {
+                m_evPreload.wait();
+            }
+
+            // videos that weren't warmed up yet are still read from memory
+            {
+                Concurrency::critical_section::scoped_lock lock( m_csPreload );
+                m_bPreloading = false;
+                m_quePreloadReady.clear();
+            }
+
+            m_fPreloadExpire = gEnv->pTimer->GetAsyncCurTime() + max( vp_pooltimeout, 0.0f );
+
+            gPlugin->LogAlways( "Preloaded level videos(%u) cached(%.2fMB)", unsigned( m_mapPreloaded.size() ), float( gCE3DecoderIO.GetPrefetchedBytes() ) / ( 1024.0f * 1024.0f ) );
+        }
+
         if ( m_pAutoPlaylists && pLevel && !gEnv->IsEditor() )
         {
             SetScreenState( eSS_BlockedScreen );
@@ -177,12 +282,343 @@ namespace VideoplayerPlugin
 
     void CVideoplayerSystem::OnLoadingProgress( ILevelInfo* pLevel, int progressAmount )
     {
+        if ( !m_bPreloading )
+        {
+            return;
+        }
+
+        // flowgraphs are loaded with the entities, so look for new nodes once the worker is idle
+        if ( !RunPreloadWorker() )
+        {
+            ScanPreloadFlowgraphs();
+            RunPreloadWorker();
+        }
 
+        // one warm up per update, so the loading screen keeps updating
+        PreloadNext();
     }
 
     void CVideoplayerSystem::OnLoadingStart( ILevelInfo* pLevel )
     {
         SetScreenState( eSS_LoadingScreen );
+
+        // the videos of the last level aren't needed anymore
+        ClearPreload();
+
+        if ( pLevel && !gEnv->IsEditor() && vp_preloadbudget > 0 )
+        {
+            {
+                Concurrency::critical_section::scoped_lock lock( m_csPreload );
+                m_bPreloading = true;
+            }
+
+            string sPath = pLevel->GetPath();
+            sPath += "/";
+            sPath += AUTOPLAY_LEVEL;
+            QueuePreloadPlaylist( sPath.c_str() );
+            RunPreloadWorker();
+        }
+    }
+
+    void CVideoplayerSystem::QueuePreload( const char* sFile, int nCustomWidth, int nCustomHeight, bool bPlaylist )
+    {
+        if ( !sFile || !sFile[0] )
+        {
+            return;
+        }
+
+        Concurrency::critical_section::scoped_lock lock( m_csPreload );
+
+        if ( !m_bPreloading || !m_setPreloadFound.insert( CCE3DecoderIO::GetFileKey( sFile ) ).second )
+        {
+            return;
+        }
+
+        SPreloadVideo video;
+        video.sFile = sFile;
+        video.nCustomWidth = nCustomWidth;
+        video.nCustomHeight = nCustomHeight;
+        video.bPlaylist = bPlaylist;
+        m_quePreload.push_back( video );
+    }
+
+    void CVideoplayerSystem::QueuePreloadPlaylist( const char* sPlaylist )
+    {
+        QueuePreload( sPlaylist, -1, -1, true );
+    }
+
+    bool CVideoplayerSystem::RunPreloadWorker()
+    {
+        if ( m_bPreloadWorking && m_evPreload.wait( 0 ) == 0 )
+        {
+            m_bPreloadWorking = false;
+        }
+
+        if ( !m_bPreloadWorking )
+        {
+            Concurrency::critical_section::scoped_lock lock( m_csPreload );
+
+            if ( m_bPreloading && !m_quePreload.empty() )
+            {
+                m_bPreloadWorking = true;
+                m_evPreload.reset();
+                Concurrency::CurrentScheduler::ScheduleTask( &CVideoplayerSystem::PreloadWorker, this );
+            }
+        }
+
+        return m_bPreloadWorking;
+    }
+
+    void CVideoplayerSystem::PreloadWorker( void* pSystem )
+    {
+        CVideoplayerSystem* pThis = ( CVideoplayerSystem* )pSystem;
+        size_t nBudget = size_t( max( pThis->vp_preloadbudget, 0.0f ) * 1024.0f * 1024.0f );
+
+        for ( ;; )
+        {
+            SPreloadVideo video;
+
+            {
+                Concurrency::critical_section::scoped_lock lock( pThis->m_csPreload );
+
+                // items queued after this check start a new worker
+                if ( !pThis->m_bPreloading || pThis->m_quePreload.empty() )
+                {
+                    break;
+                }
+
+                video = pThis->m_quePreload.front();
+                pThis->m_quePreload.pop_front();
+            }
+
+            if ( video.bPlaylist )
+            {
+                pThis->PreloadPlaylist( video.sFile );
+                continue;
+            }
+
+            VPXDEC_TRACE( "Preload", -1 );
+
+            vpx_usec_timer tPreload;
+            vpx_usec_timer_start( &tPreload );
+
+            // compressed bytes, the decoders of the level read them from memory
+            bool bCached = gCE3DecoderIO.Prefetch( video.sFile, nBudget );
+
+            vpx_usec_timer_mark( &tPreload );
+
+#if defined(_DEBUG)
+            gPlugin->LogAlways( "Preload file(%s) cached(%d) time(%.2fms)", video.sFile.c_str(), int( bCached ), float( vpx_usec_timer_elapsed( &tPreload ) ) / MICROSECOND * MILLISECOND );
+#endif
+
+            if ( bCached )
+            {
+                Concurrency::critical_section::scoped_lock lock( pThis->m_csPreload );
+
+                if ( pThis->m_bPreloading )
+                {
+                    pThis->m_quePreloadReady.push_back( video );
+                }
+            }
+        }
+
+        pThis->m_evPreload.set();
+    }
+
+    void CVideoplayerSystem::PreloadPlaylist( const char* sPlaylist )
+    {
+        SCompiledPlaylist compiled;
+
+        if ( !CVideoplayerPlaylist::Compile( sPlaylist, compiled ) )
+        {
+            return;
+        }
+
+        for ( std::vector<SPlaylistInput>::const_iterator iter = compiled.vInputs.begin(); iter != compiled.vInputs.end(); ++iter )
+        {
+            if ( !( ( *iter ).eTS & VTS_Live ) && !( ( *iter ).eDM & VDM_Live ) )
+            {
+                QueuePreload( compiled.getString( ( *iter ).nVideo ), ( *iter ).nCustomWidth, ( *iter ).nCustomHeight );
+            }
+        }
+    }
+
+    /**
+    * @brief Static input ports of a video input flownode (-1 none)
+    */
+    struct SPreloadNodeType
+    {
+        const char* sType;
+        bool bPlaylist;
+        TFlowPortId nFile;
+        int nCustomWidth;
+        int nCustomHeight;
+        int nTimeSource;
+        int nDropMode;
+    };
+
+    static const SPreloadNodeType preloadNodeTypes[] =
+    {
+        { "Videoplayer_Plugin:InputWebM", false, SFlowVideoInputWebMPorts::EIP_FILE, SFlowVideoInputWebMPorts::EIP_CUSTOMWIDTH, SFlowVideoInputWebMPorts::EIP_CUSTOMHEIGHT, SFlowVideoInputWebMPorts::EIP_TIMESOURCE, SFlowVideoInputWebMPorts::EIP_DROPMODE },
+        { "Videoplayer_Plugin:InputPlaylist", true, SFlowVideoInputPlaylistPorts::EIP_FILE, -1, -1, -1, -1 },
+    };
+
+    static int GetFlowInputInt( IFlowGraph* pGraph, TFlowNodeId nNode, int nPort, int nDefault )
+    {
+        const TFlowInputData* pData = nPort >= 0 ? pGraph->GetInputValue( nNode, TFlowPortId( nPort ) ) : NULL;
+        int nValue = nDefault;
+
+        if ( pData )
+        {
+            pData->GetValueWithConversion( nValue );
+        }
+
+        return nValue;
+    }
+
+    void CVideoplayerSystem::ScanPreloadFlowgraphs()
+    {
+        if ( !gEnv->pFlowSystem )
+        {
+            return;
+        }
+
+        IFlowGraphIteratorPtr pGraphs = gEnv->pFlowSystem->CreateFlowGraphIterator();
+        IFlowGraph* pGraph = NULL;
+
+        while ( pGraphs && ( pGraph = pGraphs->Next() ) )
+        {
+            IFlowNodeIteratorPtr pNodes = pGraph->CreateNodeIterator();
+            TFlowNodeId nNode = InvalidFlowNodeId;
+
+            while ( pNodes && pNodes->Next( nNode ) )
+            {
+                const char* sType = pGraph->GetNodeTypeName( nNode );
+
+                for ( size_t i = 0; sType && i < sizeof( preloadNodeTypes ) / sizeof( preloadNodeTypes[0] ); ++i )
+                {
+                    const SPreloadNodeType& type = preloadNodeTypes[i];
+
+                    if ( strcmp( sType, type.sType ) != 0 )
+                    {
+                        continue;
+                    }
+
+                    // only files set in the graph, files connected to other nodes are known when they are opened
+                    const TFlowInputData* pFile = pGraph->GetInputValue( nNode, type.nFile );
+                    string sFile;
+
+                    if ( !pFile || !pFile->GetValueWithConversion( sFile ) || sFile.empty() )
+                    {
+                        break;
+                    }
+
+                    if ( type.bPlaylist )
+                    {
+                        QueuePreloadPlaylist( sFile.c_str() );
+                    }
+
+                    else if ( !( GetFlowInputInt( pGraph, nNode, type.nTimeSource, VTS_Default ) & VTS_Live ) && !( GetFlowInputInt( pGraph, nNode, type.nDropMode, VDM_Default ) & VDM_Live ) )
+                    {
+                        QueuePreload( sFile.c_str(), GetFlowInputInt( pGraph, nNode, type.nCustomWidth, -1 ), GetFlowInputInt( pGraph, nNode, type.nCustomHeight, -1 ) );
+                    }
+
+                    break;
+                }
+            }
+        }
+    }
+
+    void CVideoplayerSystem::PreloadNext()
+    {
+        SPreloadVideo video;
+
+        {
+            Concurrency::critical_section::scoped_lock lock( m_csPreload );
+
+            if ( m_quePreloadReady.empty() )
+            {
+                return;
+            }
+
+            video = m_quePreloadReady.front();
+            m_quePreloadReady.pop_front();
+        }
+
+        vpx_usec_timer tPreload;
+        vpx_usec_timer_start( &tPreload );
+
+        // the file is read from memory, the paused video passes its renderer on through the pool once the level opens the file
+        // (nothing is decoded ahead, opening the file again restarts the decoder anyways)
+        IVideoplayer* pVideo = CreateVideoplayer();
+        bool bWarm = pVideo && pVideo->Open( video.sFile, "", false, true, false, VTS_Default, VDM_Default, 0, 0, video.nCustomWidth, video.nCustomHeight );
+
+        if ( bWarm )
+        {
+            m_mapPreloaded[CCE3DecoderIO::GetFileKey( video.sFile )] = pVideo;
+        }
+
+        else if ( pVideo )
+        {
+            DeleteVideoplayer( pVideo );
+        }
+
+        vpx_usec_timer_mark( &tPreload );
+
+#if defined(_DEBUG)
+        gPlugin->LogAlways( "Preload file(%s) warm(%d) time(%.2fms)", video.sFile.c_str(), int( bWarm ), float( vpx_usec_timer_elapsed( &tPreload ) ) / MICROSECOND * MILLISECOND );
+#endif
+    }
+
+    void CVideoplayerSystem::ReleasePreloaded( const char* sFile )
+    {
+        // videos warmed up while the level is loading keep their files
+        if ( m_bPreloading || !sFile )
+        {
+            return;
+        }
+
+        if ( !m_mapPreloaded.empty() )
+        {
+            std::map<string, IVideoplayer*>::iterator iter = m_mapPreloaded.find( CCE3DecoderIO::GetFileKey( sFile ) );
+
+            // closing pools the renderer, the video itself is deleted with the other warmed up videos
+            if ( iter != m_mapPreloaded.end() )
+            {
+                ( *iter ).second->Close();
+            }
+        }
+
+        // the level opened the file, its memory copy is only kept until the open handles are closed
+        gCE3DecoderIO.ReleasePrefetched( sFile );
+    }
+
+    void CVideoplayerSystem::ClearPreload()
+    {
+        for ( std::map<string, IVideoplayer*>::iterator iter = m_mapPreloaded.begin(); iter != m_mapPreloaded.end(); ++iter )
+        {
+            DeleteVideoplayer( ( *iter ).second );
+        }
+
+        m_mapPreloaded.clear();
+        m_fPreloadExpire = 0;
+
+        // the worker stops after its current file
+        {
+            Concurrency::critical_section::scoped_lock lock( m_csPreload );
+            m_bPreloading = false;
+            m_quePreload.clear();
+            m_quePreloadReady.clear();
+            m_setPreloadFound.clear();
+        }
+
+        if ( m_bPreloadWorking )
+        {
+            m_evPreload.wait();
+            m_bPreloadWorking = false;
+        }
+
+        gCE3DecoderIO.ClearPrefetched();
     }
 
     void CVideoplayerSystem::OnLoadGame( ILoadGame* pLoadGame )
@@ -206,8 +642,127 @@ namespace VideoplayerPlugin
         return gD3DSystem && m_nD3DActive > 0;
     }
 
+    static bool CompareVideoPriority( const std::pair<int, IVideoplayer*>& a, const std::pair<int, IVideoplayer*>& b )
+    {
+        return a.first < b.first;
+    }
+
+    // decimation per degradation level (rows) and priority class (columns: critical, UI, near, far), -1 pauses decoding
+    static const int nLoadDecimation[LOAD_LEVELS + 1][VPR_Auto] =
+    {
+        { 1, 1, 1, 1 },
+        { 1, 1, 1, 2 },
+        { 1, 1, 2, 0 },
+        { 1, 2, 4, -1 },
+        { 1, 4, 0, -1 },
+    };
+
+    unsigned CVideoplayerSystem::GetLoadDecimation( eVideoPriority ePriority )
+    {
+        int nDecimation = ePriority < VPR_Auto ? nLoadDecimation[m_nLoadLevel][ePriority] : 1;
+
+        return nDecimation < 0 ? 0 : unsigned( nDecimation );
+    }
+
+    bool CVideoplayerSystem::IsLoadPaused( eVideoPriority ePriority )
+    {
+        return ePriority < VPR_Auto && nLoadDecimation[m_nLoadLevel][ePriority] < 0;
+    }
+
+    size_t CVideoplayerSystem::ReserveLoopBudget( size_t nMinimum )
+    {
+        size_t nBudget = size_t( max( vp_loopbudget, 0.0f ) * 1024.0f * 1024.0f );
+
+        if ( m_nLoopReserved + nMinimum > nBudget )
+        {
+            return 0;
+        }
+
+        size_t nReserved = nBudget - m_nLoopReserved;
+        m_nLoopReserved = nBudget;
+        return nReserved;
+    }
+
+    void CVideoplayerSystem::ReleaseLoopBudget( size_t nBytes )
+    {
+        m_nLoopReserved -= min( nBytes, m_nLoopReserved );
+    }
+
+    void CVideoplayerSystem::UpdateLoad( float fTime )
+    {
+        m_fLoadTime = m_fLoadTime * 0.9f + fTime * 0.1f;
+
+        if ( vp_loadbudget <= 0 )
+        {
+            m_nLoadLevel = 0;
+            return;
+        }
+
+        int nLevel = m_nLoadLevel;
+
+        if ( m_fLoadTime > vp_loadbudget )
+        {
+            m_nLoadUnder = 0;
+
+            if ( ++m_nLoadOver >= LOAD_HOLD && nLevel < LOAD_LEVELS )
+            {
+                ++nLevel;
+            }
+        }
+
+        else if ( m_fLoadTime < vp_loadbudget * 0.5f )
+        {
+            // recover slowly, the degradation itself lowered the load
+            m_nLoadOver = 0;
+
+            if ( ++m_nLoadUnder >= LOAD_HOLD * 4 && nLevel > 0 )
+            {
+                --nLevel;
+            }
+        }
+
+        else
+        {
+            m_nLoadOver = 0;
+            m_nLoadUnder = 0;
+        }
+
+        if ( nLevel != m_nLoadLevel )
+        {
+            m_nLoadLevel = nLevel;
+            m_nLoadOver = 0;
+            m_nLoadUnder = 0;
+#if defined(_DEBUG)
+            gPlugin->LogAlways( "Load level(%d) video time(%.2fms) budget(%.2fms)", m_nLoadLevel, m_fLoadTime, vp_loadbudget );
+#endif
+        }
+    }
+
     void CVideoplayerSystem::AdvanceAll( float fDeltaTime )
     {
+        VPXDEC_TRACE( "AdvanceAll", -1 );
+
+        // write the trace once the capture ended
+        if ( m_fTraceEnd > 0 && gEnv->pTimer->GetAsyncCurTime() >= m_fTraceEnd )
+        {
+            m_fTraceEnd = 0;
+            stopVPXDecTrace();
+
+            FILE* pFile = fopen( m_sTraceFile.c_str(), "w" );
+
+            if ( pFile )
+            {
+                unsigned nEvents = writeVPXDecTrace( pFile );
+                fclose( pFile );
+                gPlugin->LogAlways( "Trace written events(%u) dropped(%u) file(%s)", nEvents, getVPXDecTraceDropped(), m_sTraceFile.c_str() );
+            }
+
+            else
+            {
+                gPlugin->LogError( "Trace file(%s) could not be opened", m_sTraceFile.c_str() );
+            }
+        }
+
         // handle editor mode changes (and vp_playbackmode)
         if ( !m_bEditing && gEnv->IsEditor() && gEnv->IsEditing() )
         {
@@ -264,12 +819,40 @@ namespace VideoplayerPlugin
         }
 
 
-        for ( tVideoIDMap::const_iterator iter = m_pVideos.begin(); iter != m_pVideos.end(); ++iter )
+        EnforceMemoryBudget();
+
+        // higher priority classes decode and convert first, the order is only sorted again when videos or their classes change
+        for ( std::vector< std::pair<int, IVideoplayer*> >::iterator iter = m_vecAdvanceOrder.begin(); iter != m_vecAdvanceOrder.end() && !m_bAdvanceOrderDirty; ++iter )
+        {
+            m_bAdvanceOrderDirty = ( *iter ).first != int( ( ( CWebMWrapper* )( *iter ).second )->GetPriorityClass() );
+        }
+
+        if ( m_bAdvanceOrderDirty )
+        {
+            m_bAdvanceOrderDirty = false;
+            m_vecAdvanceOrder.clear();
+
+            for ( tVideoIDMap::const_iterator iter = m_pVideos.begin(); iter != m_pVideos.end(); ++iter )
+            {
+                m_vecAdvanceOrder.push_back( std::make_pair( int( ( ( CWebMWrapper* )( *iter ).second )->GetPriorityClass() ), ( *iter ).second ) );
+            }
+
+            std::stable_sort( m_vecAdvanceOrder.begin(), m_vecAdvanceOrder.end(), &CompareVideoPriority );
+        }
+
+        vpx_usec_timer tVideos;
+        vpx_usec_timer_start( &tVideos );
+
+        // videos created by listeners meanwhile are picked up next frame
+        for ( std::vector< std::pair<int, IVideoplayer*> >::const_iterator iter = m_vecAdvanceOrder.begin(); iter != m_vecAdvanceOrder.end(); ++iter )
         {
             // Advance videos
             ( *iter ).second->Advance( fDeltaTime );
         }
 
+        vpx_usec_timer_mark( &tVideos );
+        UpdateLoad( float( vpx_usec_timer_elapsed( &tVideos ) ) / MICROSECOND * MILLISECOND );
+
         for ( tVideoPlaylistMap::const_iterator iter = m_pPlaylists.begin(); iter != m_pPlaylists.end(); ++iter )
         {
             // Advance playlists
@@ -358,6 +941,12 @@ namespace VideoplayerPlugin
     {
         bool isGamePaused = gEnv->pGameFramework->IsGamePaused();
 
+        // warmed up videos and read ahead files the level didn't open in time go the way of unused pooled renderers
+        if ( m_fPreloadExpire > 0 && gEnv->pTimer->GetAsyncCurTime() >= m_fPreloadExpire )
+        {
+            ClearPreload();
+        }
+
         // Handle some additional screen states
         if ( m_bBlocked )
         {
@@ -631,6 +1220,33 @@ namespace VideoplayerPlugin
                 REGISTER_CVAR( vp_seekthreshold, SEEK_THRESHOLD, VF_NULL, "threshold in seconds after which seeks will be triggered" );
                 REGISTER_CVAR( vp_dropthreshold, DROP_THRESHOLD, VF_NULL, "threshold in seconds after which drops will be triggered" );
                 REGISTER_CVAR( vp_dropmaxduration, DROP_MAXDURATION, VF_NULL, "maximal duration to drop at one time before outputting a frame again" );
+                REGISTER_CVAR( vp_visibilityframes, VISIBILITY_FRAMES, VF_NULL, "frames without any rendered output after which a video counts as hidden" );
+                REGISTER_CVAR( vp_decimation, 0, VF_NULL, "lower the presentation rate of far away in-world videos (0=off,1=on)" );
+                REGISTER_CVAR( vp_decimationhalf, DECIMATION_HALF, VF_NULL, "distance in meters after which only every 2nd frame is presented (0=never)" );
+                REGISTER_CVAR( vp_decimationquarter, DECIMATION_QUARTER, VF_NULL, "distance in meters after which only every 4th frame is presented (0=never)" );
+                REGISTER_CVAR( vp_decimationkeyframes, DECIMATION_KEYFRAMES, VF_NULL, "distance in meters after which only keyframes are presented (0=never)" );
+                REGISTER_CVAR( vp_poolsize, POOL_SIZE, VF_NULL, "maximal number of unused video renderers kept for reuse by the next video of the same size (0=off)" );
+                REGISTER_CVAR( vp_pooltimeout, POOL_TIMEOUT, VF_NULL, "seconds after which unused pooled video renderers are freed" );
+                REGISTER_CVAR( vp_uploadbudget, 0, VF_NULL, "maximal kilobytes of video textures uploaded per frame, the rest is deferred by priority (0=unlimited)" );
+                REGISTER_CVAR( vp_uploadtime, 0.0f, VF_NULL, "maximal milliseconds spent uploading video textures per frame, the rest is deferred by priority (0=unlimited)" );
+                REGISTER_CVAR( vp_nullrenderer, 0, VF_NULL, "new videos only convert frames into memory without creating textures, for benchmarks (0=off,1=on)" );
+                REGISTER_CVAR( vp_nullchecksum, 0, VF_NULL, "checksum frames converted by the null renderer (0=off,1=log per video,2=log per frame)" );
+                REGISTER_CVAR( vp_livelatency, LIVE_LATENCY, VF_NULL, "seconds a live video may lag behind its input before it skips ahead to the next keyframe (0=never)" );
+                REGISTER_CVAR( vp_trickspeed, TRICK_SPEED, VF_NULL, "playback speed at which only keyframes are decoded and presented (fast-forward, 0=never)" );
+                REGISTER_CVAR( vp_reversebudget, REVERSE_BUDGET, VF_NULL, "memory in MB for the decoded frames of a video playing backwards (half presented, half prefetched)" );
+                REGISTER_CVAR( vp_loopbudget, LOOP_BUDGET, VF_NULL, "memory in MB shared by the decoded first GOPs of all looping videos, presented while the decoder goes back to the start on a worker (0=seek when looping)" );
+                REGISTER_CVAR( vp_clockdrift, CLOCK_DRIFT, VF_NULL, "maximal playback rate correction to follow the sound clock (e.g. 0.05 = 5 percent, 0=use the raw sound position)" );
+                REGISTER_CVAR( vp_memorybudget, MEMORY_BUDGET, VF_NULL, "memory in MB for decoders, conversion buffers and textures of all videos, idle videos hibernate when exceeded (0=unlimited)" );
+                REGISTER_CVAR( vp_hibernatedelay, HIBERNATE_DELAY, VF_NULL, "seconds a video has to be paused or hidden before it can hibernate, it resumes with a keyframe seek" );
+                REGISTER_CVAR( vp_loadbudget, LOAD_BUDGET, VF_NULL, "milliseconds per frame for decoding and converting all videos, above it far, then near, then UI videos are degraded (0=never)" );
+                REGISTER_CVAR( vp_playlistcache, PLAYLIST_CACHE, VF_NULL, "keep compiled playlists and reuse them while the file timestamp and size are unchanged (0=compile on every open)" );
+                REGISTER_CVAR( vp_crossfadebudget, CROSSFADE_BUDGET, VF_NULL, "milliseconds per frame for decoding, converting and blending all videos during playlist crossfades, above it they fall back to a cut (0=always cut)" );
+                REGISTER_CVAR( vp_warmstart, WARM_START, VF_NULL, "open the menu playlist expected next paused and decode its first frame ahead, the splash screen preloads the menu and a running level the ingame menu (0=open on demand)" );
+                REGISTER_CVAR( vp_preloadbudget, PRELOAD_BUDGET, VF_NULL, "memory in MB for the compressed video files referenced by a level (Auto_Video.xml, video input flownodes), read ahead during the loading screen with a decoder and renderer warm up of each video (0=off)" );
+
+                // register commands
+                REGISTER_COMMAND( "vp_stats", &CVideoplayerSystem::CmdStats, VF_NULL, "log decode/convert/upload percentiles and counters of all videos (vp_stats [file.csv] also appends them to a CSV file)" );
+                REGISTER_COMMAND( "vp_trace", &CVideoplayerSystem::CmdTrace, VF_NULL, "capture the video pipeline for x seconds into a Chrome trace event file (vp_trace <seconds> [file.json], view it with chrome://tracing)" );
             }
 
             else
@@ -657,6 +1273,7 @@ namespace VideoplayerPlugin
         CWebMWrapper* pVideo = new CWebMWrapper( m_nFreeVideoId );
         m_pVideos[m_nFreeVideoId] = ( IVideoplayer* )pVideo;
         ++m_nFreeVideoId;
+        m_bAdvanceOrderDirty = true;
         return pVideo;
 #endif
         return NULL;
@@ -683,6 +1300,7 @@ namespace VideoplayerPlugin
         {
             delete ( CWebMWrapper* )( m_pVideos[nVideoID] );
             m_pVideos.erase( nVideoID );
+            m_bAdvanceOrderDirty = true;
         }
     }
 
@@ -742,14 +1360,17 @@ namespace VideoplayerPlugin
                 if ( bResetOverride )
                 {
                     // reset/cleanup the modified material
-                    for ( tOverrideMap::iterator iter = m_Overrides.begin(); iter != m_Overrides.end(); ++iter )
+                    tOverrideMap::iterator iter = m_MaterialOverrides.find( mat );
+
+                    if ( iter != m_MaterialOverrides.end() )
                     {
-                        for ( tOverrideSet::iterator iterS = ( *iter ).second.begin(); iterS != ( *iter ).second.end(); ++iterS )
+                        tOverrideIndex vecRemove;
+                        vecRemove.swap( ( *iter ).second );
+                        m_MaterialOverrides.erase( iter );
+
+                        for ( tOverrideIndex::const_iterator iterI = vecRemove.begin(); iterI != vecRemove.end(); ++iterI )
                         {
-                            if ( ( *iterS ).pMaterial == mat )
-                            {
-                                ( *iterS ).Reset();
-                            }
+                            RemoveOverride( *iterI );
                         }
                     }
                 }
@@ -765,6 +1386,392 @@ namespace VideoplayerPlugin
     {
         m_pMaterials.clear();
         m_Overrides.clear();
+        m_FreeOverrides.clear();
+        m_MaterialOverrides.clear();
+        m_VideoOverrides.clear();
+        ReleaseShaderItems();
+    }
+
+    void CVideoplayerSystem::CmdStats( IConsoleCmdArgs* pArgs )
+    {
+        if ( gVideoplayerSystem )
+        {
+            gVideoplayerSystem->DumpStats( pArgs && pArgs->GetArgCount() > 1 ? pArgs->GetArg( 1 ) : NULL );
+        }
+    }
+
+    void CVideoplayerSystem::CmdTrace( IConsoleCmdArgs* pArgs )
+    {
+        if ( !gVideoplayerSystem || !pArgs || pArgs->GetArgCount() < 2 )
+        {
+            gPlugin->LogWarning( "Usage: vp_trace <seconds> [file.json]" );
+            return;
+        }
+
+        float fSeconds = float( atof( pArgs->GetArg( 1 ) ) );
+
+        if ( fSeconds <= 0 )
+        {
+            gPlugin->LogWarning( "Trace duration(%s) invalid", pArgs->GetArg( 1 ) );
+            return;
+        }
+
+        gVideoplayerSystem->m_sTraceFile = pArgs->GetArgCount() > 2 ? pArgs->GetArg( 2 ) : "videoplayer_trace.json";
+        gVideoplayerSystem->m_fTraceEnd = gEnv->pTimer->GetAsyncCurTime() + fSeconds;
+
+        startVPXDecTrace();
+        gPlugin->LogAlways( "Trace started duration(%.2fs) file(%s)", fSeconds, gVideoplayerSystem->m_sTraceFile.c_str() );
+    }
+
+    void CVideoplayerSystem::DumpStats( const char* sCSV )
+    {
+        FILE* pCSV = NULL;
+
+        if ( sCSV && *sCSV )
+        {
+            pCSV = gEnv->pCryPak->FOpen( sCSV, "a" );
+
+            if ( !pCSV )
+            {
+                gPlugin->LogError( "Stats file(%s) could not be opened", sCSV );
+            }
+
+            else if ( gEnv->pCryPak->FGetSize( pCSV ) == 0 )
+            {
+                gEnv->pCryPak->FPrintf( pCSV, "time,id,file,decode_p50,decode_p95,decode_p99,convert_p50,convert_p95,convert_p99,upload_p50,upload_p95,upload_p99,"
+                                        "clock_p50,clock_p95,clock_p99,bytes_read,frames_decoded,frames_presented,frames_dropped,frames_skipped,seeks,clock_drift\n" );
+            }
+        }
+
+        float fTime = gEnv->pTimer->GetAsyncCurTime();
+        unsigned nVideos = 0;
+
+        gPlugin->LogAlways( "Stats load level(%d) video time(%.2fms) budget(%.2fms)", m_nLoadLevel, m_fLoadTime, vp_loadbudget );
+
+        for ( tVideoIDMap::const_iterator iter = m_pVideos.begin(); iter != m_pVideos.end(); ++iter )
+        {
+            SVideoStats stats;
+
+            if ( !( *iter ).second->GetStats( stats ) )
+            {
+                continue; // closed
+            }
+
+            ++nVideos;
+
+            gPlugin->LogAlways( "Stats id(%d) file(%s) decode(%.0f/%.0f/%.0fus) convert(%.0f/%.0f/%.0fus) upload(%.0f/%.0f/%.0fus) clock(%.1f/%.1f/%.1fms) drift(%.2fms)",
+                                ( *iter ).first, stats.sFile,
+                                stats.decode.fP50, stats.decode.fP95, stats.decode.fP99,
+                                stats.convert.fP50, stats.convert.fP95, stats.convert.fP99,
+                                stats.upload.fP50, stats.upload.fP95, stats.upload.fP99,
+                                stats.clockdrift.fP50, stats.clockdrift.fP95, stats.clockdrift.fP99,
+                                stats.fClockDrift * MILLISECOND );
+            gPlugin->LogAlways( "Stats id(%d) read(%.0fKB) frames decoded(%u) presented(%u) dropped(%u) skipped(%u) seeks(%u)",
+                                ( *iter ).first, float( stats.nBytesRead ) / 1024.0f,
+                                stats.nFramesDecoded, stats.nFramesPresented, stats.nFramesDropped, stats.nFramesSkipped, stats.nSeeks );
+            gPlugin->LogAlways( "Stats id(%d) priority(%d) class(%d)", ( *iter ).first, int( ( *iter ).second->GetPriority() ), int( ( ( CWebMWrapper* )( *iter ).second )->GetPriorityClass() ) );
+            gPlugin->LogAlways( "Stats id(%d) memory decoder(%.0fKB) staging(%.0fKB) texture(%.0fKB) hibernating(%d) hibernations(%u)",
+                                ( *iter ).first, float( stats.nMemoryDecoder ) / 1024.0f, float( stats.nMemoryStaging ) / 1024.0f, float( stats.nMemoryTexture ) / 1024.0f,
+                                stats.bHibernating ? 1 : 0, stats.nHibernations );
+
+            if ( pCSV )
+            {
+                gEnv->pCryPak->FPrintf( pCSV, "%.3f,%d,%s,%.0f,%.0f,%.0f,%.0f,%.0f,%.0f,%.0f,%.0f,%.0f,%.2f,%.2f,%.2f,%.0f,%u,%u,%u,%u,%u,%.4f\n",
+                                        fTime, ( *iter ).first, stats.sFile,
+                                        stats.decode.fP50, stats.decode.fP95, stats.decode.fP99,
+                                        stats.convert.fP50, stats.convert.fP95, stats.convert.fP99,
+                                        stats.upload.fP50, stats.upload.fP95, stats.upload.fP99,
+                                        stats.clockdrift.fP50, stats.clockdrift.fP95, stats.clockdrift.fP99,
+                                        double( stats.nBytesRead ), stats.nFramesDecoded, stats.nFramesPresented, stats.nFramesDropped, stats.nFramesSkipped, stats.nSeeks,
+                                        stats.fClockDrift );
+            }
+        }
+
+        if ( pCSV )
+        {
+            gEnv->pCryPak->FClose( pCSV );
+            gPlugin->LogAlways( "Stats of %u videos appended to file(%s)", nVideos, sCSV );
+        }
+
+        else if ( !nVideos )
+        {
+            gPlugin->LogAlways( "Stats no open videos" );
+        }
+    }
+
+    void CVideoplayerSystem::EnforceMemoryBudget()
+    {
+        float fNow = gEnv->pTimer->GetAsyncCurTime();
+
+        if ( fNow < m_fMemoryCheck )
+        {
+            return;
+        }
+
+        m_fMemoryCheck = fNow + MEMORY_INTERVAL;
+
+        std::vector< std::pair<float, CWebMWrapper*> > vecIdle;
+        size_t nPooled = getVideoRendererPoolBytes();
+        size_t nPrefetched = gCE3DecoderIO.GetPrefetchedBytes();
+        size_t nUsed = nPooled + nPrefetched;
+
+        // idle times are tracked even within the budget, so a video doesn't count as idle since it was paused while it was still visible
+        for ( tVideoIDMap::const_iterator iter = m_pVideos.begin(); iter != m_pVideos.end(); ++iter )
+        {
+            CWebMWrapper* pVideo = ( CWebMWrapper* )( *iter ).second;
+            size_t nDecoder, nStaging, nTexture;
+            nUsed += pVideo->GetMemoryUsage( nDecoder, nStaging, nTexture );
+
+            float fIdle = pVideo->GetIdleTime();
+
+            if ( fIdle >= vp_hibernatedelay )
+            {
+                vecIdle.push_back( std::make_pair( fIdle, pVideo ) );
+            }
+        }
+
+        size_t nBudget = size_t( max( vp_memorybudget, 0.0f ) * 1024.0f * 1024.0f );
+
+        if ( !nBudget || nUsed <= nBudget )
+        {
+            return;
+        }
+
+        if ( nPooled )
+        {
+            trimVideoRendererPool( true );
+            nUsed -= nPooled;
+        }
+
+        // read ahead files not opened yet are dropped next, except while the level is still loading
+        if ( nPrefetched && nUsed > nBudget && !m_bPreloading )
+        {
+            gCE3DecoderIO.ClearPrefetched();
+            nUsed -= nPrefetched - min( gCE3DecoderIO.GetPrefetchedBytes(), nPrefetched );
+        }
+
+        // longest idle first
+        std::sort( vecIdle.begin(), vecIdle.end() );
+
+        for ( std::vector< std::pair<float, CWebMWrapper*> >::reverse_iterator iter = vecIdle.rbegin(); iter != vecIdle.rend() && nUsed > nBudget; ++iter )
+        {
+            size_t nDecoder, nStaging, nTexture;
+            size_t nBytes = ( *iter ).second->GetMemoryUsage( nDecoder, nStaging, nTexture );
+
+            if ( ( *iter ).second->Hibernate() )
+            {
+                nUsed -= min( nBytes, nUsed );
+            }
+        }
+    }
+
+    void CVideoplayerSystem::ReleaseShaderItems()
+    {
+        for ( tShaderItemCache::iterator iter = m_ShaderItems.begin(); iter != m_ShaderItems.end(); ++iter )
+        {
+            SShaderItem& item = ( *iter ).second.item;
+            SAFE_RELEASE( item.m_pShader );
+            SAFE_RELEASE( item.m_pShaderResources );
+            ( *iter ).first.pTexture->Release();
+        }
+
+        m_ShaderItems.clear();
+    }
+
+    /**
+    * @brief FNV-1a hash step
+    */
+    static uint32 HashBytes( uint32 nHash, const void* pData, size_t nSize )
+    {
+        const unsigned char* pBytes = static_cast<const unsigned char*>( pData );
+
+        for ( size_t i = 0; i < nSize; ++i )
+        {
+            nHash = ( nHash ^ pBytes[i] ) * 16777619u;
+        }
+
+        return nHash;
+    }
+
+    /**
+    * @brief Append raw values to the compared resource parameters
+    */
+    static void AppendBytes( std::vector<uint8>& vecBytes, const void* pData, size_t nSize )
+    {
+        const uint8* pBytes = static_cast<const uint8*>( pData );
+        vecBytes.insert( vecBytes.end(), pBytes, pBytes + nSize );
+    }
+
+    /**
+    * @brief Store the resource parameters that make shader items of material overrides differ in the key
+    */
+    static void SetShaderResources( SShaderItemKey& key, const SInputShaderResources& Res )
+    {
+        key.vecResources.clear();
+        key.vecResourceNames.clear();
+
+        AppendBytes( key.vecResources, &Res.m_LMaterial, sizeof( Res.m_LMaterial ) );
+        AppendBytes( key.vecResources, &Res.m_GlowAmount, sizeof( Res.m_GlowAmount ) );
+        AppendBytes( key.vecResources, &Res.m_Opacity, sizeof( Res.m_Opacity ) );
+        AppendBytes( key.vecResources, &Res.m_AlphaRef, sizeof( Res.m_AlphaRef ) );
+        AppendBytes( key.vecResources, &Res.m_ResFlags, sizeof( Res.m_ResFlags ) );
+
+        for ( int i = 0; i < EFTT_MAX; ++i )
+        {
+            key.vecResourceNames.push_back( Res.m_Textures[i].m_Name );
+            AppendBytes( key.vecResources, &Res.m_Textures[i].m_TexFlags, sizeof( Res.m_Textures[i].m_TexFlags ) );
+        }
+
+        // public shader parameters by position, string values by content
+        for ( int i = 0; i < int( Res.m_ShaderParams.size() ); ++i )
+        {
+            const SShaderParam& param = Res.m_ShaderParams[i];
+            AppendBytes( key.vecResources, &param.m_Type, sizeof( param.m_Type ) );
+
+            if ( param.m_Type == eType_STRING )
+            {
+                key.vecResourceNames.push_back( param.m_Value.m_String ? param.m_Value.m_String : "" );
+            }
+
+            else
+            {
+                AppendBytes( key.vecResources, &param.m_Value, sizeof( param.m_Value ) );
+            }
+        }
+
+        uint32 nHash = HashBytes( 2166136261u, key.vecResources.empty() ? NULL : &key.vecResources[0], key.vecResources.size() );
+
+        for ( size_t i = 0; i < key.vecResourceNames.size(); ++i )
+        {
+            nHash = HashBytes( nHash, key.vecResourceNames[i].c_str(), key.vecResourceNames[i].length() + 1 );
+        }
+
+        key.nResources = nHash;
+    }
+
+    SShaderItem CVideoplayerSystem::LoadShaderItem( ITexture* pTexture, const char* sShader, uint64 uGenerationMask, int nTextureslot, SInputShaderResources& Res )
+    {
+        SShaderItemKey key;
+        key.pTexture = pTexture;
+        key.sShader = sShader ? sShader : "";
+        key.uGenerationMask = uGenerationMask;
+        key.nTextureslot = nTextureslot;
+        SetShaderResources( key, Res );
+
+        tShaderItemCache::iterator iter = m_ShaderItems.find( key );
+
+        if ( iter != m_ShaderItems.end() )
+        {
+            ++m_nShaderItemHits;
+            ( *iter ).second.nLastUse = ++m_nShaderItemUse;
+            return ( *iter ).second.item;
+        }
+
+        ++m_nShaderItemMisses;
+
+        // make room by releasing the least recently used shader item (the materials keep their own references)
+        if ( m_ShaderItems.size() >= SHADERITEM_CACHE )
+        {
+            tShaderItemCache::iterator iterOldest = m_ShaderItems.begin();
+
+            for ( tShaderItemCache::iterator iterE = m_ShaderItems.begin(); iterE != m_ShaderItems.end(); ++iterE )
+            {
+                if ( ( *iterE ).second.nLastUse < ( *iterOldest ).second.nLastUse )
+                {
+                    iterOldest = iterE;
+                }
+            }
+
+            SShaderItem& item = ( *iterOldest ).second.item;
+            SAFE_RELEASE( item.m_pShader );
+            SAFE_RELEASE( item.m_pShaderResources );
+            ( *iterOldest ).first.pTexture->Release();
+            m_ShaderItems.erase( iterOldest );
+        }
+
+        SShaderItemEntry entry;
+        entry.item = gEnv->pRenderer->EF_LoadShaderItem( sShader, true, 0, &Res, uGenerationMask ); // TODOTODO Generation params pShader->GetGenerationParams()
+        entry.nLastUse = ++m_nShaderItemUse;
+
+        if ( entry.item.m_pShader )
+        {
+            // the key must stay unique as long as the entry exists
+            pTexture->AddRef();
+            m_ShaderItems.insert( std::make_pair( key, entry ) );
+        }
+
+        return entry.item;
+    }
+
+    void CVideoplayerSystem::ReleaseShaderItems( ITexture* pTexture )
+    {
+        for ( tShaderItemCache::iterator iter = m_ShaderItems.begin(); iter != m_ShaderItems.end(); )
+        {
+            if ( ( *iter ).first.pTexture == pTexture )
+            {
+                SShaderItem& item = ( *iter ).second.item;
+                SAFE_RELEASE( item.m_pShader );
+                SAFE_RELEASE( item.m_pShaderResources );
+                pTexture->Release();
+                m_ShaderItems.erase( iter++ );
+            }
+
+            else
+            {
+                ++iter;
+            }
+        }
+    }
+
+    /**
+    * @brief Swap-remove an index (the order of a relation doesn't matter)
+    */
+    static void EraseOverrideIndex( tOverrideIndex& vecIndex, unsigned nOverride )
+    {
+        tOverrideIndex::iterator iter = std::find( vecIndex.begin(), vecIndex.end(), nOverride );
+
+        if ( iter != vecIndex.end() )
+        {
+            *iter = vecIndex.back();
+            vecIndex.pop_back();
+        }
+    }
+
+    void CVideoplayerSystem::RemoveOverride( unsigned nOverride )
+    {
+        SMaterialOverride& item = m_Overrides[nOverride];
+
+        if ( !item.pVideo )
+        {
+            return; // already recycled
+        }
+
+        tOverrideMap::iterator iterM = m_MaterialOverrides.find( item.pMaterial );
+
+        if ( iterM != m_MaterialOverrides.end() )
+        {
+            EraseOverrideIndex( ( *iterM ).second, nOverride );
+
+            if ( ( *iterM ).second.empty() )
+            {
+                m_MaterialOverrides.erase( iterM );
+            }
+        }
+
+        tVideoOverrideMap::iterator iterV = m_VideoOverrides.find( item.pVideo );
+
+        if ( iterV != m_VideoOverrides.end() )
+        {
+            EraseOverrideIndex( ( *iterV ).second, nOverride );
+
+            if ( ( *iterV ).second.empty() )
+            {
+                m_VideoOverrides.erase( iterV );
+            }
+        }
+
+        item.Reset();
+        m_FreeOverrides.push_back( nOverride );
     }
 
     bool CVideoplayerSystem::ResetMaterial( IMaterial* pMaterial, int nSubmat, bool bResetOverride )
@@ -803,34 +1810,49 @@ namespace VideoplayerPlugin
 
     void CVideoplayerSystem::RestoreMaterials( IVideoplayer* pVideo, bool bResetOverride )
     {
-        // find all affected materials
-        for ( tOverrideMap::const_iterator iter = m_Overrides.begin(); iter != m_Overrides.end(); ++iter )
+        tVideoOverrideMap::const_iterator iter = m_VideoOverrides.find( pVideo );
+
+        if ( iter == m_VideoOverrides.end() )
         {
-            for ( tOverrideSet::const_iterator iterS = ( *iter ).second.begin(); iterS != ( *iter ).second.end(); ++iterS )
-            {
-                if ( ( *iterS ).pVideo == pVideo )
-                {
-                    RestoreMaterial( ( *iterS ).pMaterial, bResetOverride );
-                }
-            }
+            return; // nothing overridden by this video
+        }
+
+        // copy the affected materials, resetting removes them from the relation
+        std::vector<IMaterial*> vecMaterials;
+        vecMaterials.reserve( ( *iter ).second.size() );
+
+        for ( tOverrideIndex::const_iterator iterI = ( *iter ).second.begin(); iterI != ( *iter ).second.end(); ++iterI )
+        {
+            vecMaterials.push_back( m_Overrides[*iterI].pMaterial );
+        }
+
+        for ( std::vector<IMaterial*>::const_iterator iterM = vecMaterials.begin(); iterM != vecMaterials.end(); ++iterM )
+        {
+            RestoreMaterial( *iterM, bResetOverride );
         }
     }
 
     void CVideoplayerSystem::OverrideMaterials( IVideoplayer* pVideo )
     {
-        for ( tOverrideMap::iterator iter = m_Overrides.begin(); iter != m_Overrides.end(); ++iter )
+        tVideoOverrideMap::const_iterator iter = m_VideoOverrides.find( pVideo );
+
+        if ( iter == m_VideoOverrides.end() )
         {
-            for ( tOverrideSet::iterator iterS = ( *iter ).second.begin(); iterS != ( *iter ).second.end(); ++iterS )
-            {
-                if ( ( *iterS ).pVideo == pVideo )
-                {
-                    ( ( CWebMWrapper* )pVideo )->OverrideMaterial( *iterS );
-                }
-            }
+            return; // nothing overridden by this video
+        }
+
+        for ( tOverrideIndex::const_iterator iterI = ( *iter ).second.begin(); iterI != ( *iter ).second.end(); ++iterI )
+        {
+            ( ( CWebMWrapper* )pVideo )->OverrideMaterial( m_Overrides[*iterI] );
         }
     }
 
     bool CVideoplayerSystem::OverrideMaterial( IVideoplayer* pVideo, IMaterial* pMaterial, int nSubmat, int nTextureslot, bool bRecommendedSettings )
+    {
+        return OverrideMaterialDecimated( pVideo, pMaterial, nSubmat, nTextureslot, bRecommendedSettings, 1.0f );
+    }
+
+    bool CVideoplayerSystem::OverrideMaterialDecimated( IVideoplayer* pVideo, IMaterial* pMaterial, int nSubmat, int nTextureslot, bool bRecommendedSettings, float fDecimationScale )
     {
         if ( !pMaterial || !pVideo )
         {
@@ -868,18 +1890,70 @@ namespace VideoplayerPlugin
         // Remember orginal material
         RememberMaterial( mat );
 
-        // Remember used materials
-        if ( m_Overrides.find( mat ) == m_Overrides.end() )
+        // Remember used materials (a textureslot is overridden by one video at a time)
+        tOverrideMap::const_iterator iterM = m_MaterialOverrides.find( mat );
+
+        if ( iterM != m_MaterialOverrides.end() )
+        {
+            for ( tOverrideIndex::const_iterator iterI = ( *iterM ).second.begin(); iterI != ( *iterM ).second.end(); ++iterI )
+            {
+                if ( m_Overrides[*iterI].nTextureslot == nTextureslot )
+                {
+                    RemoveOverride( *iterI ); // invalidates the iterators
+                    break;
+                }
+            }
+        }
+
+        unsigned nOverride;
+
+        if ( !m_FreeOverrides.empty() )
         {
-            m_Overrides.insert( std::make_pair( mat, tOverrideSet( EFTT_MAX ) ) );
+            nOverride = m_FreeOverrides.back();
+            m_FreeOverrides.pop_back();
         }
 
-        SMaterialOverride& item = m_Overrides[mat][nTextureslot];
-        item.Set( pVideo, mat, nTextureslot, bRecommendedSettings );
+        else
+        {
+            nOverride = unsigned( m_Overrides.size() );
+            m_Overrides.push_back( SMaterialOverride() );
+        }
+
+        m_MaterialOverrides[mat].push_back( nOverride );
+        m_VideoOverrides[pVideo].push_back( nOverride );
+
+        SMaterialOverride& item = m_Overrides[nOverride];
+        item.Set( pVideo, mat, nTextureslot, bRecommendedSettings, fDecimationScale );
 
         return ( ( CWebMWrapper* )pVideo )->OverrideMaterial( item );
     }
 
+    int CVideoplayerSystem::OverrideMaterialBatch( IVideoplayer* pVideo, IMaterial** pMaterials, int nMaterials, int nSubmat, int nTextureslot, bool bRecommendedSettings, float fDecimationScale )
+    {
+        if ( !pVideo || !pMaterials || nMaterials <= 0 )
+        {
+            return 0;
+        }
+
+        CTimeValue tStart = gEnv->pTimer->GetAsyncTime();
+        unsigned nHits = m_nShaderItemHits;
+        unsigned nMisses = m_nShaderItemMisses;
+        int nOverridden = 0;
+
+        for ( int i = 0; i < nMaterials; ++i )
+        {
+            if ( OverrideMaterialDecimated( pVideo, pMaterials[i], nSubmat, nTextureslot, bRecommendedSettings, fDecimationScale ) )
+            {
+                ++nOverridden;
+            }
+        }
+
+        gPlugin->LogAlways( "Override batch id(%d) materials(%d/%d) shader items reused(%u) created(%u) time(%.2fms)", pVideo->GetId(), nOverridden, nMaterials,
+                            m_nShaderItemHits - nHits, m_nShaderItemMisses - nMisses, ( gEnv->pTimer->GetAsyncTime() - tStart ).GetMilliSeconds() );
+
+        return nOverridden;
+    }
+
     IMaterial* CVideoplayerSystem::CreateMaterial( IVideoplayer* pVideo, const char* sMaterial, int nMtlFlags )
     {
         IMaterial* mat = NULL;
@@ -6,6 +6,9 @@
 #include <IPluginD3D.h>
 #include "IPluginVideoplayer.h"
 #include <map>
+#include <set>
+#include <deque>
+#include <concrt.h>
 #include <Playlist/CAutoPlaylists.h>
 
 namespace VideoplayerPlugin
@@ -20,6 +23,7 @@ namespace VideoplayerPlugin
         IMaterial* pMaterial; //!< Material this override modifies
         int nTextureslot; //!< Textureslot to be modified
         bool bRecommendedSettings; //!< automatically sets some sensible shader parameters
+        float fDecimationScale; //!< scales the distance used for temporal decimation (0 disables it)
 
         SMaterialOverride_()
         {
@@ -35,6 +39,7 @@ namespace VideoplayerPlugin
             pMaterial = NULL;
             nTextureslot = 0;
             bRecommendedSettings = false;
+            fDecimationScale = 1.0f;
         };
 
         /**
@@ -43,19 +48,84 @@ namespace VideoplayerPlugin
         * @param _pMaterial pointer to the material interface affected
         * @param _nTextureslot texture slot to be overridden
         * @param _bRecommendedSettings automatically set some shader parameters
+        * @param _fDecimationScale distance scale for temporal decimation
         */
-        void Set( IVideoplayer* _pVideo, IMaterial* _pMaterial, int _nTextureslot = EFTT_DIFFUSE, bool _bRecommendedSettings = true )
+        void Set( IVideoplayer* _pVideo, IMaterial* _pMaterial, int _nTextureslot = EFTT_DIFFUSE, bool _bRecommendedSettings = true, float _fDecimationScale = 1.0f )
         {
             pVideo = _pVideo;
             pMaterial = _pMaterial;
             nTextureslot = _nTextureslot;
             bRecommendedSettings = _bRecommendedSettings;
+            fDecimationScale = _fDecimationScale;
         };
     } SMaterialOverride;
 
     typedef std::list<S2DVideo> t2DVideos; //!< hold 2D video information
-    typedef std::vector<SMaterialOverride> tOverrideSet; //!< hold material override infomation
-    typedef std::map<IMaterial*, tOverrideSet> tOverrideMap; //!< material 1:N override relation
+    /**
+    * @brief Identifies a shader item created by a material override
+    * Materials with equal shader and resource parameters can share the shader item.
+    */
+    struct SShaderItemKey
+    {
+        ITexture* pTexture; //!< video texture in the overridden slot
+        string sShader; //!< shader name
+        uint64 uGenerationMask; //!< shader generation mask
+        int nTextureslot; //!< overridden texture slot
+        uint32 nResources; //!< hash of the resource parameters, only orders keys before they are compared in full
+        std::vector<uint8> vecResources; //!< material values, texture flags and numeric shader parameters
+        std::vector<string> vecResourceNames; //!< texture names and string shader parameters
+
+        bool operator<( const SShaderItemKey& other ) const
+        {
+            if ( pTexture != other.pTexture )
+            {
+                return pTexture < other.pTexture;
+            }
+
+            if ( uGenerationMask != other.uGenerationMask )
+            {
+                return uGenerationMask < other.uGenerationMask;
+            }
+
+            if ( nTextureslot != other.nTextureslot )
+            {
+                return nTextureslot < other.nTextureslot;
+            }
+
+            if ( nResources != other.nResources )
+            {
+                return nResources < other.nResources;
+            }
+
+            if ( sShader != other.sShader )
+            {
+                return sShader < other.sShader;
+            }
+
+            // equal hashes can still differ
+            if ( vecResources != other.vecResources )
+            {
+                return vecResources < other.vecResources;
+            }
+
+            return vecResourceNames < other.vecResourceNames;
+        }
+    };
+
+    /**
+    * @brief Cached shader item (holds one reference of the shader, resources and texture)
+    */
+    struct SShaderItemEntry
+    {
+        SShaderItem item; //!< shader item assigned to the materials
+        unsigned nLastUse; //!< use counter value of the last lookup
+    };
+
+    typedef std::map<SShaderItemKey, SShaderItemEntry> tShaderItemCache; //!< shader items of material overrides
+    typedef std::vector<SMaterialOverride> tOverrideSet; //!< hold material override infomation (flat, unused entries are recycled)
+    typedef std::vector<unsigned> tOverrideIndex; //!< indices into the override set
+    typedef std::map<IMaterial*, tOverrideIndex> tOverrideMap; //!< material 1:N override relation
+    typedef std::map<IVideoplayer*, tOverrideIndex> tVideoOverrideMap; //!< video 1:N override relation
     typedef std::map<IMaterial*, IMaterial*> tOrginalMaterialMap; //!< modified material N;1 orginal material relation
     typedef std::map<int, IVideoplayer*> tVideoIDMap; //!< videoid 1;1 video interface relation
     typedef std::map<IVideoplayerPlaylist*, IVideoplayerPlaylist*> tVideoPlaylistMap; //!< simply for simpler loopkup
@@ -109,15 +179,176 @@ namespace VideoplayerPlugin
             float vp_dropthreshold; //!< Threshold in seconds to trigger drops @see eDropMode
             float vp_dropmaxduration; //!< Maximal duration to drop at one time before outputting a frame again
 
+            int vp_visibilityframes; //!< Frames without rendered output after which a video counts as hidden @see eVisibilityPolicy
+
+            int vp_decimation; //!< Lower the presentation rate of far away in-world videos
+            float vp_decimationhalf; //!< Distance in meters after which only every 2nd frame is presented
+            float vp_decimationquarter; //!< Distance in meters after which only every 4th frame is presented
+            float vp_decimationkeyframes; //!< Distance in meters after which only keyframes are presented
+
+            int vp_poolsize; //!< Maximal number of unused video renderers kept for reuse
+            float vp_pooltimeout; //!< Seconds after which unused pooled video renderers are freed
+
+            int vp_uploadbudget; //!< Maximal kilobytes uploaded per renderer type and frame (0 unlimited)
+            float vp_uploadtime; //!< Maximal milliseconds spent uploading per renderer type and frame (0 unlimited)
+
+            int vp_nullrenderer; //!< New videos only convert frames without creating textures @see VRT_NULL
+            int vp_nullchecksum; //!< Checksum frames converted by the null renderer (1 per video, 2 per frame)
+
+            float vp_livelatency; //!< Seconds a live video may lag behind its input before skipping ahead to the next keyframe @see VDM_Live
+
+            float vp_trickspeed; //!< Speed at which only keyframes are presented (fast-forward trick mode) @see IMediaPlayback::SetSpeed
+
+            float vp_reversebudget; //!< Memory in MB for the decoded frames of a video playing backwards @see IMediaPlayback::SetSpeed
+
+            float vp_loopbudget; //!< Memory in MB shared by the decoded first GOPs of all looping videos (0 seeks when looping)
+
+            float vp_clockdrift; //!< Maximal playback rate correction to follow the sound clock (0 uses the raw sound position) @see VTS_Sound
+
+            float vp_memorybudget; //!< Memory in MB for decoders, conversion buffers and textures of all videos (0 unlimited)
+            float vp_hibernatedelay; //!< Seconds a video has to be paused or hidden before it can hibernate @see vp_memorybudget
+
+            float vp_loadbudget; //!< Milliseconds per frame for decoding and converting all videos before lower priority classes are degraded (0 never) @see eVideoPriority
+
+            int vp_playlistcache; //!< Keep compiled playlists until their file changes (0 compile on every open) @see SCompiledPlaylist
+            float vp_crossfadebudget; //!< Milliseconds per frame for all videos during playlist crossfades before they fall back to a cut (0 always cut)
+            int vp_warmstart; //!< Preload the next expected menu playlist, so it is shown without a stall @see CAutoPlaylists
+            float vp_preloadbudget; //!< Memory in MB for compressed video files of a level read ahead during the loading screen (0 no level preloading)
+
         private:
 
             int m_nFreeVideoId; //!< next video ID / free ID (could overflow in an extremly unlikly use case of creating 2^31-1 videos)
             tVideoIDMap m_pVideos; //!< videoid 1;1 video interface relation
+            std::vector< std::pair<int, IVideoplayer*> > m_vecAdvanceOrder; //!< videos by priority class, higher classes advance first
+            bool m_bAdvanceOrderDirty; //!< videos or their priority classes changed since m_vecAdvanceOrder was sorted
             tVideoPlaylistMap m_pPlaylists; //!< simply for simpler loopkup and cleanup
             tOrginalMaterialMap m_pMaterials; //!< modified material N;1 orginal material relation
-            tOverrideMap m_Overrides; //!< material 1:N override relation
+            tOverrideSet m_Overrides; //!< all material overrides
+            tOverrideIndex m_FreeOverrides; //!< unused entries of m_Overrides
+            tOverrideMap m_MaterialOverrides; //!< material 1:N override relation
+            tVideoOverrideMap m_VideoOverrides; //!< video 1:N override relation
             t2DVideos m_p2DVideos; //!< 2D video information of active 2D video window
 
+            tShaderItemCache m_ShaderItems; //!< shader items of material overrides for reuse
+            unsigned m_nShaderItemUse; //!< use counter for least recently used eviction
+            unsigned m_nShaderItemHits; //!< shader items reused from the cache
+            unsigned m_nShaderItemMisses; //!< shader items created
+
+
+            /**
+            * @brief Remove an override from both relations and recycle its entry
+            * @param nOverride index into m_Overrides
+            */
+            void RemoveOverride( unsigned nOverride );
+
+            /**
+            * @brief Release all cached shader items
+            */
+            void ReleaseShaderItems();
+
+            /**
+            * @brief Console command printing the performance counters of all videos
+            * Usage: vp_stats [file.csv], with a file the counters are also appended as CSV rows.
+            */
+            static void CmdStats( IConsoleCmdArgs* pArgs );
+
+            /**
+            * @brief Log the performance counters of all videos
+            * @param sCSV append them to this CSV file too (NULL only logs)
+            */
+            void DumpStats( const char* sCSV );
+
+            /**
+            * @brief Hibernate the longest idle videos while the memory of all videos exceeds vp_memorybudget
+            * Pooled renderers and read ahead files not opened yet are freed first since nothing uses them.
+            * Runs every MEMORY_INTERVAL seconds, the hibernation delay is much longer.
+            */
+            void EnforceMemoryBudget();
+
+            float m_fMemoryCheck; //!< time the memory budget is checked next
+
+            int m_nLoadLevel; //!< current degradation level @see LOAD_LEVELS
+            float m_fLoadTime; //!< low-passed milliseconds per frame spent advancing the videos
+            unsigned m_nLoadOver; //!< frames the load exceeded the budget since the last level change
+            unsigned m_nLoadUnder; //!< frames the load stayed below half the budget since the last level change
+            size_t m_nLoopReserved; //!< bytes of vp_loopbudget reserved by the loop caches of all videos
+
+            /**
+            * @brief Change the degradation level by the time the videos needed this frame
+            * @param fTime milliseconds spent advancing the videos
+            */
+            void UpdateLoad( float fTime );
+
+            /**
+            * @brief Console command capturing a trace of the video pipeline
+            * Usage: vp_trace <seconds> [file.json], the Chrome trace event file (chrome://tracing) is written when the capture ends.
+            */
+            static void CmdTrace( IConsoleCmdArgs* pArgs );
+
+            float m_fTraceEnd; //!< time the running trace capture ends (0 while not capturing)
+            string m_sTraceFile; //!< file the running trace capture is written to
+
+            /**
+            * @brief Video or playlist referenced by the loading level
+            */
+            struct SPreloadVideo
+            {
+                string sFile;
+                int nCustomWidth;
+                int nCustomHeight;
+                bool bPlaylist; //!< the worker compiles the playlist and queues its videos
+            };
+
+            bool m_bPreloading; //!< a level is loading, its videos are searched and prefetched (written under m_csPreload)
+            bool m_bPreloadWorking; //!< the preload worker was scheduled and not joined yet (main thread only)
+            Concurrency::event m_evPreload; //!< set when the preload worker finished
+            Concurrency::critical_section m_csPreload; //!< queues and found files are shared with the preload worker
+            std::deque<SPreloadVideo> m_quePreload; //!< videos and playlists waiting for the worker
+            std::deque<SPreloadVideo> m_quePreloadReady; //!< prefetched videos waiting for their warm up on the main thread
+            std::set<string> m_setPreloadFound; //!< videos and playlists found so far (file keys)
+            std::map<string, IVideoplayer*> m_mapPreloaded; //!< paused warmed up videos by file key
+            float m_fPreloadExpire; //!< time the warmed up videos are released after the level started (0 none)
+
+            /**
+            * @brief Queue a video of the loading level for the worker (once per file, live inputs are skipped by the caller)
+            */
+            void QueuePreload( const char* sFile, int nCustomWidth = -1, int nCustomHeight = -1, bool bPlaylist = false );
+
+            /**
+            * @brief Queue a playlist of the loading level, the worker queues its videos
+            */
+            void QueuePreloadPlaylist( const char* sPlaylist );
+
+            /**
+            * @brief Queue the videos of the video input flownodes with a static file port
+            */
+            void ScanPreloadFlowgraphs();
+
+            /**
+            * @brief Join a finished preload worker and schedule a new one if the queue isn't empty
+            * @return a worker is running
+            */
+            bool RunPreloadWorker();
+
+            /**
+            * @brief Worker task compiling the queued playlists and reading the queued videos into memory
+            */
+            static void PreloadWorker( void* pSystem );
+
+            /**
+            * @brief Compile a playlist on the preload worker and queue its videos (also fills the playlist cache for the later Open)
+            */
+            void PreloadPlaylist( const char* sPlaylist );
+
+            /**
+            * @brief Open the next prefetched video paused, so its renderer is pooled when the level opens the file
+            */
+            void PreloadNext();
+
+            /**
+            * @brief Release the warmed up videos, the prefetched files and the queue
+            */
+            void ClearPreload();
 
             int m_nGameLoopActive; //!< If <0 then game loop inactive
             int m_nD3DActive; //!< If <0 then the D3D system is inactive
@@ -239,12 +470,70 @@ namespace VideoplayerPlugin
 
             IMaterial* CreateMaterial( IVideoplayer* pVideo, const char* sMaterial, int nMtlFlags = 0 );
             bool OverrideMaterial( IVideoplayer* pVideo, IMaterial* pMaterial, int nSubmat = 0, int nTextureslot = EFTT_DIFFUSE, bool bRecommendedSettings = true );
+            bool OverrideMaterialDecimated( IVideoplayer* pVideo, IMaterial* pMaterial, int nSubmat = 0, int nTextureslot = EFTT_DIFFUSE, bool bRecommendedSettings = true, float fDecimationScale = 1.0f );
             bool ResetMaterial( IMaterial* pMaterial, int nSubmat = 0, bool bResetOverride = false );
+            int OverrideMaterialBatch( IVideoplayer* pVideo, IMaterial** pMaterials, int nMaterials, int nSubmat = 0, int nTextureslot = EFTT_DIFFUSE, bool bRecommendedSettings = true, float fDecimationScale = 1.0f );
 
             void RestoreMaterials( IVideoplayer* pVideo, bool bResetOverride = false );
             void OverrideMaterials( IVideoplayer* pVideo );
 
             void ReleaseMaterials();
+
+            /**
+            * @brief Shader item of a material override, reused if the shader and resource parameters are equal
+            * @return shader item (the cache keeps its reference, SetShaderItem adds one for the material)
+            * @param pTexture video texture set in the resources
+            * @param sShader shader name
+            * @param uGenerationMask shader generation mask
+            * @param nTextureslot texture slot showing the video
+            * @param Res resource parameters including the video texture
+            */
+            SShaderItem LoadShaderItem( ITexture* pTexture, const char* sShader, uint64 uGenerationMask, int nTextureslot, SInputShaderResources& Res );
+
+            /**
+            * @brief Release the cached shader items of a video texture, so the texture can be freed
+            * @param pTexture video texture whose renderer releases its resources
+            */
+            void ReleaseShaderItems( ITexture* pTexture );
+
+            /**
+            * @brief Decimation of a priority class at the current load
+            * @return present every nth frame (0 only keyframes)
+            */
+            unsigned GetLoadDecimation( eVideoPriority ePriority );
+
+            /**
+            * @brief Is decoding of a priority class paused at the current load (only the clock runs)
+            * @return paused
+            */
+            bool IsLoadPaused( eVideoPriority ePriority );
+
+            /**
+            * @brief Reserve the rest of vp_loopbudget for a loop cache about to be filled
+            * @return reserved bytes (0 when less than nMinimum is left)
+            * @param nMinimum smallest useful reservation (one decoded frame)
+            */
+            size_t ReserveLoopBudget( size_t nMinimum );
+
+            /**
+            * @brief Return bytes of a loop cache reservation (filled with less or released)
+            */
+            void ReleaseLoopBudget( size_t nBytes );
+
+            /**
+            * @brief Low-passed time spent advancing the videos
+            * @return milliseconds per frame
+            */
+            float GetLoadTime()
+            {
+                return m_fLoadTime;
+            };
+
+            /**
+            * @brief Close the video warmed up for a file and drop its read ahead copy, so the renderer is reused from the pool by the video opening it
+            * @param sFile file that was just opened (its handle keeps the read ahead copy until it is closed)
+            */
+            void ReleasePreloaded( const char* sFile );
     };
 }
 
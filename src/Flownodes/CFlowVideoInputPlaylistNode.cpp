@@ -5,12 +5,14 @@
 #include <CPluginVideoplayer.h>
 #include <IPluginVideoplayer.h>
 #include <CVideoplayerSystem.h>
+#include <Flownodes/CFlowVideoInputPorts.h>
 #include <Playlist/CVideoplayerPlaylist.h>
 
 namespace VideoplayerPlugin
 {
     class CFlowVideoInputPlaylistNode :
         public CFlowBaseNode<eNCT_Instanced>,
+        public SFlowVideoInputPlaylistPorts,
         private IVideoplayerPlaylistEventListener
     {
 
@@ -92,20 +94,6 @@ namespace VideoplayerPlugin
                 m_bEnd = true;
             }
 
-            enum EInputPorts
-            {
-                EIP_OPEN = 0,
-                EIP_CLOSE,
-                EIP_FILE,
-                EIP_LOOP,
-                EIP_SKIPPABLE,
-                EIP_BLOCKGAME,
-                EIP_STARTAT,
-                EIP_ENDAFTER,
-                EIP_RESUME,
-                EIP_PAUSE,
-            };
-
             enum EOutputPorts
             {
                 EOP_VIDEOID = 0,
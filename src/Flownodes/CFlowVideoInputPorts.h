@@ -0,0 +1,58 @@
+/* Videoplayer_Plugin - for licensing and copyright see license.txt */
+
+#pragma once
+
+namespace VideoplayerPlugin
+{
+    /**
+    * @brief Input ports of the WebM input flownode (Videoplayer_Plugin:InputWebM)
+    * Shared with the level preloading, which reads the ports of the nodes in the loaded flowgraphs.
+    */
+    struct SFlowVideoInputWebMPorts
+    {
+        enum EInputPorts
+        {
+            EIP_OPEN = 0,
+            EIP_CLOSE,
+            EIP_FILE,
+            EIP_SOUND,
+            EIP_LOOP,
+            EIP_SKIPPABLE,
+            EIP_BLOCKGAME,
+            EIP_STARTAT,
+            EIP_ENDAFTER,
+            EIP_CUSTOMWIDTH,
+            EIP_CUSTOMHEIGHT,
+            EIP_TIMESOURCE,
+            EIP_DROPMODE,
+            EIP_SPEED,
+            EIP_VISIBILITY,
+            EIP_PRIORITY,
+            EIP_RESUME,
+            EIP_PAUSE,
+            EIP_SEEK,
+            EIP_POSTION,
+        };
+    };
+
+    /**
+    * @brief Input ports of the playlist input flownode (Videoplayer_Plugin:InputPlaylist)
+    * @see SFlowVideoInputWebMPorts
+    */
+    struct SFlowVideoInputPlaylistPorts
+    {
+        enum EInputPorts
+        {
+            EIP_OPEN = 0,
+            EIP_CLOSE,
+            EIP_FILE,
+            EIP_LOOP,
+            EIP_SKIPPABLE,
+            EIP_BLOCKGAME,
+            EIP_STARTAT,
+            EIP_ENDAFTER,
+            EIP_RESUME,
+            EIP_PAUSE,
+        };
+    };
+}
@@ -5,11 +5,13 @@
 #include <CPluginVideoplayer.h>
 #include <IPluginVideoplayer.h>
 #include <CVideoplayerSystem.h>
+#include <Flownodes/CFlowVideoInputPorts.h>
 
 namespace VideoplayerPlugin
 {
     class CFlowVideoInputWebMNode :
         public CFlowBaseNode<eNCT_Instanced>,
+        public SFlowVideoInputWebMPorts,
         private IVideoplayerEventListener
     {
         private:
@@ -36,28 +38,6 @@ namespace VideoplayerPlugin
                 m_bEnd = true;
             }
 
-            enum EInputPorts
-            {
-                EIP_OPEN = 0,
-                EIP_CLOSE,
-                EIP_FILE,
-                EIP_SOUND,
-                EIP_LOOP,
-                EIP_SKIPPABLE,
-                EIP_BLOCKGAME,
-                EIP_STARTAT,
-                EIP_ENDAFTER,
-                EIP_CUSTOMWIDTH,
-                EIP_CUSTOMHEIGHT,
-                EIP_TIMESOURCE,
-                EIP_DROPMODE,
-                EIP_SPEED,
-                EIP_RESUME,
-                EIP_PAUSE,
-                EIP_SEEK,
-                EIP_POSTION,
-            };
-
             enum EOutputPorts
             {
                 EOP_VIDEOID = 0,
@@ -134,9 +114,11 @@ namespace VideoplayerPlugin
                     InputPortConfig<float>( "EndAfter",      0.0,                _HELP( "end/loop [sec]" ),                            "fEndAfter" ),
                     InputPortConfig<int>( "CustomWidth",     -1,                 _HELP( "custom render width [px]" ),                  "nCustomWidth" ),
                     InputPortConfig<int>( "CustomHeight",    -1,                 _HELP( "custom render height [px]" ),                 "nCustomHeight" ),
-                    InputPortConfig<int>( "TimeSource",      int( VTS_Default ),   _HELP( "timesource to sync to" ),                     "nTimeSource",                  _UICONFIG( "enum_int:Game=1,Sound=2,System=4,SoundOrGame=3,SoundOrSystem=6" ) ),
-                    InputPortConfig<int>( "DropMode",        int( VDM_Default ),   _HELP( "dropmode to use for sync" ),                  "nDropMode",                    _UICONFIG( "enum_int:None=0,Drop=1,Seek=2,DropOutput=4,DropOrSeek=3,DropOutputOrSeek=6" ) ),
+                    InputPortConfig<int>( "TimeSource",      int( VTS_Default ),   _HELP( "timesource to sync to" ),                     "nTimeSource",                  _UICONFIG( "enum_int:Game=1,Sound=2,System=4,SoundOrGame=3,SoundOrSystem=6,Live=8" ) ),
+                    InputPortConfig<int>( "DropMode",        int( VDM_Default ),   _HELP( "dropmode to use for sync" ),                  "nDropMode",                    _UICONFIG( "enum_int:None=0,Drop=1,Seek=2,DropOutput=4,DropOrSeek=3,DropOutputOrSeek=6,Live=8" ) ),
                     InputPortConfig<float>( "Speed",         1.0,                _HELP( "play speed" ),                                "fSpeed" ),
+                    InputPortConfig<int>( "Visibility",      int( VVP_Default ),   _HELP( "behaviour while no output is visible" ),      "nVisibility",                  _UICONFIG( "enum_int:AlwaysDecode=0,PauseWhenHidden=1,ClockOnlyWhenHidden=2" ) ),
+                    InputPortConfig<int>( "Priority",        int( VPR_Default ),   _HELP( "degraded last/first under load" ),            "nPriority",                    _UICONFIG( "enum_int:Critical=0,UI=1,Near=2,Far=3,Auto=4" ) ),
 
                     InputPortConfig_Void( "Resume",                              _HELP( "Resume" ) ),
                     InputPortConfig_Void( "Pause",                               _HELP( "Pause" ) ),
@@ -227,6 +209,8 @@ namespace VideoplayerPlugin
 
                         if ( IsPortActive( pActInfo, EIP_OPEN ) )
                         {
+                            m_pVideo->SetPriority( eVideoPriority( GetPortInt( pActInfo, EIP_PRIORITY ) ) );
+
                             if ( m_pVideo->Open(
                                         GetPortString( pActInfo, EIP_FILE ).c_str(),
                                         GetPortString( pActInfo, EIP_SOUND ).c_str(),
@@ -240,6 +224,7 @@ namespace VideoplayerPlugin
                                         GetPortInt( pActInfo, EIP_CUSTOMWIDTH ),
                                         GetPortInt( pActInfo, EIP_CUSTOMHEIGHT ) ) )
                             {
+                                m_pVideo->SetVisibilityPolicy( eVisibilityPolicy( GetPortInt( pActInfo, EIP_VISIBILITY ) ) );
                                 ActivateOutput<int>( pActInfo, EOP_VIDEOID, m_pVideo->GetId() );
                                 ActivateOutput<float>( pActInfo, EOP_POSITION, m_pVideo->GetPosition() );
                                 ActivateOutput<float>( pActInfo, EOP_DURATION, m_pVideo->GetDuration() );
@@ -276,6 +261,16 @@ namespace VideoplayerPlugin
                             m_pVideo->SetSpeed( GetPortFloat( pActInfo, EIP_SPEED ) );
                         }
 
+                        if ( IsPortActive( pActInfo, EIP_VISIBILITY ) )
+                        {
+                            m_pVideo->SetVisibilityPolicy( eVisibilityPolicy( GetPortInt( pActInfo, EIP_VISIBILITY ) ) );
+                        }
+
+                        if ( IsPortActive( pActInfo, EIP_PRIORITY ) )
+                        {
+                            m_pVideo->SetPriority( eVideoPriority( GetPortInt( pActInfo, EIP_PRIORITY ) ) );
+                        }
+
                         if ( IsPortActive( pActInfo, EIP_TIMESOURCE ) )
                         {
                             m_pVideo->SetTimesource( eTimeSource( GetPortInt( pActInfo, EIP_TIMESOURCE ) ) );
@@ -26,6 +26,7 @@ namespace VideoplayerPlugin
                 EIP_SUBMAT,
                 EIP_TEXSLOT,
                 EIP_RECOMMENDED,
+                EIP_DECIMATIONSCALE,
             };
 
         public:
@@ -72,6 +73,7 @@ namespace VideoplayerPlugin
                     InputPortConfig<int>( "SubMaterial",             0,          _HELP( "submaterial to be modified" ),                    "nSubMat",      _UICONFIG( "" ) ),
                     InputPortConfig<int>( "TextureSlot",             0,          _HELP( "textureslot to be modified" ),                    "nTexSlot",     _UICONFIG( "enum_int:00_DIFFUSE=0,01_BUMP=1,02_GLOSS=2,03_ENV=3,04_DETAIL_OVERLAY=4,05_BUMP_DIFFUSE=5,06_BUMP_HEIGHT=6,07_DECAL_OVERLAY=7,08_SUBSURFACE=8,09_CUSTOM=9,10_CUSTOM_SECONDARY=10,11_OPACITY=11" ) ),
                     InputPortConfig<bool>( "RecommendedSettings",    true,       _HELP( "modify shader and lightning for optimal colors" ), "bRecommendedSettings" ),
+                    InputPortConfig<float>( "DecimationScale",       1.0f,       _HELP( "distance scale for lowering the frame rate when far away (0=never)" ), "fDecimationScale" ),
                     {0},
                 };
 
@@ -120,6 +122,9 @@ namespace VideoplayerPlugin
                                     m_bSoundSource = false;
                                 }
 
+                                // the render node tells if the video is visible
+                                m_pVideo->TrackVisibility( m_pEntity->GetId() );
+
                                 SEntitySlotInfo slotInfo;
                                 int nSlot   = CLAMP( GetPortInt( pActInfo, EIP_SLOT ), -1, m_pEntity->GetSlotCount() - 1 );
 
@@ -137,23 +142,23 @@ namespace VideoplayerPlugin
                                         if ( slotInfo.pCharacter )
                                         {
                                             // TODO maybe move later to character node
-                                            gVideoplayerSystem->OverrideMaterial( m_pVideo, slotInfo.pCharacter->GetMaterial(), GetPortInt( pActInfo, EIP_SUBMAT ), GetPortInt( pActInfo, EIP_TEXSLOT ), GetPortBool( pActInfo, EIP_RECOMMENDED ) );
+                                            gVideoplayerSystem->OverrideMaterialDecimated( m_pVideo, slotInfo.pCharacter->GetMaterial(), GetPortInt( pActInfo, EIP_SUBMAT ), GetPortInt( pActInfo, EIP_TEXSLOT ), GetPortBool( pActInfo, EIP_RECOMMENDED ), GetPortFloat( pActInfo, EIP_DECIMATIONSCALE ) );
                                         }
 
                                         if ( slotInfo.pStatObj )
                                         {
-                                            gVideoplayerSystem->OverrideMaterial( m_pVideo, slotInfo.pStatObj->GetMaterial(), GetPortInt( pActInfo, EIP_SUBMAT ), GetPortInt( pActInfo, EIP_TEXSLOT ), GetPortBool( pActInfo, EIP_RECOMMENDED ) );
+                                            gVideoplayerSystem->OverrideMaterialDecimated( m_pVideo, slotInfo.pStatObj->GetMaterial(), GetPortInt( pActInfo, EIP_SUBMAT ), GetPortInt( pActInfo, EIP_TEXSLOT ), GetPortBool( pActInfo, EIP_RECOMMENDED ), GetPortFloat( pActInfo, EIP_DECIMATIONSCALE ) );
                                         }
 
                                         if ( slotInfo.pChildRenderNode )
                                         {
                                             // TODO this provides instance based overrides
-                                            gVideoplayerSystem->OverrideMaterial( m_pVideo, slotInfo.pChildRenderNode->GetMaterialOverride(), GetPortInt( pActInfo, EIP_SUBMAT ), GetPortInt( pActInfo, EIP_TEXSLOT ), GetPortBool( pActInfo, EIP_RECOMMENDED ) );
+                                            gVideoplayerSystem->OverrideMaterialDecimated( m_pVideo, slotInfo.pChildRenderNode->GetMaterialOverride(), GetPortInt( pActInfo, EIP_SUBMAT ), GetPortInt( pActInfo, EIP_TEXSLOT ), GetPortBool( pActInfo, EIP_RECOMMENDED ), GetPortFloat( pActInfo, EIP_DECIMATIONSCALE ) );
                                         }
 
                                         if ( slotInfo.pMaterial )
                                         {
-                                            gVideoplayerSystem->OverrideMaterial( m_pVideo, slotInfo.pMaterial, GetPortInt( pActInfo, EIP_SUBMAT ), GetPortInt( pActInfo, EIP_TEXSLOT ), GetPortBool( pActInfo, EIP_RECOMMENDED ) );
+                                            gVideoplayerSystem->OverrideMaterialDecimated( m_pVideo, slotInfo.pMaterial, GetPortInt( pActInfo, EIP_SUBMAT ), GetPortInt( pActInfo, EIP_TEXSLOT ), GetPortBool( pActInfo, EIP_RECOMMENDED ), GetPortFloat( pActInfo, EIP_DECIMATIONSCALE ) );
                                         }
                                     }
                                 }
@@ -161,7 +166,7 @@ namespace VideoplayerPlugin
                                 // e.g. for normal entities
                                 if ( nSlot <= 0 || m_pEntity->GetSlotCount() <= 0 )
                                 {
-                                    gVideoplayerSystem->OverrideMaterial( m_pVideo, m_pEntity->GetMaterial(), GetPortInt( pActInfo, EIP_SUBMAT ), GetPortInt( pActInfo, EIP_TEXSLOT ), GetPortBool( pActInfo, EIP_RECOMMENDED ) );
+                                    gVideoplayerSystem->OverrideMaterialDecimated( m_pVideo, m_pEntity->GetMaterial(), GetPortInt( pActInfo, EIP_SUBMAT ), GetPortInt( pActInfo, EIP_TEXSLOT ), GetPortBool( pActInfo, EIP_RECOMMENDED ), GetPortFloat( pActInfo, EIP_DECIMATIONSCALE ) );
                                 }
                             }
                         }
@@ -173,6 +178,11 @@ namespace VideoplayerPlugin
                                 m_pVideo->GetSoundplayer()->RemoveSoundProxy( m_pEntity );
                             }
 
+                            if ( m_pVideo )
+                            {
+                                m_pVideo->TrackVisibility( m_pEntity->GetId(), false );
+                            }
+
                             SEntitySlotInfo slotInfo;
                             int nSlot   = CLAMP( GetPortInt( pActInfo, EIP_SLOT ), -1, m_pEntity->GetSlotCount() - 1 );
 
@@ -22,6 +22,7 @@ namespace VideoplayerPlugin
                 EIP_SUBMAT,
                 EIP_TEXSLOT,
                 EIP_RECOMMENDED,
+                EIP_DECIMATIONSCALE,
             };
 
         public:
@@ -62,6 +63,7 @@ namespace VideoplayerPlugin
                     InputPortConfig<int>( "SubMaterial",             0,          _HELP( "submaterial to be modified" ),                    "nSubMat",      _UICONFIG( "" ) ),
                     InputPortConfig<int>( "TextureSlot",             0,          _HELP( "textureslot to be modified" ),                    "nTexSlot",     _UICONFIG( "enum_int:00_DIFFUSE=0,01_BUMP=1,02_GLOSS=2,03_ENV=3,04_DETAIL_OVERLAY=4,05_BUMP_DIFFUSE=5,06_BUMP_HEIGHT=6,07_DECAL_OVERLAY=7,08_SUBSURFACE=8,09_CUSTOM=9,10_CUSTOM_SECONDARY=10,11_OPACITY=11" ) ),
                     InputPortConfig<bool>( "RecommendedSettings",    true,       _HELP( "modify shader and lightning for optimal colors" ), "bRecommendedSettings" ),
+                    InputPortConfig<float>( "DecimationScale",       1.0f,       _HELP( "distance scale for lowering the frame rate when far away (0=never)" ), "fDecimationScale" ),
                     {0},
                 };
 
@@ -94,7 +96,7 @@ namespace VideoplayerPlugin
 
                             if ( m_pVideo )
                             {
-                                gVideoplayerSystem->OverrideMaterial( m_pVideo, gEnv->p3DEngine->GetMaterialManager()->FindMaterial( GetPortString( pActInfo, EIP_MATERIAL ) ), GetPortInt( pActInfo, EIP_SUBMAT ), GetPortInt( pActInfo, EIP_TEXSLOT ), GetPortBool( pActInfo, EIP_RECOMMENDED ) );
+                                gVideoplayerSystem->OverrideMaterialDecimated( m_pVideo, gEnv->p3DEngine->GetMaterialManager()->FindMaterial( GetPortString( pActInfo, EIP_MATERIAL ) ), GetPortInt( pActInfo, EIP_SUBMAT ), GetPortInt( pActInfo, EIP_TEXSLOT ), GetPortBool( pActInfo, EIP_RECOMMENDED ), GetPortFloat( pActInfo, EIP_DECIMATIONSCALE ) );
                             }
                         }
 
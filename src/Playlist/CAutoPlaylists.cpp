@@ -3,6 +3,7 @@
 #include <StdAfx.h>
 #include <CVideoplayerSystem.h>
 #include <Playlist/CAutoPlaylists.h>
+#include <Playlist/CVideoplayerPlaylist.h>
 
 namespace VideoplayerPlugin
 {
@@ -63,28 +64,44 @@ namespace VideoplayerPlugin
         }
     }
 
-    void CAutoPlaylists::OnScreenChange()
+    void CAutoPlaylists::OnScreenChange( IVideoplayerPlaylist* pKeep )
     {
-        if ( m_pSplashScreen )
+        if ( m_pSplashScreen && m_pSplashScreen != pKeep )
         {
             //  m_pSplashScreen->UnregisterListener(this);
             m_pSplashScreen->Close();
         }
 
-        if ( m_pMenu )
+        if ( m_pMenu && m_pMenu != pKeep )
         {
             m_pMenu->Close();
         }
 
-        if ( m_pMenuIngame )
+        if ( m_pMenuIngame && m_pMenuIngame != pKeep )
         {
             m_pMenuIngame->Close();
         }
 
-        if ( m_pLevelLoaded )
+        if ( m_pLevelLoaded && m_pLevelLoaded != pKeep )
         {
             m_pLevelLoaded->Close();
         }
+
+        // back in the game the ingame menu is expected next
+        if ( !pKeep && gVideoplayerSystem->GetScreenState() == eSS_InGameScreen )
+        {
+            PreloadMenu( true );
+        }
+    }
+
+    void CAutoPlaylists::PreloadMenu( bool bInGame )
+    {
+        CVideoplayerPlaylist* pMenu = ( CVideoplayerPlaylist* )( bInGame ? m_pMenuIngame : m_pMenu );
+
+        if ( pMenu && gVideoplayerSystem->vp_warmstart > 0 )
+        {
+            pMenu->Preload( bInGame ? AUTOPLAY_MENU_INGAME : AUTOPLAY_MENU );
+        }
     }
 
     void CAutoPlaylists::OnStart()
@@ -108,7 +125,13 @@ namespace VideoplayerPlugin
     }
 
     void CAutoPlaylists::OnStartPlaylist( IVideoplayerPlaylist* pPlaylist )
-    {}
+    {
+        // the splash screen shows its first frame, the menu follows it
+        if ( pPlaylist == m_pSplashScreen && gVideoplayerSystem->GetScreenState() == eSS_StartScreen )
+        {
+            PreloadMenu( false );
+        }
+    }
 
     void CAutoPlaylists::OnEndPlaylist( IVideoplayerPlaylist* pPlaylist )
     {
@@ -120,7 +143,8 @@ namespace VideoplayerPlugin
 
     void CAutoPlaylists::OnMenu( bool bInGame )
     {
-        OnScreenChange();
+        // a preloaded menu is kept and only gets its outputs
+        OnScreenChange( bInGame ? m_pMenuIngame : m_pMenu );
 
         if ( m_pMenu && !bInGame )
         {
@@ -148,5 +172,7 @@ namespace VideoplayerPlugin
             m_pLevelLoaded->Open( sPath.c_str() );
             m_pLevelLoaded->Resume();
         }
+
+        PreloadMenu( true );
     }
 }
\ No newline at end of file
@@ -15,12 +15,18 @@ namespace VideoplayerPlugin
             IVideoplayerPlaylist* m_pMenuIngame;
             IVideoplayerPlaylist* m_pLevelLoaded;
 
+            /**
+            * @brief Preload a menu playlist so it is shown without a stall @see vp_warmstart
+            * @param bInGame ingame menu instead of the main menu
+            */
+            void PreloadMenu( bool bInGame );
+
         public:
             CAutoPlaylists();
             ~CAutoPlaylists();
 
             // Events
-            void OnScreenChange();
+            void OnScreenChange( IVideoplayerPlaylist* pKeep = NULL );
             void OnSkip( bool bForce = false );
             void OnStart();
             void OnMenu( bool bInGame = false );
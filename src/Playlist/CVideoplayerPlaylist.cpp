@@ -4,8 +4,10 @@
 #include <CPluginVideoplayer.h>
 #include <CVideoplayerSystem.h>
 #include <Playlist/CVideoplayerPlaylist.h>
+#include <WebM/CWebMWrapper.h>
 #include <sstream>
 #include <ios>
+#include <map>
 
 #include <PMUtils.hpp>
 
@@ -161,10 +163,324 @@ namespace VideoplayerPlugin
 #define XML_CUSTOMHEIGHT "customheight"
 #define XML_TIMESOURCE "timesource"
 #define XML_DROPMODE "dropmode"
+#define XML_VISIBILITY "visibility"
+#define XML_PRIORITY "priority"
+#define XML_CROSSFADE "crossfade"
+
+    ColorF convColor( const ColorB& src )
+    {
+        ColorF ret;
+
+        ret.a = src.a / 255.0f;
+        ret.r = src.r / 255.0f;
+        ret.g = src.g / 255.0f;
+        ret.b = src.b / 255.0f;
+
+        return ret;
+    }
+
+    /**
+    * @brief Index of a string in the string table, added if it isn't there yet
+    */
+    static unsigned InternString( const string& sValue, std::vector<string>& vStrings, std::map<string, unsigned>& mapStrings )
+    {
+        std::map<string, unsigned>::const_iterator iter = mapStrings.find( sValue );
+
+        if ( iter != mapStrings.end() )
+        {
+            return ( *iter ).second;
+        }
+
+        unsigned nString = vStrings.size();
+        vStrings.push_back( sValue );
+        mapStrings[sValue] = nString;
+
+        return nString;
+    }
+
+    /**
+    * @brief Lua condition of a node
+    * @return condition, empty for none
+    */
+    static string GetCondition( XmlNodeRef xmlNode )
+    {
+        return xmlNode ? SGetAttr( xmlNode, XML_IF, string( "" ) ).Trim() : string( "" );
+    }
+
+    void SCompiledPlaylist::reset()
+    {
+        vStrings.clear();
+        vStrings.push_back( "" );
+        vScenes.clear();
+        vItems.clear();
+        vInputs.clear();
+        vOutputs.clear();
+        vCommands.clear();
+        vTimeline.clear();
+        vTimeline.push_back( 0 );
+
+        nShowMenuOnEnd = -1;
+        nModified = 0;
+        nSize = 0;
+    }
+
+    void SCompiledPlaylist::compile( XmlNodeRef xmlPlaylist )
+    {
+        reset();
+
+        std::map<string, unsigned> mapStrings;
+        mapStrings[""] = 0;
+
+        // without the attribute the default of the playlist instance is used
+        const char* sShowMenu = xmlPlaylist->haveAttr( XML_ONENDSHOWMENU ) ? SSTRING( xmlPlaylist->getAttr( XML_ONENDSHOWMENU ) ) : "";
+
+        if ( !isempty( sShowMenu ) )
+        {
+            nShowMenuOnEnd = ToBool( sShowMenu ) ? 1 : 0;
+        }
+
+        int iSceneCount = xmlPlaylist->getChildCount();
+
+        for ( int iScene = 0; iScene < iSceneCount; ++iScene )
+        {
+            XmlNodeRef xmlScene = xmlPlaylist->getChild( iScene );
+
+            SPlaylistScene scene;
+            scene.bValid = xmlScene != NULL && xmlScene->isTag( XML_SCENE );
+            scene.nCondition = InternString( GetCondition( xmlScene ), vStrings, mapStrings );
+            scene.bSkippable = scene.bValid ? SGetAttr( xmlScene, XML_SKIPPABLE, true ) : true;
+            scene.bLoop = scene.bValid ? SGetAttr( xmlScene, XML_LOOP, false ) : false;
+            scene.nFirstItem = vItems.size();
+            scene.nLine = xmlScene ? xmlScene->getLine() : xmlPlaylist->getLine();
+            scene.fDuration = 0;
+            scene.fCrossfade = scene.bValid ? max( SGetAttr( xmlScene, XML_CROSSFADE, 0.0f ), 0.0f ) : 0;
+
+            int iItemCount = scene.bValid ? xmlScene->getChildCount() : 0;
+
+            for ( int iItem = 0; iItem < iItemCount; ++iItem )
+            {
+                XmlNodeRef xmlChild = xmlScene->getChild( iItem );
+
+                SPlaylistItem item;
+                item.eType = SPlaylistItem::PIT_Invalid;
+                item.nCondition = InternString( GetCondition( xmlChild ), vStrings, mapStrings );
+                item.nIndex = 0;
+                item.nLine = xmlChild ? xmlChild->getLine() : scene.nLine;
+
+                if ( xmlChild && xmlChild->isTag( XML_COMMAND ) )
+                {
+                    string sCommand = SGetContent( xmlChild, "" ).Trim();
+
+                    if ( sCommand.length() > 0 )
+                    {
+                        SPlaylistCommand command;
+                        command.bLua = SGetAttr<string>( xmlChild, XML_CLASS, string( XML_COMMAND ) ).MakeLower() == XML_LUA;
+                        command.nCommand = InternString( sCommand, vStrings, mapStrings );
+                        command.nFilter = InternString( SGetAttr( xmlChild, XML_DELAYFILTER, string( "" ) ), vStrings, mapStrings );
+                        command.nDelayType = PluginManager::eDT_None;
+                        command.fDelay = SGetAttr( xmlChild, XML_DELAYFRAMES, -1.0f );
+
+                        if ( command.fDelay > 0 )
+                        {
+                            command.nDelayType = PluginManager::eDT_Frames;
+                        }
+
+                        else
+                        {
+                            command.fDelay = SGetAttr( xmlChild, XML_DELAYSECONDS, -1.0f );
+
+                            if ( command.fDelay > 0 )
+                            {
+                                command.nDelayType = PluginManager::eDT_Seconds;
+                            }
+                        }
+
+                        item.eType = SPlaylistItem::PIT_Command;
+                        item.nIndex = vCommands.size();
+                        vCommands.push_back( command );
+                    }
+
+                    else
+                    {
+                        gPlugin->LogWarning( "Playlist Scene Command empty near XML Line %d", item.nLine );
+                    }
+                }
+
+                else if ( xmlChild && xmlChild->isTag( XML_INPUT ) )
+                {
+                    SPlaylistInput input;
+                    input.nClass = InternString( SGetAttr<string>( xmlChild, XML_CLASS, string( "inputwebm" ) ), vStrings, mapStrings );
+                    input.nVideo = InternString( SGetAttr<string>( xmlChild, XML_VIDEO, string( "" ) ), vStrings, mapStrings );
+                    input.nSound = InternString( SGetAttr<string>( xmlChild, XML_SOUND, string( "" ) ), vStrings, mapStrings );
+
+                    input.fStartAt = SGetAttr( xmlChild, XML_STARTAT, 0.0f );
+                    input.fEndAfter = SGetAttr( xmlChild, XML_ENDAFTER, 0.0f );
+                    input.fSpeed = SGetAttr( xmlChild, XML_SPEED, 1.0f );
+
+                    input.bLoop = SGetAttr( xmlChild, XML_LOOP, false );
+
+                    input.bSkippable = SGetAttr<int>( xmlChild, XML_SKIPPABLE, true );
+                    input.bBlockGame = SGetAttr<int>( xmlChild, XML_BLOCKGAME, false );
+
+                    input.nCustomWidth = SGetAttr( xmlChild, XML_WIDTH, -1 );
+                    input.nCustomHeight = SGetAttr( xmlChild, XML_HEIGHT, -1 );
+
+                    input.eTS = eTimeSource( SGetAttr<int>( xmlChild, XML_TIMESOURCE, VTS_DefaultPlaylist ) );
+                    input.eDM = eDropMode( SGetAttr<int>( xmlChild, XML_DROPMODE, VDM_Default ) );
+                    input.eVP = eVisibilityPolicy( SGetAttr<int>( xmlChild, XML_VISIBILITY, VVP_Default ) );
+                    input.ePriority = eVideoPriority( SGetAttr<int>( xmlChild, XML_PRIORITY, VPR_Default ) );
+
+                    input.nFirstOutput = vOutputs.size();
+
+                    int iOutputCount = xmlChild->getChildCount();
+
+                    for ( int iOutput = 0; iOutput < iOutputCount; ++iOutput )
+                    {
+                        XmlNodeRef xmlOutput = xmlChild->getChild( iOutput );
+
+                        if ( xmlOutput && xmlOutput->isTag( XML_OUTPUT ) )
+                        {
+                            SPlaylistOutput output;
+                            output.bSoundsource = SGetAttr( xmlOutput, XML_SOUNDSOURCE, true );
+                            output.nResizeMode = eResizeMode( SGetAttr<int>( xmlOutput, XML_RESIZEMODE, VRM_Default ) );
+                            output.fCustomAR = SGetAttr( xmlOutput, XML_CUSTOMAR, 0.0f );
+                            output.fRelTop = SGetAttr( xmlOutput, XML_TOP, 0.0f );
+                            output.fRelLeft = SGetAttr( xmlOutput, XML_LEFT, 0.0f );
+                            output.fRelWidth = SGetAttr( xmlOutput, XML_WIDTH, 1.0f );
+                            output.fRelHeight = SGetAttr( xmlOutput, XML_HEIGHT, 1.0f );
+                            output.fAngle = SGetAttr( xmlOutput, XML_ANGLE, 0.0f );
+                            output.cRGBA = convColor( SGetAttr<ColorB>( xmlOutput, XML_RGBA, Col_White ) );
+                            output.cBG_RGBA = convColor( SGetAttr<ColorB>( xmlOutput, XML_BACKGROUNDRGBA, Col_Black ) );
+                            output.nZPos = eZPos( SGetAttr<int>( xmlOutput, XML_ZORDER, VZP_Default ) );
+                            vOutputs.push_back( output );
+                        }
+
+                        else
+                        {
+                            gPlugin->LogWarning( "Playlist Scene Output invalid near XML Line %d", xmlOutput ? xmlOutput->getLine() : item.nLine );
+                        }
+                    }
+
+                    input.nOutputs = vOutputs.size() - input.nFirstOutput;
+
+                    // the header is enough for the timeline, nothing is decoded
+                    // (live inputs have no duration and probing would consume their data, e.g. connect to a pipe)
+                    input.fDuration = -1;
+
+                    if ( !( input.eTS & VTS_Live ) && !( input.eDM & VDM_Live ) )
+                    {
+                        float fEnd = probeVPXDecDuration( getString( input.nVideo ) );
+
+                        if ( input.fEndAfter > VIDEO_EPSILON && ( fEnd < 0 || input.fEndAfter < fEnd ) )
+                        {
+                            fEnd = input.fEndAfter;
+                        }
+
+                        if ( fEnd >= 0 && input.fSpeed > VIDEO_EPSILON )
+                        {
+                            input.fDuration = max( fEnd - input.fStartAt, 0.0f ) / input.fSpeed;
+                            scene.fDuration = max( scene.fDuration, input.fDuration );
+                        }
+                    }
+
+                    item.eType = SPlaylistItem::PIT_Input;
+                    item.nIndex = vInputs.size();
+                    vInputs.push_back( input );
+                }
+
+                vItems.push_back( item );
+            }
+
+            scene.nItems = vItems.size() - scene.nFirstItem;
+            vScenes.push_back( scene );
+            vTimeline.push_back( vTimeline.back() + scene.fDuration );
+        }
+    }
+
+    int SCompiledPlaylist::findScene( float fPos, int nFirst, int nEnd ) const
+    {
+        if ( nEnd <= nFirst )
+        {
+            return nFirst;
+        }
+
+        // first scene starting after the position, the one before contains it
+        std::vector<float>::const_iterator iter = std::upper_bound( vTimeline.begin() + nFirst + 1, vTimeline.begin() + nEnd, fPos );
+        return int( iter - vTimeline.begin() ) - 1;
+    }
+
+    typedef std::map<string, SCompiledPlaylist> tCompiledPlaylistCache;
+    tCompiledPlaylistCache mapCompiledPlaylists; //!< compiled playlists by file, replaced when the file changes
+    Concurrency::critical_section csCompiledPlaylists; //!< the level preload compiles playlists on a worker
+
+    /**
+    * @brief Compile a playlist or take it from the cache if the file didn't change
+    * @param sPlaylist playlist file
+    * @param[out] compiled compiled playlist
+    * @return success
+    */
+    static bool LoadCompiledPlaylist( const char* sPlaylist, SCompiledPlaylist& compiled )
+    {
+        uint64 nModified = 0;
+        size_t nSize = 0;
+        FILE* pFile = gEnv->pCryPak->FOpen( sPlaylist, "rb" );
+
+        if ( pFile )
+        {
+            nModified = gEnv->pCryPak->GetModificationTime( pFile );
+            nSize = gEnv->pCryPak->FGetSize( pFile );
+            gEnv->pCryPak->FClose( pFile );
+        }
+
+        bool bCache = pFile && gVideoplayerSystem->vp_playlistcache;
+
+        if ( bCache )
+        {
+            Concurrency::critical_section::scoped_lock lock( csCompiledPlaylists );
+            tCompiledPlaylistCache::const_iterator iter = mapCompiledPlaylists.find( sPlaylist );
+
+            if ( iter != mapCompiledPlaylists.end() && ( *iter ).second.nModified == nModified && ( *iter ).second.nSize == nSize )
+            {
+                compiled = ( *iter ).second;
+                return true;
+            }
+        }
+
+        XmlNodeRef xmlPlaylist = gEnv->pSystem->LoadXmlFromFile( sPlaylist );
+
+        if ( xmlPlaylist == NULL )
+        {
+            return false;
+        }
+
+        compiled.compile( xmlPlaylist );
+        compiled.nModified = nModified;
+        compiled.nSize = nSize;
+
+#if defined(_DEBUG)
+        gPlugin->LogAlways( "Playlist compiled file(%s) scenes(%u) inputs(%u) commands(%u) strings(%u) duration(%.2fs)", sPlaylist, unsigned( compiled.vScenes.size() ), unsigned( compiled.vInputs.size() ), unsigned( compiled.vCommands.size() ), unsigned( compiled.vStrings.size() ), compiled.vTimeline.back() );
+#endif
+
+        if ( bCache )
+        {
+            Concurrency::critical_section::scoped_lock lock( csCompiledPlaylists );
+            mapCompiledPlaylists[sPlaylist] = compiled;
+        }
+
+        return true;
+    }
+
+    bool CVideoplayerPlaylist::Compile( const char* sPlaylist, SCompiledPlaylist& compiled )
+    {
+        return LoadCompiledPlaylist( sPlaylist, compiled );
+    }
 
     CVideoplayerPlaylist::CVideoplayerPlaylist( bool bShowMenuOnEndDefault )
     {
-        m_xmlPlaylist = NULL;
+        m_bLoaded = false;
+        m_iSceneFade = -1;
+        m_bFadeBlend = false;
+        m_bPreloaded = false;
         m_bShowMenuOnEnd = bShowMenuOnEndDefault;
         m_bShowMenuOnEndDefault = bShowMenuOnEndDefault;
 
@@ -250,6 +566,13 @@ namespace VideoplayerPlugin
         gPlugin->LogAlways( "Playlist OnEndScene file(%s) scenes(%d) scene(%d)", m_sFile.c_str(), m_iSceneCount, nIndex );
 #endif
 
+        // the incoming scene of the crossfade is already open
+        if ( m_iSceneFade >= 0 )
+        {
+            EndCrossfade( true );
+            return;
+        }
+
         if ( m_CurrentScene.bLoop )
         {
             m_iScene = m_iScene > 0 ? --m_iScene : 0;
@@ -316,6 +639,8 @@ namespace VideoplayerPlugin
 
         eTS = VTS_DefaultPlaylist;
         eDM = VDM_Default;
+        eVP = VVP_Default;
+        ePriority = VPR_Default;
 
         if ( pVideo )
         {
@@ -372,126 +697,110 @@ namespace VideoplayerPlugin
         }
     }
 
-    bool SVideoInput::init( XmlNodeRef xmlInput, CVideoplayerPlaylist* pPlaylist )
+    bool SVideoInput::init( const SCompiledPlaylist& playlist, const SPlaylistInput& desc, CVideoplayerPlaylist* pPlaylist )
     {
         bool bRet = false;
 
         reset();
 
-        if ( xmlInput && xmlInput->isTag( XML_INPUT ) )
-        {
-            sClass = SGetAttr<string>( xmlInput, XML_CLASS, string( "inputwebm" ) );
-            sVideo = SGetAttr<string>( xmlInput, XML_VIDEO, string( "" ) );
-            sSound = SGetAttr<string>( xmlInput, XML_SOUND, string( "" ) );
+        sClass = playlist.getString( desc.nClass );
+        sVideo = playlist.getString( desc.nVideo );
+        sSound = playlist.getString( desc.nSound );
 
-            fStartAt = SGetAttr( xmlInput, XML_STARTAT, 0.0f );
-            fEndAfter = SGetAttr( xmlInput, XML_ENDAFTER, 0.0f );
-            fSpeed = SGetAttr( xmlInput, XML_SPEED, 1.0f );
+        fStartAt = desc.fStartAt;
+        fEndAfter = desc.fEndAfter;
+        fSpeed = desc.fSpeed;
 
-            bLoop = SGetAttr( xmlInput, XML_LOOP, false );
+        bLoop = desc.bLoop;
 
-            bSkippable = SGetAttr<int>( xmlInput, XML_SKIPPABLE, true );
-            bBlockGame = SGetAttr<int>( xmlInput, XML_BLOCKGAME, false );
+        bSkippable = desc.bSkippable;
+        bBlockGame = desc.bBlockGame;
 
-            nCustomWidth = SGetAttr( xmlInput, XML_WIDTH, -1 );
-            nCustomHeight = SGetAttr( xmlInput, XML_HEIGHT, -1 );
+        nCustomWidth = desc.nCustomWidth;
+        nCustomHeight = desc.nCustomHeight;
 
-            eTS = eTimeSource( SGetAttr<int>( xmlInput, XML_TIMESOURCE, VTS_DefaultPlaylist ) );
-            eDM = eDropMode( SGetAttr<int>( xmlInput, XML_DROPMODE, VDM_Default ) );
+        eTS = desc.eTS;
+        eDM = desc.eDM;
+        eVP = desc.eVP;
+        ePriority = desc.ePriority;
 
-            this->pPlaylist = pPlaylist;
-            pVideo = gVideoplayerSystem->CreateVideoplayer();
+        this->pPlaylist = pPlaylist;
+        pVideo = gVideoplayerSystem->CreateVideoplayer();
 
-            if ( pVideo && pVideo->Open( sVideo, sSound, bLoop, bSkippable, bBlockGame, eTS, eDM, fStartAt, fEndAfter, nCustomWidth, nCustomHeight ) )
-            {
-                pVideo->SetSpeed( fSpeed );
-                pVideo->RegisterListener( this );
-                bRet = true;
-            }
+        if ( pVideo )
+        {
+            pVideo->SetPriority( ePriority );
+        }
+
+        if ( pVideo && pVideo->Open( sVideo, sSound, bLoop, bSkippable, bBlockGame, eTS, eDM, fStartAt, fEndAfter, nCustomWidth, nCustomHeight ) )
+        {
+            pVideo->SetSpeed( fSpeed );
+            pVideo->SetVisibilityPolicy( eVP );
+            pVideo->RegisterListener( this );
+            bRet = true;
         }
 
         return bRet;
     }
 
-    ColorF convColor( const ColorB& src )
+    bool SSceneInput::init( const SCompiledPlaylist& playlist, unsigned nInput, CVideoplayerPlaylist* pPlaylist, bool bOutputs )
     {
-        ColorF ret;
+        v2DOutputs.clear();
 
-        ret.a = src.a / 255.0f;
-        ret.r = src.r / 255.0f;
-        ret.g = src.g / 255.0f;
-        ret.b = src.b / 255.0f;
+        this->nInput = nInput;
+        bool bRet = input.init( playlist, playlist.vInputs[nInput], pPlaylist );
 
-        return ret;
+        if ( bRet && bOutputs )
+        {
+            createOutputs( playlist );
+        }
+
+        return bRet;
     }
 
-    bool SSceneInput::init( XmlNodeRef xmlInput, CVideoplayerPlaylist* pPlaylist )
+    void SSceneInput::createOutputs( const SCompiledPlaylist& playlist )
     {
-        bool bRet = false;
-        v2DOutputs.clear();
+        const SPlaylistInput& desc = playlist.vInputs[nInput];
 
-        if ( xmlInput && xmlInput->isTag( XML_INPUT ) )
+        if ( input.pVideo && v2DOutputs.empty() )
         {
-            bRet = input.init( xmlInput, pPlaylist );
-
-            if ( bRet && input.pVideo )
+            for ( unsigned nOutput = desc.nFirstOutput; nOutput < desc.nFirstOutput + desc.nOutputs; ++nOutput )
             {
-                int iOutputCount = xmlInput->getChildCount();
+                const SPlaylistOutput& output = playlist.vOutputs[nOutput];
+                S2DVideo* pVideo = gVideoplayerSystem->Create2DVideo();
 
-                for ( int iOutput = 0; iOutput < iOutputCount; ++iOutput )
+                if ( pVideo )
                 {
-                    XmlNodeRef xmlOutput = xmlInput->getChild( iOutput );
-
-                    if ( xmlOutput && xmlOutput->isTag( XML_OUTPUT ) )
-                    {
-                        S2DVideo* pVideo = gVideoplayerSystem->Create2DVideo();
-
-                        if ( pVideo )
-                        {
-                            pVideo->SetVideo( input.pVideo );
-                            pVideo->SetSoundsource( SGetAttr( xmlOutput, XML_SOUNDSOURCE, true ) );
-                            pVideo->nResizeMode = eResizeMode( SGetAttr<int>( xmlOutput, XML_RESIZEMODE, VRM_Default ) );
-                            pVideo->fCustomAR = SGetAttr( xmlOutput, XML_CUSTOMAR, 0.0f );
-                            pVideo->fRelTop = SGetAttr( xmlOutput, XML_TOP, 0.0f );
-                            pVideo->fRelLeft = SGetAttr( xmlOutput, XML_LEFT, 0.0f );
-                            pVideo->fRelWidth = SGetAttr( xmlOutput, XML_WIDTH, 1.0f );
-                            pVideo->fRelHeight = SGetAttr( xmlOutput, XML_HEIGHT, 1.0f );
-                            pVideo->fAngle = SGetAttr( xmlOutput, XML_ANGLE, 0.0f );
-                            pVideo->cRGBA = convColor( SGetAttr<ColorB>( xmlOutput, XML_RGBA, Col_White ) );
-                            pVideo->cBG_RGBA = convColor( SGetAttr<ColorB>( xmlOutput, XML_BACKGROUNDRGBA, Col_Black ) );
-                            pVideo->nZPos = eZPos( SGetAttr<int>( xmlOutput, XML_ZORDER, VZP_Default ) );
-                            v2DOutputs.push_back( pVideo );
-                        }
-                    }
-
-                    else
-                    {
-                        gPlugin->LogWarning( "Playlist Scene Output invalid near XML Line %d", xmlOutput ? xmlOutput->getLine() : xmlInput->getLine() );
-                    }
+                    pVideo->SetVideo( input.pVideo );
+                    pVideo->SetSoundsource( output.bSoundsource );
+                    pVideo->nResizeMode = output.nResizeMode;
+                    pVideo->fCustomAR = output.fCustomAR;
+                    pVideo->fRelTop = output.fRelTop;
+                    pVideo->fRelLeft = output.fRelLeft;
+                    pVideo->fRelWidth = output.fRelWidth;
+                    pVideo->fRelHeight = output.fRelHeight;
+                    pVideo->fAngle = output.fAngle;
+                    pVideo->cRGBA = output.cRGBA;
+                    pVideo->cBG_RGBA = output.cBG_RGBA;
+                    pVideo->nZPos = output.nZPos;
+                    v2DOutputs.push_back( pVideo );
                 }
             }
         }
-
-        return bRet;
     }
 
     /**
     * @brief Test a Lua Condition
-    * @param xmlInput Current XML Node
+    * @param sCondition Lua logic, empty for none
     * @return success true
     */
-    bool IfCondition( XmlNodeRef xmlNode )
+    bool IfCondition( const char* sCondition )
     {
         bool bRet = true; // Return true if no condition exists
 
-        if ( xmlNode && gPluginManager )
+        if ( *sCondition && gPluginManager )
         {
-            string sCondition = SGetAttr( xmlNode, XML_IF, string( "" ) ).Trim();
-
-            if ( sCondition.length() > 0 )
-            {
-                bRet =  gPluginManager->TestLuaLogic( sCondition.c_str() );
-            }
+            bRet = gPluginManager->TestLuaLogic( sCondition );
         }
 
         return bRet;
@@ -499,119 +808,113 @@ namespace VideoplayerPlugin
 
     /**
     * @brief Execute a Command / Lua
-    * @param xmlInput Current XML Node
+    * @param playlist Compiled playlist holding the strings
+    * @param command Command to execute
     * @return success true
     */
-    bool SceneCommand( XmlNodeRef xmlInput )
+    bool SceneCommand( const SCompiledPlaylist& playlist, const SPlaylistCommand& command )
     {
-        bool bRet = false;
+        string sCommand = playlist.getString( command.nCommand );
+        string sFilter = playlist.getString( command.nFilter );
+        PluginManager::eDelayType eType = PluginManager::eDelayType( command.nDelayType );
 
-        if ( xmlInput && xmlInput->isTag( XML_COMMAND ) )
+        if ( command.bLua )
         {
-            string sClass = SGetAttr<string>( xmlInput, XML_CLASS, string( XML_COMMAND ) ).MakeLower();
-
-            string sCommand = SGetContent( xmlInput, "" ).Trim();
-
-            if ( sCommand.length() > 0 )
+            if ( eType == PluginManager::eDT_None )
             {
-                PluginManager::eDelayType eType = PluginManager::eDT_None;
-
-                float fDelay = SGetAttr( xmlInput, XML_DELAYFRAMES, -1.0f );
-
-                if ( fDelay > 0 )
-                {
-                    eType = PluginManager::eDT_Frames;
-                }
-
-                else
-                {
-                    fDelay = SGetAttr( xmlInput, XML_DELAYSECONDS, -1.0f );
-
-                    if ( fDelay > 0 )
-                    {
-                        eType = PluginManager::eDT_Seconds;
-                    }
-                }
-
-                if ( sClass == XML_LUA )
-                {
-                    if ( eType == PluginManager::eDT_None )
-                    {
-                        gPluginManager->RunLua( sCommand );
-                    }
-
-                    else
-                    {
-                        gPluginManager->DelayLua( sCommand, SGetAttr( xmlInput, XML_DELAYFILTER, string( "" ) ) , fDelay, eType );
-                    }
-                }
-
-                else
-                {
-                    if ( eType == PluginManager::eDT_None )
-                    {
-                        gEnv->pConsole->ExecuteString( sCommand );
-                    }
+                gPluginManager->RunLua( sCommand );
+            }
 
-                    else
-                    {
-                        gPluginManager->DelayCommand( sCommand, SGetAttr( xmlInput, XML_DELAYFILTER, string( "" ) ) , fDelay, eType );
-                    }
-                }
+            else
+            {
+                gPluginManager->DelayLua( sCommand, sFilter, command.fDelay, eType );
+            }
+        }
 
-                bRet = true;
+        else
+        {
+            if ( eType == PluginManager::eDT_None )
+            {
+                gEnv->pConsole->ExecuteString( sCommand );
             }
 
             else
             {
-                gPlugin->LogWarning( "Playlist Scene Command empty near XML Line %d", xmlInput->getLine() );
+                gPluginManager->DelayCommand( sCommand, sFilter, command.fDelay, eType );
             }
-
         }
 
-        return bRet;
+        return true;
     }
 
-    bool SScene::init( XmlNodeRef xmlScene, CVideoplayerPlaylist* pPlaylist )
+    bool SScene::init( const SCompiledPlaylist& playlist, const SPlaylistScene& desc, CVideoplayerPlaylist* pPlaylist, bool bOutputs )
     {
         bool bRet = false;
         reset();
 
-        if ( xmlScene != NULL && xmlScene->isTag( XML_SCENE ) )
+        if ( desc.bValid )
         {
-            bSkippable = SGetAttr( xmlScene, XML_SKIPPABLE, true );
-            bLoop = SGetAttr( xmlScene, XML_LOOP, false );
+            bSkippable = desc.bSkippable;
+            bLoop = desc.bLoop;
 
-            int iInputCount = xmlScene->getChildCount();
+            // the inputs own their videos, so they must not be copied by a reallocation
+            vInputs.reserve( desc.nItems );
 
-            for ( int iInput = 0; iInput < iInputCount; ++iInput )
+            for ( unsigned nItem = desc.nFirstItem; nItem < desc.nFirstItem + desc.nItems; ++nItem )
             {
-                XmlNodeRef xmlChild = xmlScene->getChild( iInput );
+                const SPlaylistItem& item = playlist.vItems[nItem];
 
-                if ( IfCondition( xmlChild ) )
+                if ( !IfCondition( playlist.getString( item.nCondition ) ) )
                 {
-                    bRet = SceneCommand( xmlChild );
+                    continue;
+                }
 
-                    if ( !bRet )
-                    {
-                        vInputs.push_back( SSceneInput() );
-                        bRet = vInputs.back().init( xmlChild, pPlaylist );
+                if ( item.eType == SPlaylistItem::PIT_Command )
+                {
+                    bRet = SceneCommand( playlist, playlist.vCommands[item.nIndex] );
+                    continue;
+                }
 
-                        if ( !bRet )
-                        {
-                            gPlugin->LogError( "Playlist Scene XML not valid near XML Line %d", xmlChild ? xmlChild->getLine() : xmlScene->getLine() );
-                            break;
-                        }
-                    }
+                bRet = false;
+
+                if ( item.eType == SPlaylistItem::PIT_Input )
+                {
+                    vInputs.push_back( SSceneInput() );
+                    bRet = vInputs.back().init( playlist, item.nIndex, pPlaylist, bOutputs );
+                }
+
+                if ( !bRet )
+                {
+                    gPlugin->LogError( "Playlist Scene XML not valid near XML Line %d", item.nLine );
+                    break;
                 }
             }
 
-            fDuration = 0; // TODO: duration
+            fDuration = desc.fDuration;
         }
 
         return bRet;
     }
 
+    void SScene::CreateOutputs( const SCompiledPlaylist& playlist )
+    {
+        for ( std::vector<SSceneInput>::iterator iter = vInputs.begin(); iter != vInputs.end(); ++iter )
+        {
+            iter->createOutputs( playlist );
+        }
+    }
+
+    void SScene::Prepare()
+    {
+        for ( std::vector<SSceneInput>::iterator iter = vInputs.begin(); iter != vInputs.end(); ++iter )
+        {
+            if ( iter->input.pVideo )
+            {
+                ( ( CWebMWrapper* )iter->input.pVideo )->Prepare();
+            }
+        }
+    }
+
     void SScene::Skip( bool bForce )
     {
         if ( bForce || bSkippable )
@@ -682,34 +985,51 @@ namespace VideoplayerPlugin
         {
             if ( iter->input.pVideo )
             {
-                bRet &= iter->input.pVideo->Seek( fPos );
+                float fSpeed = iter->input.fSpeed > VIDEO_EPSILON ? iter->input.fSpeed : 1.0f;
+                bRet &= iter->input.pVideo->Seek( iter->input.fStartAt + fPos * fSpeed );
             }
         }
 
         return bRet;
     }
 
-    bool CVideoplayerPlaylist::readNextScene()
+    float SScene::GetPosition()
+    {
+        float fPos = 0;
+
+        for ( std::vector<SSceneInput>::iterator iter = vInputs.begin(); iter != vInputs.end(); ++iter )
+        {
+            if ( iter->input.pVideo && iter->input.fSpeed > VIDEO_EPSILON )
+            {
+                fPos = max( fPos, ( iter->input.pVideo->GetPosition() - iter->input.fStartAt ) / iter->input.fSpeed );
+            }
+        }
+
+        return fPos;
+    }
+
+    bool CVideoplayerPlaylist::readNextScene( bool bOutputs )
     {
         bool bRet = false;
 
-        if ( m_xmlPlaylist != NULL )
+        if ( m_bLoaded )
         {
             m_qVideoEvents.empty(); // clear events videos will be invalid after init
 
             if ( m_iScene < m_iSceneCount )
             {
-                XmlNodeRef xmlScene = m_xmlPlaylist->getChild( m_iScene++ );
+                const SPlaylistScene& scene = m_Compiled.vScenes[m_iScene++];
 
-                if ( IfCondition( xmlScene ) )
+                if ( IfCondition( m_Compiled.getString( scene.nCondition ) ) )
                 {
-                    bRet = m_CurrentScene.init( xmlScene, this );
+                    m_iSceneCurrent = m_iScene - 1;
+                    bRet = m_CurrentScene.init( m_Compiled, scene, this, bOutputs );
                 }
 
                 else
                 {
                     // The condition for this scene is not met, read the next one if present
-                    return readNextScene();
+                    return readNextScene( bOutputs );
                 }
             }
 
@@ -721,6 +1041,7 @@ namespace VideoplayerPlugin
             else
             {
                 m_bSceneStart = true;
+                m_bFadeChecked = false;
 
                 if ( !m_bPaused )
                 {
@@ -733,28 +1054,83 @@ namespace VideoplayerPlugin
     }
 
     bool CVideoplayerPlaylist::Open( const char* sPlaylist, bool bLoop, bool bSkippable, bool bBlockGame, int nStartAtScene, int nEndAtScene )
+    {
+        // a preloaded playlist only needs its outputs
+        if ( IsPreloaded( sPlaylist, bLoop, bSkippable, bBlockGame, nStartAtScene, nEndAtScene ) )
+        {
+            UsePreload();
+            return true;
+        }
+
+        return Load( sPlaylist, bLoop, bSkippable, bBlockGame, nStartAtScene, nEndAtScene, true );
+    }
+
+    bool CVideoplayerPlaylist::Preload( const char* sPlaylist, bool bLoop, bool bSkippable, bool bBlockGame, int nStartAtScene, int nEndAtScene )
+    {
+        if ( IsPreloaded( sPlaylist, bLoop, bSkippable, bBlockGame, nStartAtScene, nEndAtScene ) )
+        {
+            return true;
+        }
+
+        // the outputs are created once the playlist is used, until then it stays invisible
+        if ( !Load( sPlaylist, bLoop, bSkippable, bBlockGame, nStartAtScene, nEndAtScene, false ) )
+        {
+            return false;
+        }
+
+        m_bPreloaded = true;
+        m_nPreloadStart = nStartAtScene;
+        m_nPreloadEnd = nEndAtScene;
+        m_CurrentScene.Prepare();
+
+        gPlugin->LogAlways( "Playlist preloaded file(%s) scene(%d) inputs(%u)", m_sFile.c_str(), m_iSceneCurrent, unsigned( m_CurrentScene.vInputs.size() ) );
+        return true;
+    }
+
+    bool CVideoplayerPlaylist::IsPreloaded( const char* sPlaylist, bool bLoop, bool bSkippable, bool bBlockGame, int nStartAtScene, int nEndAtScene )
+    {
+        return m_bPreloaded && m_sFile == sPlaylist && m_bLoop == bLoop && m_bSkippable == bSkippable && m_bBlockGame == bBlockGame
+               && m_nPreloadStart == nStartAtScene && m_nPreloadEnd == nEndAtScene;
+    }
+
+    void CVideoplayerPlaylist::UsePreload()
+    {
+        m_bPreloaded = false;
+        m_CurrentScene.CreateOutputs( m_Compiled );
+
+#if defined(_DEBUG)
+        gPlugin->LogAlways( "Playlist warm start file(%s) scene(%d)", m_sFile.c_str(), m_iSceneCurrent );
+#endif
+    }
+
+    bool CVideoplayerPlaylist::Load( const char* sPlaylist, bool bLoop, bool bSkippable, bool bBlockGame, int nStartAtScene, int nEndAtScene, bool bOutputs )
     {
         Close();
         m_bLoop = bLoop;
         m_bSkippable = bSkippable;
         m_bBlockGame = bBlockGame;
         m_sFile = sPlaylist;
-        m_xmlPlaylist = gEnv->pSystem->LoadXmlFromFile( sPlaylist );
+        m_bLoaded = LoadCompiledPlaylist( sPlaylist, m_Compiled );
         m_bShowMenuOnEnd = m_bShowMenuOnEndDefault;
 
         m_iScene = 0;
 
-        if ( m_xmlPlaylist != NULL )
+        if ( m_bLoaded )
         {
-            m_iSceneCount = m_xmlPlaylist->getChildCount();
+            m_iSceneCount = m_Compiled.vScenes.size();
 
-            m_bShowMenuOnEnd = SGetAttr( m_xmlPlaylist, XML_ONENDSHOWMENU, m_bShowMenuOnEndDefault );
+            if ( m_Compiled.nShowMenuOnEnd >= 0 )
+            {
+                m_bShowMenuOnEnd = m_Compiled.nShowMenuOnEnd > 0;
+            }
 
             if ( nStartAtScene > 0 )
             {
                 m_iScene = CLAMP( nStartAtScene, 0, m_iSceneCount );
             }
 
+            m_iSceneFirst = m_iScene;
+
             if ( nEndAtScene > 0 )
             {
                 m_iSceneCount = CLAMP( nEndAtScene, m_iScene, m_iSceneCount );
@@ -771,12 +1147,14 @@ namespace VideoplayerPlugin
             }
         }
 
-        return readNextScene();
+        return readNextScene( bOutputs );
     }
 
     void CVideoplayerPlaylist::Close()
     {
-        if ( m_xmlPlaylist )
+        EndCrossfade( false );
+
+        if ( m_bLoaded )
         {
 #if defined(_DEBUG)
             gPlugin->LogAlways( "Playlist OnEnd file(%s) scenes(%d)", m_sFile.c_str(), m_iSceneCount );
@@ -785,6 +1163,10 @@ namespace VideoplayerPlugin
 
         m_iScene = 0;
         m_iSceneCount = 0;
+        m_iSceneFirst = 0;
+        m_iSceneCurrent = -1;
+        m_bFadeChecked = false;
+        m_bPreloaded = false;
         m_bLoop = false;
         m_bSkippable = true;
         m_bBlockGame = false;
@@ -795,25 +1177,180 @@ namespace VideoplayerPlugin
         m_qVideoEvents.empty();
         m_CurrentScene.reset();
 
-        if ( m_xmlPlaylist )
+        if ( m_bLoaded )
         {
-            m_xmlPlaylist = NULL;
+            m_bLoaded = false;
+            m_Compiled.reset();
             OnEndPlaylist();
         }
     }
 
     void CVideoplayerPlaylist::Resume()
     {
+        if ( m_bPreloaded )
+        {
+            UsePreload();
+        }
+
         m_CurrentScene.Resume();
+
+        if ( m_bFadeBlend )
+        {
+            m_FadeScene.Resume();
+        }
+
         m_bPaused = false;
     }
 
     void CVideoplayerPlaylist::Pause()
     {
         m_CurrentScene.Pause();
+        m_FadeScene.Pause();
         m_bPaused = true;
     }
 
+    bool CVideoplayerPlaylist::BeginCrossfade()
+    {
+        const SPlaylistScene& scene = m_Compiled.vScenes[m_iScene];
+
+        if ( !scene.bValid || !IfCondition( m_Compiled.getString( scene.nCondition ) ) )
+        {
+            return false;
+        }
+
+        // the incoming scene is opened now in any case, so a cut doesn't have to wait for it
+        if ( !m_FadeScene.init( m_Compiled, scene, this, false ) )
+        {
+            m_FadeScene.reset();
+            return false;
+        }
+
+        m_iSceneFade = m_iScene;
+        m_fFadeTime = 0;
+        m_fFadeDuration = scene.fCrossfade;
+        m_nFadeOver = 0;
+
+        // blend only if there is room in the budget and the videos fit
+        m_bFadeBlend = gVideoplayerSystem->vp_crossfadebudget > 0
+                       && gVideoplayerSystem->GetLoadTime() < gVideoplayerSystem->vp_crossfadebudget
+                       && BlendScenes( 0 );
+
+        if ( m_bFadeBlend && !m_bPaused )
+        {
+            m_FadeScene.Resume();
+        }
+
+        else
+        {
+            // wait at the start for the outgoing scene to end
+            m_FadeScene.Pause();
+            m_FadeScene.Seek( 0 );
+            BlendScenes( -1 );
+        }
+
+#if defined(_DEBUG)
+        gPlugin->LogAlways( "Playlist crossfade file(%s) scene(%d) duration(%.2fs) mode(%s)", m_sFile.c_str(), m_iSceneFade, m_fFadeDuration, m_bFadeBlend ? "blend" : "cut" );
+#endif
+
+        return true;
+    }
+
+    bool CVideoplayerPlaylist::BlendScenes( float fWeight )
+    {
+        bool bRet = false;
+
+        // inputs are paired in document order, a negative weight stops blending
+        for ( size_t i = 0; i < m_CurrentScene.vInputs.size(); ++i )
+        {
+            CWebMWrapper* pVideo = ( CWebMWrapper* )m_CurrentScene.vInputs[i].input.pVideo;
+            CWebMWrapper* pSource = i < m_FadeScene.vInputs.size() && fWeight >= 0 ? ( CWebMWrapper* )m_FadeScene.vInputs[i].input.pVideo : NULL;
+
+            if ( pVideo )
+            {
+                bRet |= pVideo->Crossfade( pSource, fWeight );
+            }
+        }
+
+        return bRet;
+    }
+
+    void CVideoplayerPlaylist::AdvanceCrossfade( float deltaTime )
+    {
+        if ( !m_bFadeBlend || m_bPaused )
+        {
+            return;
+        }
+
+        m_fFadeTime += deltaTime;
+        float fWeight = m_fFadeDuration > VIDEO_EPSILON ? min( m_fFadeTime / m_fFadeDuration, 1.0f ) : 1.0f;
+
+        vpx_usec_timer tBlend;
+        vpx_usec_timer_start( &tBlend );
+
+        bool bBlending = BlendScenes( fWeight );
+
+        vpx_usec_timer_mark( &tBlend );
+        float fTime = gVideoplayerSystem->GetLoadTime() + float( vpx_usec_timer_elapsed( &tBlend ) ) / MICROSECOND * MILLISECOND;
+
+        // both scenes are decoded meanwhile, if that doesn't fit anymore cut to the incoming one
+        m_nFadeOver = fTime > gVideoplayerSystem->vp_crossfadebudget ? m_nFadeOver + 1 : 0;
+
+        if ( !bBlending || fWeight >= 1.0f || m_nFadeOver >= CROSSFADE_HOLD )
+        {
+#if defined(_DEBUG)
+
+            if ( m_nFadeOver >= CROSSFADE_HOLD )
+            {
+                gPlugin->LogAlways( "Playlist crossfade over budget file(%s) scene(%d) time(%.2fms) budget(%.2fms), cut", m_sFile.c_str(), m_iSceneFade, fTime, gVideoplayerSystem->vp_crossfadebudget );
+            }
+
+#endif
+            OnEndScene( m_iScene );
+        }
+    }
+
+    void CVideoplayerPlaylist::EndCrossfade( bool bComplete )
+    {
+        if ( m_iSceneFade < 0 )
+        {
+            return;
+        }
+
+        BlendScenes( -1 );
+
+        if ( bComplete )
+        {
+            // the incoming scene takes over, the outgoing videos and their outputs are closed
+            m_CurrentScene.reset();
+            m_CurrentScene.vInputs.swap( m_FadeScene.vInputs );
+            m_CurrentScene.bSkippable = m_FadeScene.bSkippable;
+            m_CurrentScene.bLoop = m_FadeScene.bLoop;
+            m_CurrentScene.fDuration = m_FadeScene.fDuration;
+            m_CurrentScene.CreateOutputs( m_Compiled );
+
+            m_iSceneCurrent = m_iSceneFade;
+            m_iScene = m_iSceneFade + 1;
+
+            // events of the closed videos are stale
+            m_qVideoEvents = std::queue<SVideoEvent>();
+        }
+
+        m_FadeScene.reset();
+        m_iSceneFade = -1;
+        m_bFadeBlend = false;
+        m_bFadeChecked = false;
+
+        if ( bComplete )
+        {
+            OnBeginScene( m_iScene );
+
+            if ( !m_bPaused )
+            {
+                m_CurrentScene.Resume();
+            }
+        }
+    }
+
     void CVideoplayerPlaylist::Advance( float deltaTime )
     {
         bool bVideoEnd = false;
@@ -841,10 +1378,33 @@ namespace VideoplayerPlugin
         {
             OnEndScene( m_iScene );
         }
+
+        if ( m_iSceneFade >= 0 )
+        {
+            AdvanceCrossfade( deltaTime );
+        }
+
+        // start the crossfade into the next scene once the remaining time of the current one fits it
+        else if ( m_bLoaded && !m_bFadeChecked && !m_bPaused && m_iScene < m_iSceneCount && !m_CurrentScene.bLoop )
+        {
+            float fCrossfade = m_Compiled.vScenes[m_iScene].fCrossfade;
+
+            if ( fCrossfade > 0 && m_CurrentScene.fDuration > 0 && m_CurrentScene.fDuration - m_CurrentScene.GetPosition() <= fCrossfade )
+            {
+                m_bFadeChecked = true;
+                BeginCrossfade();
+            }
+        }
     }
 
     void CVideoplayerPlaylist::Skip( bool bForce )
     {
+        // not shown yet
+        if ( m_bPreloaded )
+        {
+            return;
+        }
+
         if ( bForce || m_bSkippable )
         {
             m_CurrentScene.Skip( bForce );
@@ -868,18 +1428,67 @@ namespace VideoplayerPlugin
 
     bool CVideoplayerPlaylist::Seek( const int scene, float fPos )
     {
-        if ( m_iScene != scene )
+        if ( !m_bLoaded || scene < 0 || scene >= m_iSceneCount )
         {
-            m_iScene = scene - 1;
-            readNextScene();
+            return false;
         }
 
-        return Seek( fPos );
+        EndCrossfade( false );
+
+        // only the target scene is opened
+        if ( m_iSceneCurrent != scene )
+        {
+            m_iScene = scene;
+
+            if ( !readNextScene() )
+            {
+                return false;
+            }
+
+            // the condition of the scene wasn't met, a later one was opened
+            if ( m_iSceneCurrent != scene )
+            {
+                return true;
+            }
+        }
+
+        return m_CurrentScene.Seek( fPos );
     }
 
     bool CVideoplayerPlaylist::Seek( float fPos )
     {
-        return m_CurrentScene.Seek( fPos );
+        if ( !m_bLoaded )
+        {
+            return false;
+        }
+
+        int iScene = m_Compiled.findScene( fPos, m_iSceneFirst, m_iSceneCount );
+        return Seek( iScene, fPos - m_Compiled.vTimeline[iScene] );
+    }
+
+    float CVideoplayerPlaylist::GetStart()
+    {
+        return m_bLoaded ? m_Compiled.vTimeline[m_iSceneFirst] : 0;
+    }
+
+    float CVideoplayerPlaylist::GetPosition()
+    {
+        if ( !m_bLoaded || m_iSceneCurrent < 0 )
+        {
+            return -1;
+        }
+
+        return m_Compiled.vTimeline[m_iSceneCurrent] + min( m_CurrentScene.GetPosition(), m_CurrentScene.fDuration );
+    }
+
+    float CVideoplayerPlaylist::GetDuration()
+    {
+        return m_bLoaded ? m_Compiled.vTimeline.back() : -1;
+    }
+
+    float CVideoplayerPlaylist::GetEnd()
+    {
+        return m_bLoaded ? m_Compiled.vTimeline[m_iSceneCount] : -1;
     }
 
     int CVideoplayerPlaylist::GetSceneCount()
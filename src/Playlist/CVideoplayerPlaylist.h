@@ -8,6 +8,146 @@
 
 namespace VideoplayerPlugin
 {
+    /**
+    * @brief 2D output of a compiled playlist input
+    */
+    struct SPlaylistOutput
+    {
+        bool bSoundsource;
+        eResizeMode nResizeMode;
+        float fCustomAR;
+        float fRelTop;
+        float fRelLeft;
+        float fRelWidth;
+        float fRelHeight;
+        float fAngle;
+        ColorF cRGBA;
+        ColorF cBG_RGBA;
+        eZPos nZPos;
+    };
+
+    /**
+    * @brief Video input of a compiled playlist
+    */
+    struct SPlaylistInput
+    {
+        unsigned nClass; //!< interned string
+        unsigned nVideo; //!< interned string
+        unsigned nSound; //!< interned string
+
+        float fStartAt;
+        float fEndAfter;
+        float fSpeed;
+
+        eTimeSource eTS;
+        eDropMode eDM;
+        eVisibilityPolicy eVP;
+        eVideoPriority ePriority;
+
+        bool bLoop;
+        bool bBlockGame;
+        bool bSkippable;
+
+        int nCustomWidth;
+        int nCustomHeight;
+
+        unsigned nFirstOutput; //!< first output in SCompiledPlaylist::vOutputs
+        unsigned nOutputs; //!< number of outputs
+
+        float fDuration; //!< seconds on the playlist timeline (one pass of looping videos, -1 unknown)
+    };
+
+    /**
+    * @brief Console or Lua command of a compiled playlist
+    */
+    struct SPlaylistCommand
+    {
+        bool bLua; //!< Lua instead of a console command
+        unsigned nCommand; //!< interned string
+        unsigned nFilter; //!< interned delay filter
+        float fDelay; //!< delay in frames or seconds
+        int nDelayType; //!< PluginManager::eDelayType
+    };
+
+    /**
+    * @brief Child of a compiled scene in document order
+    */
+    struct SPlaylistItem
+    {
+        enum eItemType
+        {
+            PIT_Input, //!< nIndex into SCompiledPlaylist::vInputs
+            PIT_Command, //!< nIndex into SCompiledPlaylist::vCommands
+            PIT_Invalid, //!< reported when the scene is played
+        };
+
+        eItemType eType;
+        unsigned nCondition; //!< interned Lua condition (0 none)
+        unsigned nIndex;
+        int nLine; //!< XML line for error messages
+    };
+
+    /**
+    * @brief Scene of a compiled playlist
+    */
+    struct SPlaylistScene
+    {
+        bool bValid; //!< was a scene tag
+        unsigned nCondition; //!< interned Lua condition (0 none)
+        bool bSkippable;
+        bool bLoop;
+        unsigned nFirstItem; //!< first child in SCompiledPlaylist::vItems
+        unsigned nItems; //!< number of children
+        int nLine; //!< XML line for error messages
+        float fDuration; //!< longest input, 0 if unknown
+        float fCrossfade; //!< seconds the scene fades in over the previous one (0 cut)
+    };
+
+    /**
+    * @brief Playlist parsed once into flat descriptors, so scene changes don't access the XML
+    * Strings are interned, descriptors refer to them by index (0 is the empty string).
+    */
+    struct SCompiledPlaylist
+    {
+        std::vector<string> vStrings;
+        std::vector<SPlaylistScene> vScenes;
+        std::vector<SPlaylistItem> vItems;
+        std::vector<SPlaylistInput> vInputs;
+        std::vector<SPlaylistOutput> vOutputs;
+        std::vector<SPlaylistCommand> vCommands;
+        std::vector<float> vTimeline; //!< start of each scene on the playlist timeline, the last entry is the total duration
+
+        int nShowMenuOnEnd; //!< onendshowmenu attribute (-1 not set)
+        uint64 nModified; //!< modification time of the file it was compiled from
+        size_t nSize; //!< size of the file it was compiled from
+
+        SCompiledPlaylist()
+        {
+            reset();
+        }
+
+        void reset();
+
+        /**
+        * @brief Parse a playlist
+        * @param xmlPlaylist root node
+        */
+        void compile( XmlNodeRef xmlPlaylist );
+
+        const char* getString( unsigned nString ) const
+        {
+            return vStrings[nString].c_str();
+        }
+
+        /**
+        * @brief Find the scene containing a position of the timeline (binary search)
+        * @param fPos position in seconds
+        * @param nFirst first scene to consider
+        * @param nEnd scene after the last one to consider
+        * @return scene index, clamped to the range
+        */
+        int findScene( float fPos, int nFirst, int nEnd ) const;
+    };
 
     class CVideoplayerPlaylist;
     struct SVideoInput :
@@ -16,7 +156,7 @@ namespace VideoplayerPlugin
         SVideoInput();
         ~SVideoInput();
 
-        bool init( XmlNodeRef xmlScene, CVideoplayerPlaylist* pPlaylist );
+        bool init( const SCompiledPlaylist& playlist, const SPlaylistInput& desc, CVideoplayerPlaylist* pPlaylist );
         void reset();
 
         string sClass;
@@ -29,6 +169,8 @@ namespace VideoplayerPlugin
 
         eTimeSource eTS;
         eDropMode eDM;
+        eVisibilityPolicy eVP;
+        eVideoPriority ePriority;
 
         bool bLoop;
         bool bBlockGame;
@@ -51,9 +193,15 @@ namespace VideoplayerPlugin
     {
         ~SSceneInput();
 
-        bool init( XmlNodeRef xmlScene, CVideoplayerPlaylist* pPlaylist );
+        /**
+        * @param nInput input in SCompiledPlaylist::vInputs
+        * @param bOutputs create the 2D outputs (else createOutputs has to be called)
+        */
+        bool init( const SCompiledPlaylist& playlist, unsigned nInput, CVideoplayerPlaylist* pPlaylist, bool bOutputs = true );
+        void createOutputs( const SCompiledPlaylist& playlist );
         void reset();
 
+        unsigned nInput;
         SVideoInput input;
 
         std::vector<S2DVideo*> v2DOutputs;
@@ -67,16 +215,35 @@ namespace VideoplayerPlugin
         float fDuration;
         std::vector<SSceneInput> vInputs;
 
-        bool init( XmlNodeRef xmlScene, CVideoplayerPlaylist* pPlaylist );
+        /**
+        * @param bOutputs create the 2D outputs (incoming scenes of crossfades are shown through the outgoing ones)
+        */
+        bool init( const SCompiledPlaylist& playlist, const SPlaylistScene& desc, CVideoplayerPlaylist* pPlaylist, bool bOutputs = true );
+        void CreateOutputs( const SCompiledPlaylist& playlist );
         void reset();
 
+        /**
+        * @brief Decode the first frame of the paused inputs ahead
+        */
+        void Prepare();
+
         void Skip( bool bForce = false );
         bool IsPlaying();
         bool IsActive();
 
         void Resume();
         void Pause();
+
+        /**
+        * @brief Seek all inputs
+        * @param fPos position in seconds relative to the start of the scene
+        */
         bool Seek( float fPos );
+
+        /**
+        * @brief Position relative to the start of the scene (furthest input)
+        */
+        float GetPosition();
     };
 
     struct SVideoEvent
@@ -102,10 +269,35 @@ namespace VideoplayerPlugin
         public IVideoplayerPlaylist
     {
         private:
-            XmlNodeRef  m_xmlPlaylist; // XML Nodes
+            SCompiledPlaylist m_Compiled; // Scenes
+            bool        m_bLoaded;
             int         m_iScene;
             int         m_iSceneCount;
-            bool        readNextScene();
+            int         m_iSceneFirst; // first scene of the played range
+            int         m_iSceneCurrent; // scene of m_CurrentScene, -1 none
+
+            // crossfade
+            SScene      m_FadeScene; // incoming scene
+            int         m_iSceneFade; // scene of m_FadeScene, -1 none
+            bool        m_bFadeChecked; // crossfade into the next scene was considered
+            bool        m_bFadeBlend; // blending, else the incoming scene waits at its start for a cut
+            float       m_fFadeTime; // seconds blended
+            float       m_fFadeDuration; // seconds to blend
+            unsigned    m_nFadeOver; // frames over vp_crossfadebudget
+            bool        BeginCrossfade();
+            void        AdvanceCrossfade( float deltaTime );
+            bool        BlendScenes( float fWeight );
+            void        EndCrossfade( bool bComplete );
+
+            // warm start
+            bool        m_bPreloaded; // opened by Preload, the outputs are created once it is used
+            int         m_nPreloadStart; // scene range passed to Preload
+            int         m_nPreloadEnd;
+            bool        IsPreloaded( const char* sPlaylist, bool bLoop, bool bSkippable, bool bBlockGame, int nStartAtScene, int nEndAtScene );
+            void        UsePreload();
+            bool        Load( const char* sPlaylist, bool bLoop, bool bSkippable, bool bBlockGame, int nStartAtScene, int nEndAtScene, bool bOutputs );
+
+            bool        readNextScene( bool bOutputs = true );
             SScene      m_CurrentScene;
             std::vector<IVideoplayerPlaylistEventListener*>     vecQueue;
 
@@ -135,6 +327,22 @@ namespace VideoplayerPlugin
 
             virtual bool Open( const char* sPlaylist, bool bLoop = false, bool bSkippable = true, bool bBlockGame = false, int nStartAtScene = -1, int nEndAtScene = -1 );
             virtual void Close();
+
+            /**
+            * @brief Open paused without outputs and decode the first frame of the first scene ahead
+            * A following Open with the same parameters (or Resume) only adds the outputs, so the playlist is shown without a stall.
+            * @see Open
+            * @return success
+            */
+            bool Preload( const char* sPlaylist, bool bLoop = false, bool bSkippable = true, bool bBlockGame = false, int nStartAtScene = -1, int nEndAtScene = -1 );
+
+            /**
+            * @brief Compiled form of a playlist file, taken from the playlist cache if the file didn't change
+            * @param sPlaylist playlist file
+            * @param[out] compiled compiled playlist
+            * @return the file could be loaded
+            */
+            static bool Compile( const char* sPlaylist, SCompiledPlaylist& compiled );
             virtual void Advance( float deltaTime );
 
             virtual bool Seek( const int scene, float fPos );
@@ -146,22 +354,10 @@ namespace VideoplayerPlugin
             virtual void RegisterListener( IVideoplayerPlaylistEventListener* item );
             virtual void UnregisterListener( IVideoplayerPlaylistEventListener* item );
 
-            virtual float GetStart()
-            {
-                return 0;
-            };
-            virtual float GetPosition()
-            {
-                return 0;
-            };
-            virtual float GetDuration()
-            {
-                return 0;
-            };
-            virtual float GetEnd()
-            {
-                return 0;
-            };
+            virtual float GetStart();
+            virtual float GetPosition();
+            virtual float GetDuration();
+            virtual float GetEnd();
 
             virtual void SetSpeed( float fSpeed = 1.0f )
             {
@@ -1,345 +1,277 @@
 /* Videoplayer_Plugin - for licensing and copyright see license.txt */
 
+#if !defined(VP_STANDALONE)
 #include <StdAfx.h>
 #include <CPluginVideoplayer.h>
 #include <Renderer/CVideoRenderer.h>
 #include <windows.h>
 
-#define USE_SSE2 // use fast software conversion if available
-
 namespace VideoplayerPlugin
 {
-    unsigned char* copyPlane( unsigned int cols, unsigned int lines, unsigned char* dst, unsigned int dstStride, unsigned char* src, unsigned int srcStride )
+    void YV12_2_TEX( unsigned char* y, unsigned char* u, unsigned char* v, unsigned char* a, unsigned int cols, unsigned int lines, uint32_t* dst, unsigned int dstStride, unsigned int srcStrideY, unsigned int srcStrideU, unsigned int srcStrideV, unsigned int srcStrideA, SAlphaGenParam& ap )
     {
-        if ( srcStride == dstStride )
-        {
-            // source and destination paddings equal
-            memcpy( dst, src, srcStride * lines );
-            dst += srcStride * lines;
-        }
-
-        else
-        {
-            // source and destination paddings need to be converted
-            ++lines;
+        // without an engine renderer (headless) use the DX9 byte order
+        YV12_2_RGB( gEnv->pRenderer && gEnv->pRenderer->GetRenderType() == eRT_DX11 ? VBO_RGBA : VBO_BGRA, y, u, v, a, cols, lines, dst, dstStride, srcStrideY, srcStrideU, srcStrideV, srcStrideA, ap );
+    }
+}
 
-            while ( --lines )
-            {
-                memcpy( dst, src, cols );
-                src += srcStride;
-                dst += dstStride;
-            }
-        }
+#include <Renderer/CVideoRendererDX9.h>
+#include <Renderer/CVideoRendererDX11.h>
+#include <Renderer/CVideoRendererCE3.h>
+#include <Renderer/CVideoRendererNull.h>
 
-        return dst;
-    }
+#include <CVideoplayerSystem.h>
 
-    // create conditional parameter that resolves at compile time
-#define PARAMS uint32_t* dst, unsigned char r, unsigned char g, unsigned char b, unsigned char a, SAlphaGenParam& ap
-    template<eByteOrder COLOR_DST_FMT, eAlphaMode ALPHAMODE>
-    inline void write_pixel( PARAMS )
-    {};
+#include <concrt.h>
+#else
+#include <Renderer/CVideoRenderer.h>
 
-    template<> inline void write_pixel<VBO_RGBA, VAM_PASSTROUGH>( PARAMS )
-    {
-        *dst = ( ( ( a ) << 24 ) | ( ( b ) << 16 ) | ( ( g ) << 8 ) | ( r ) ); // RGBA (little endian)
-    }
+namespace VideoplayerPlugin
+{
+    eByteOrder eStandaloneByteOrder = VBO_BGRA;
 
-    template<> inline void write_pixel<VBO_BGRA, VAM_PASSTROUGH>( PARAMS )
+    void YV12_2_TEX( unsigned char* y, unsigned char* u, unsigned char* v, unsigned char* a, unsigned int cols, unsigned int lines, uint32_t* dst, unsigned int dstStride, unsigned int srcStrideY, unsigned int srcStrideU, unsigned int srcStrideV, unsigned int srcStrideA, SAlphaGenParam& ap )
     {
-        write_pixel<VBO_RGBA, VAM_PASSTROUGH>( dst, b, g, r, a, ap );
+        YV12_2_RGB( eStandaloneByteOrder, y, u, v, a, cols, lines, dst, dstStride, srcStrideY, srcStrideU, srcStrideV, srcStrideA, ap );
     }
+}
 
-    template<> inline void write_pixel<VBO_RGBA, VAM_FILL>( PARAMS )
-    {
-        *dst = ( 0xff000000 | ( ( b ) << 16 ) | ( ( g ) << 8 ) | ( r ) ); // RGBX (little endian)
-    }
+#if !defined(CLAMP)
+#define CLAMP(x, lo, hi) ( ( x ) < ( lo ) ? ( lo ) : ( ( x ) > ( hi ) ? ( hi ) : ( x ) ) )
+#endif
+#endif
 
-    template<> inline void write_pixel<VBO_BGRA, VAM_FILL>( PARAMS )
-    {
-        write_pixel<VBO_RGBA, VAM_FILL>( dst, b, g, r, a, ap );
-    }
+#include <vpx_ports/vpx_timer.h>
+#include <WebM/vpxdec_trace.h>
 
-    template<> inline void write_pixel<VBO_RGBA, VAM_FALLOF>( PARAMS )
+namespace VideoplayerPlugin
+{
+    void CVideoRenderer::Release()
     {
-        if ( a <= ap.tolerance )
-        {
-            a = 0;
-        }
-
-        else if ( a >= ap.fallof )
+        if ( --m_nReferences < 0 )
         {
-            a = 255;
+            m_nReferences = 0;
         }
 
-        else
+        if ( !m_nReferences )
         {
-            a = a * ap.mull;
-        }
+            SetBlendSource( NULL, 0 );
+            m_bDirty = false; // don't upload stale data while unused
 
-        write_pixel<VBO_RGBA, VAM_PASSTROUGH>( dst, r, g, b, a, ap );
-    }
+#if defined(VP_STANDALONE)
+            Cleanup(); // no render thread can still see it
+#else
 
-    template<> inline void write_pixel<VBO_BGRA, VAM_FALLOF>( PARAMS )
-    {
-        write_pixel<VBO_RGBA, VAM_FALLOF>( dst, b, g, r, a, ap );
-    }
+            if ( !poolVideoRenderer( this ) )
+            {
+                markVideoResourceForCleanup( this );
+            }
 
-    template<> inline void write_pixel<VBO_RGBA, VAM_COLORMASK>( PARAMS )
-    {
-        ap.temp2 = abs( ap.r - r );
-        ap.temp = ap.temp2 * ap.temp2 * ap.wr;
-        ap.temp2 = abs( ap.g - g );
-        ap.temp += ap.temp2 * ap.temp2 * ap.wg;
-        ap.temp2 = abs( ap.b - b );
-        ap.temp += ap.temp2 * ap.temp2 * ap.wb;
-        ap.temp /= ap.ws;
-
-        //ap.temp = (abs(ap.r - r) * ap.wr + abs(ap.g - g) * ap.wg + abs(ap.b - b) * ap.wb) / ap.ws;
-
-        a = ap.temp;
-        write_pixel<VBO_RGBA, VAM_FALLOF>( dst, r, g, b, a, ap );
-    }
+#endif
+        }
+    };
 
-    template<> inline void write_pixel<VBO_BGRA, VAM_COLORMASK>( PARAMS )
+    void CVideoRenderer::ReleaseResources()
     {
-        write_pixel<VBO_RGBA, VAM_FALLOF>( dst, b, g, r, a, ap );
-    }
-
-#define SAT(x) CLAMP(x, 0, 255) // Saturate
+        SetBlendSource( NULL, 0 );
 
-    template<eByteOrder COLOR_DST_FMT, eAlphaMode ALPHAMODE>
-    void YV12_2_( unsigned char* y, unsigned char* u, unsigned char* v, unsigned char* a, unsigned int cols, unsigned int lines, uint32_t* dst, unsigned int dstStride, unsigned int srcStrideY, unsigned int srcStrideU, unsigned int srcStrideV, unsigned int srcStrideA, SAlphaGenParam& ap )
-    {
-#ifdef USE_SSE2
+#if !defined(VP_STANDALONE)
+        // cached shader items of material overrides hold a reference of the texture
+        ITexture* pTexture = reinterpret_cast<ITexture*>( GetRenderTarget( VRT_CE3 ) );
 
-        if ( ::IsProcessorFeaturePresent( PF_XMMI64_INSTRUCTIONS_AVAILABLE ) )
+        if ( pTexture && gVideoplayerSystem )
         {
-            //SSE2 available
-            SSE2_YUV420_2_<COLOR_DST_FMT, ALPHAMODE>( y, u, v, a, srcStrideY, srcStrideV, srcStrideA, cols, lines, dst, dstStride, ap );
-            return;
+            gVideoplayerSystem->ReleaseShaderItems( pTexture );
         }
 
-        //else slow fall back
 #endif
 
-        int Y;
-
-        int CY;
-        signed char CU;
-        signed char CV;
-
-        float fCY;
-        float fCV;
-        float fCUV;
-        float fCU;
-
-        float R;
-        float G;
-        float B;
-
-        unsigned int lcols;
-        uint32_t* ldst;
-        unsigned char* ly;
-        unsigned char* la;
-
-        uint32_t* ldst2;
-        unsigned char* ly2;
-        unsigned char* la2;
-
-        signed char* lu;
-        signed char* lv;
-
-        if ( !a )
+        if ( m_pData )
         {
-            // if alpha not available use luminance so I don't need another function
-            a = y;
-            srcStrideA = srcStrideY;
+#if defined(USE_ALIGNEDMEMORY)
+#if defined(_WIN32)
+            _aligned_free( m_pData );
+#else
+            free( m_pData );
+#endif
+#else
+            delete [] m_pData;
+#endif
+            m_pData = NULL;
         }
 
-        unsigned int srcStrideA2 = srcStrideA << 1;
-        unsigned int srcStrideY2 = srcStrideY << 1;
-        unsigned int dstStride2 = dstStride << 1;
+        m_bDirty = false;
+    };
 
-        cols >>= 1;
-        lines >>= 1;
+    void CVideoRenderer::Cleanup()
+    {
+        if ( !m_nReferences )
+        {
+            ReleaseResources();
+            delete this;
+        }
 
-        ++lines;
+#if !defined(VP_STANDALONE)
 
-        while ( --lines )
+        else
         {
-            ldst = dst;
-            ly = y;
-            la = a;
+            gPlugin->LogWarning( "Cleanup called but references still exist." );
+        }
 
-            ldst2 = dst + dstStride;
-            ly2 = y   + srcStrideY;
-            la2 = a   + srcStrideA;
+#endif
+    };
 
-            lu = ( signed char* )u;
-            lv = ( signed char* )v;
+    bool CVideoRenderer::SetBlendSource( IVideoRenderer* pSource, float fWeight )
+    {
+        CVideoRenderer* pRenderer = static_cast<CVideoRenderer*>( pSource );
 
-            lcols = cols + 1;
+        // only frames of the same size can be blended
+        if ( pRenderer && ( pRenderer == this || !m_pData || !pRenderer->m_pData || pRenderer->m_nSize != m_nSize
+                            || pRenderer->m_nSourceWidth != m_nSourceWidth || pRenderer->m_nSourceHeight != m_nSourceHeight ) )
+        {
+            pRenderer = NULL;
+        }
 
-            while ( --lcols )
+        if ( pRenderer != m_pBlendSource )
+        {
+            if ( m_pBlendSource )
             {
-                // process 4 pixels each time
-
-                // the UV values are valid for 4 pixel
-                CU = ( *lu ) - 128;
-                ++lu;
-                CV = ( *lv ) - 128;
-                ++lv;
-
-                fCV = 1.596f * CV;
-                fCUV = -0.391f * CU - 0.813f * CV;
-                fCU = 2.018f * CU;
-
-                // first line first col
-                Y = *ly;
-                ++ly;
-                CY = Y - 16;
-                fCY = 1.164f * CY;
-
-                R = fCY + fCV + 0.5f;
-                G = fCY + fCUV + 0.5f;
-                B = fCY + fCU + 0.5f;
-
-                write_pixel<COLOR_DST_FMT, ALPHAMODE>( ldst, SAT( R ), SAT( G ), SAT( B ), *la++, ap );
-                ++ldst;
-
-                // first line second col
-                Y = *ly;
-                ++ly;
-                CY = Y - 16;
-                fCY = 1.164f * CY;
-
-                R = fCY + fCV + 0.5f;
-                G = fCY + fCUV + 0.5f;
-                B = fCY + fCU + 0.5f;
-
-                write_pixel<COLOR_DST_FMT, ALPHAMODE>( ldst, SAT( R ), SAT( G ), SAT( B ), *la++, ap );
-                ++ldst;
-
-                // second line first col
-                Y = *ly2;
-                ++ly2;
-                CY = Y - 16;
-                fCY = 1.164f * CY;
-
-                R = fCY + fCV + 0.5f;
-                G = fCY + fCUV + 0.5f;
-                B = fCY + fCU + 0.5f;
-
-                write_pixel<COLOR_DST_FMT, ALPHAMODE>( ldst2,  SAT( R ), SAT( G ), SAT( B ), *la2++, ap );
-                ++ldst2;
-
-                // second line second col
-                Y = *ly2;
-                ++ly2;
-                CY = Y - 16;
-                fCY = 1.164f * CY;
-
-                R = fCY + fCV + 0.5f;
-                G = fCY + fCUV + 0.5f;
-                B = fCY + fCU + 0.5f;
-
-                write_pixel<COLOR_DST_FMT, ALPHAMODE>( ldst2, SAT( R ), SAT( G ), SAT( B ), *la2++, ap );
-                ++ldst2;
+                --m_pBlendSource->m_nBlendTargets;
+                m_pBlendSource->Release();
+                m_pBlendSource = NULL;
             }
 
-            y += srcStrideY2;
-            a += srcStrideA2;
+            if ( pRenderer && !m_pBlendData )
+            {
+#if defined(USE_ALIGNEDMEMORY)
+#if defined(_WIN32)
+                m_pBlendData = ( unsigned char* )_aligned_malloc( m_nSize, ALIGNEDMEMORY );
+#else
+                m_pBlendData = ( unsigned char* )memalign( ALIGNEDMEMORY, m_nSize );
+#endif
+#else
+                m_pBlendData = new unsigned char[m_nSize];
+#endif
 
-            dst += dstStride2;
-            u += srcStrideU;
-            v += srcStrideV;
-        }
-    }
+                if ( !m_pBlendData )
+                {
+                    return false;
+                }
 
-    void YV12_2_TEX( unsigned char* y, unsigned char* u, unsigned char* v, unsigned char* a, unsigned int cols, unsigned int lines, uint32_t* dst, unsigned int dstStride, unsigned int srcStrideY, unsigned int srcStrideU, unsigned int srcStrideV, unsigned int srcStrideA, SAlphaGenParam& ap )
-    {
-        if ( gEnv->pRenderer->GetRenderType() == eRT_DX11 )
-        {
-            if ( a )
+                // the last own frame is the start of the blend
+                memcpy( m_pBlendData, m_pData, m_nSize );
+            }
+
+            else if ( !pRenderer && m_pBlendData )
             {
-                YV12_2_<VBO_RGBA, VAM_PASSTROUGH>( y, u, v, a, cols, lines, dst, dstStride, srcStrideY, srcStrideU, srcStrideV, srcStrideA, ap );
+                // present the own frame again
+                if ( m_pData )
+                {
+                    memcpy( m_pData, m_pBlendData, m_nSize );
+                    m_bDirty = true;
+                }
+
+#if defined(USE_ALIGNEDMEMORY)
+#if defined(_WIN32)
+                _aligned_free( m_pBlendData );
+#else
+                free( m_pBlendData );
+#endif
+#else
+                delete [] m_pBlendData;
+#endif
+                m_pBlendData = NULL;
             }
 
-            else
+            if ( pRenderer )
             {
-                YV12_2_<VBO_RGBA, VAM_FILL>( y, u, v, a, cols, lines, dst, dstStride, srcStrideY, srcStrideU, srcStrideV, srcStrideA, ap );
+                pRenderer->AddRef();
+                ++pRenderer->m_nBlendTargets;
+                m_pBlendSource = pRenderer;
             }
         }
 
-        else
+        if ( m_pBlendSource )
         {
-            if ( a )
-            {
-                YV12_2_<VBO_BGRA, VAM_PASSTROUGH>( y, u, v, a, cols, lines, dst, dstStride, srcStrideY, srcStrideU, srcStrideV, srcStrideA, ap );
-            }
+            VPXDEC_TRACE( "BlendFrame", m_nTraceTag );
 
-            else
-            {
-                YV12_2_<VBO_BGRA, VAM_FILL>( y, u, v, a, cols, lines, dst, dstStride, srcStrideY, srcStrideU, srcStrideV, srcStrideA, ap );
-            }
+            unsigned nWeight = unsigned( CLAMP( fWeight, 0.0f, 1.0f ) * 256.0f + 0.5f );
+            blendRGB( ( uint32_t* )m_pData, ( uint32_t* )m_pBlendData, ( uint32_t* )m_pBlendSource->m_pData, m_nSize >> 2, nWeight );
+            m_bDirty = true;
         }
+
+        return m_pBlendSource != NULL;
     }
 }
 
-#include <Renderer/CVideoRendererDX9.h>
-#include <Renderer/CVideoRendererDX11.h>
-#include <Renderer/CVideoRendererCE3.h>
+#if !defined(VP_STANDALONE)
+namespace VideoplayerPlugin
+{
+    CVideoRenderer* volatile pVideoRenderers[VRT_MAX] = {NULL}; //!< registered renderers per type (intrusive lists)
+    CVideoRenderer* volatile pVideoRenderersRetired = NULL; //!< renderers marked for cleanup but still registered
+    CVideoRenderer* pVideoRenderersLimbo = NULL; //!< unregistered renderers that updates might still see
 
-#include <CVideoplayerSystem.h>
+    volatile LONG nVideoRendererEpoch = 1; //!< incremented each time renderers are unregistered
+    volatile LONG nVideoRendererReaders[VIDEORENDERER_READERS] = {0}; //!< epoch of each running update (0 = idle)
 
-#include <queue>
-#include <map>
-#include <concrt.h>
+    Concurrency::critical_section csVideoResourcesCleanup; //!< only serializes cleanups, updates never take it
 
-namespace VideoplayerPlugin
-{
-    void CVideoRenderer::Release()
+    void registerVideoRenderer( CVideoRenderer* pRenderer )
     {
-        if ( --m_nReferences < 0 )
-        {
-            m_nReferences = 0;
-        }
+        CVideoRenderer* volatile* pHead = &pVideoRenderers[pRenderer->GetRendererType()];
+        CVideoRenderer* pFirst;
 
-        if ( !m_nReferences )
+        // push front, the new node isn't visible before the exchange succeeds
+        do
         {
-            markVideoResourceForCleanup( this );
+            pFirst = *pHead;
+            pRenderer->m_pNextRenderer = pFirst;
         }
-    };
+        while ( InterlockedCompareExchangePointer( ( PVOID volatile* )pHead, pRenderer, pFirst ) != pFirst );
+    }
 
-    void CVideoRenderer::Cleanup()
+    void unregisterVideoRenderer( CVideoRenderer* pRenderer )
     {
-        if ( !m_nReferences )
+        CVideoRenderer* volatile* pHead = &pVideoRenderers[pRenderer->GetRendererType()];
+
+        // still the first one? then only registrations can interfere
+        if ( InterlockedCompareExchangePointer( ( PVOID volatile* )pHead, pRenderer->m_pNextRenderer, pRenderer ) == pRenderer )
         {
-            ReleaseResources();
-            delete this;
+            return;
         }
 
-        else
+        // behind the first node only the cleanup modifies links
+        for ( CVideoRenderer* pPrev = *pHead; pPrev; pPrev = pPrev->m_pNextRenderer )
         {
-            gPlugin->LogWarning( "Cleanup called but references still exist." );
+            if ( pPrev->m_pNextRenderer == pRenderer )
+            {
+                InterlockedExchangePointer( ( PVOID volatile* )&pPrev->m_pNextRenderer, pRenderer->m_pNextRenderer );
+                return;
+            }
         }
-    };
+    }
 
-    std::queue<IVideoResource*> qVideoResourcesCleanup;
+    bool isVideoRendererReachable( LONG nRetireEpoch )
+    {
+        // updates that started before the renderer was unregistered could still be using it
+        for ( int i = 0; i < VIDEORENDERER_READERS; ++i )
+        {
+            LONG nReader = nVideoRendererReaders[i];
 
-    typedef std::map<IVideoRenderer*, IVideoRenderer*> tVideoRendererMap;
-    tVideoRendererMap mVideoRendererUpdate;
+            if ( nReader != 0 && nReader <= nRetireEpoch )
+            {
+                return true;
+            }
+        }
 
-    Concurrency::critical_section csVideoResources;
+        return false;
+    }
 
     IVideoRenderer* createVideoRenderer( eRendererType eType )
     {
-        Concurrency::critical_section::scoped_lock lock( csVideoResources );
-
-        IVideoRenderer* pRet = NULL;
+        CVideoRenderer* pRet = NULL;
 
-        if ( !gD3DSystem )
+        if ( !gD3DSystem && eType != VRT_NULL )
         {
             eType = VRT_CE3;
         }
@@ -368,63 +300,348 @@ namespace VideoplayerPlugin
             case VRT_DX11:
                 pRet =  gD3DSystem->GetType() == D3DPlugin::D3D_DX11 ? new CVideoRendererDX11() : NULL;
                 goto finished;
+
+            case VRT_NULL:
+                pRet = new CVideoRendererNull();
+                goto finished;
         }
 
 finished:
 
         if ( pRet )
         {
-            mVideoRendererUpdate[pRet] = pRet;
+            registerVideoRenderer( pRet );
         }
 
         return pRet;
     };
 
-    void markVideoResourceForCleanup( IVideoResource* res )
+    typedef std::vector<CVideoRenderer*> tVideoRendererPool;
+    tVideoRendererPool vVideoRendererPool; //!< unreferenced renderers with their resources still created (oldest first)
+    Concurrency::critical_section csVideoRendererPool; //!< pool is used by main and render thread (device reset)
+
+    unsigned nVideoRendererPoolHits = 0; //!< renderers reused
+    unsigned nVideoRendererPoolMisses = 0; //!< renderers created
+    float fVideoRendererCreateTime = 0; //!< average creation time in seconds
+
+    IVideoRenderer* acquireVideoRenderer( eRendererType eType, unsigned nSourceWidth, unsigned nSourceHeight, unsigned nTargetWidth, unsigned nTargetHeight, bool& bReused )
+    {
+        bReused = false;
+
+        // resolve the type so it can be matched against the pool
+        if ( eType == VRT_AUTO && ( !gEnv->pRenderer || ( gVideoplayerSystem && gVideoplayerSystem->vp_nullrenderer ) ) )
+        {
+            eType = VRT_NULL;
+        }
+
+        else if ( !gD3DSystem && eType != VRT_NULL )
+        {
+            eType = VRT_CE3;
+        }
+
+        else if ( eType == VRT_AUTO )
+        {
+            eType = gD3DSystem->GetType() == D3DPlugin::D3D_DX9 ? VRT_DX9 : VRT_CE3;
+        }
+
+        {
+            Concurrency::critical_section::scoped_lock lock( csVideoRendererPool );
+
+            // prefer the most recently pooled one, its resources are the least likely to be paged out
+            for ( tVideoRendererPool::reverse_iterator iter = vVideoRendererPool.rbegin(); iter != vVideoRendererPool.rend(); ++iter )
+            {
+                CVideoRenderer* pRenderer = *iter;
+
+                if ( pRenderer->GetRendererType() == eType && pRenderer->MatchesResources( nSourceWidth, nSourceHeight, nTargetWidth, nTargetHeight ) )
+                {
+                    vVideoRendererPool.erase( --iter.base() );
+                    pRenderer->Reuse();
+
+                    ++nVideoRendererPoolHits;
+                    bReused = true;
+                    return pRenderer;
+                }
+            }
+        }
+
+        vpx_usec_timer tCreate;
+        vpx_usec_timer_start( &tCreate );
+
+        IVideoRenderer* pRet = createVideoRenderer( eType );
+
+        if ( pRet )
+        {
+            if ( pRet->CreateResources( nSourceWidth, nSourceHeight, nTargetWidth, nTargetHeight ) )
+            {
+                // only renderers with working resources may be reused
+                ( ( CVideoRenderer* )pRet )->m_bPoolable = true;
+            }
+
+            else
+            {
+                SAFE_RELEASE( pRet );
+            }
+        }
+
+        vpx_usec_timer_mark( &tCreate );
+
+        Concurrency::critical_section::scoped_lock lock( csVideoRendererPool );
+        ++nVideoRendererPoolMisses;
+        fVideoRendererCreateTime += ( float( vpx_usec_timer_elapsed( &tCreate ) ) / MICROSECOND - fVideoRendererCreateTime ) / nVideoRendererPoolMisses;
+
+        return pRet;
+    }
+
+    bool poolVideoRenderer( CVideoRenderer* res )
+    {
+        if ( !res->m_bPoolable || !gVideoplayerSystem || gVideoplayerSystem->vp_poolsize <= 0 )
+        {
+            return false;
+        }
+
+        res->m_fPooledTime = gEnv->pTimer->GetAsyncCurTime();
+
+        Concurrency::critical_section::scoped_lock lock( csVideoRendererPool );
+        vVideoRendererPool.push_back( res );
+
+        return true;
+    }
+
+    size_t getVideoRendererPoolBytes()
+    {
+        Concurrency::critical_section::scoped_lock lock( csVideoRendererPool );
+
+        size_t nBytes = 0;
+
+        for ( tVideoRendererPool::const_iterator iter = vVideoRendererPool.begin(); iter != vVideoRendererPool.end(); ++iter )
+        {
+            size_t nStaging, nTexture;
+            ( *iter )->GetMemoryUsage( nStaging, nTexture );
+            nBytes += nStaging + nTexture;
+        }
+
+        return nBytes;
+    }
+
+    void trimVideoRendererPool( bool bAll )
+    {
+        Concurrency::critical_section::scoped_lock lock( csVideoRendererPool );
+
+        if ( vVideoRendererPool.empty() )
+        {
+            return;
+        }
+
+        int nMax = 0;
+        float fExpired = -1;
+
+        if ( !bAll && gVideoplayerSystem )
+        {
+            nMax = max( gVideoplayerSystem->vp_poolsize, 0 );
+            fExpired = gEnv->pTimer->GetAsyncCurTime() - gVideoplayerSystem->vp_pooltimeout;
+        }
+
+        // oldest first, so both the excess and the expired ones are at the front
+        tVideoRendererPool::iterator iter = vVideoRendererPool.begin();
+
+        while ( iter != vVideoRendererPool.end() && ( int( vVideoRendererPool.end() - iter ) > nMax || ( *iter )->m_fPooledTime < fExpired ) )
+        {
+            markVideoResourceForCleanup( *iter );
+            ++iter;
+        }
+
+        vVideoRendererPool.erase( vVideoRendererPool.begin(), iter );
+    }
+
+    void getVideoRendererPoolStats( unsigned& nHits, unsigned& nMisses, float& fCreateTime )
     {
-        Concurrency::critical_section::scoped_lock lock( csVideoResources );
-        qVideoResourcesCleanup.push( res );
-        mVideoRendererUpdate.erase( ( IVideoRenderer* )res );
+        Concurrency::critical_section::scoped_lock lock( csVideoRendererPool );
+
+        nHits = nVideoRendererPoolHits;
+        nMisses = nVideoRendererPoolMisses;
+        fCreateTime = fVideoRendererCreateTime;
+    }
+
+    void markVideoResourceForCleanup( CVideoRenderer* res )
+    {
+        // updates skip it from now on
+        InterlockedExchange( &res->m_nRetired, 1 );
+
+        CVideoRenderer* pFirst;
+
+        do
+        {
+            pFirst = pVideoRenderersRetired;
+            res->m_pNextRetired = pFirst;
+        }
+        while ( InterlockedCompareExchangePointer( ( PVOID volatile* )&pVideoRenderersRetired, res, pFirst ) != pFirst );
     };
 
     void cleanupVideoResources()
     {
-        Concurrency::critical_section::scoped_lock lock( csVideoResources ) ;
+        trimVideoRendererPool();
+
+        Concurrency::critical_section::scoped_lock lock( csVideoResourcesCleanup );
+
+        // unregister everything marked until now
+        CVideoRenderer* pItem = ( CVideoRenderer* )InterlockedExchangePointer( ( PVOID volatile* )&pVideoRenderersRetired, NULL );
+
+        if ( pItem )
+        {
+            while ( pItem )
+            {
+                CVideoRenderer* pNext = pItem->m_pNextRetired;
+                unregisterVideoRenderer( pItem );
+
+                pItem->m_pNextRetired = pVideoRenderersLimbo;
+                pVideoRenderersLimbo = pItem;
+                pItem = pNext;
+            }
+
+            // updates starting after this increment can't reach the unregistered renderers anymore
+            LONG nRetireEpoch = InterlockedIncrement( &nVideoRendererEpoch ) - 1;
 
-        while ( !qVideoResourcesCleanup.empty() )
+            for ( pItem = pVideoRenderersLimbo; pItem && !pItem->m_nRetireEpoch; pItem = pItem->m_pNextRetired )
+            {
+                pItem->m_nRetireEpoch = nRetireEpoch;
+            }
+        }
+
+        // free what no running update can see anymore
+        CVideoRenderer** ppItem = &pVideoRenderersLimbo;
+
+        while ( *ppItem )
         {
-            IVideoResource* item = qVideoResourcesCleanup.front();
+            pItem = *ppItem;
 
-            if ( item )
+            if ( isVideoRendererReachable( pItem->m_nRetireEpoch ) )
             {
-                item->Cleanup();
+                ppItem = &pItem->m_pNextRetired;
             }
 
-            qVideoResourcesCleanup.pop();
+            else
+            {
+                *ppItem = pItem->m_pNextRetired;
+                pItem->Cleanup();
+            }
         }
     };
 
+    float fVideoUploadTimePerByte[VRT_MAX] = {0}; //!< measured upload cost per type in microseconds per byte
+
     // TODO: Keep watching http://code.google.com/p/webm/issues/detail?id=162
     void updateVideoResources( eRendererType nType )
     {
-        Concurrency::critical_section::scoped_lock lock( csVideoResources );
+#if !defined(VP_DISABLE_RENDER)
+        VPXDEC_TRACE( "updateVideoResources", -1 );
 
-        // TODO: 32 bit DX11 Version will crash if this takes longer then 2-3 ms ingame so disable this for now.
-        if ( sizeof( void* ) == 4 && gEnv->pRenderer->GetRenderType() == eRT_DX11 && nType == VRT_CE3 && gVideoplayerSystem->GetScreenState() == eSS_InGameScreen )
+        // announce the epoch this update started in, so cleanup keeps everything it could see
+        LONG nEpoch = nVideoRendererEpoch;
+        volatile LONG* pReader = NULL;
+
+        for ( int i = 0; i < VIDEORENDERER_READERS && !pReader; ++i )
         {
-            return;
+            if ( InterlockedCompareExchange( &nVideoRendererReaders[i], nEpoch, 0 ) == 0 )
+            {
+                pReader = &nVideoRendererReaders[i];
+            }
         }
 
-#if !defined(VP_DISABLE_RENDER)
+        if ( !pReader )
+        {
+            return; // too many concurrent updates, the data stays dirty for the next one
+        }
+
+        // budget for this update (0 = unlimited)
+        unsigned nBudgetBytes = unsigned( max( gVideoplayerSystem->vp_uploadbudget, 0 ) ) << 10;
+        float fBudgetTime = max( gVideoplayerSystem->vp_uploadtime, 0.0f ) * MILLISECOND;
+
+        // 32 bit DX11 Version will crash if this takes longer then 2-3 ms ingame,
+        // so every upload there has to fit the budget (nothing is forced and the cost estimate starts high)
+        bool bLimited = sizeof( void* ) == 4 && gEnv->pRenderer->GetRenderType() == eRT_DX11 && nType == VRT_CE3 && gVideoplayerSystem->GetScreenState() == eSS_InGameScreen;
+
+        if ( bLimited )
+        {
+            float fLimited = VIDEORENDERER_LIMITEDTIME * MILLISECOND;
+            fBudgetTime = fBudgetTime > 0 ? min( fBudgetTime, fLimited ) : fLimited;
+
+            if ( fVideoUploadTimePerByte[nType] <= 0 )
+            {
+                fVideoUploadTimePerByte[nType] = VIDEORENDERER_LIMITEDCOST;
+            }
+        }
 
-        for ( tVideoRendererMap::const_iterator iter = mVideoRendererUpdate.begin(); iter != mVideoRendererUpdate.end(); ++iter )
+        // collect dirty renderers sorted by score (no allocations on the render thread)
+        CVideoRenderer* pDirty[VIDEORENDERER_UPLOADS];
+        int nDirty = 0;
+
+        for ( CVideoRenderer* pItem = pVideoRenderers[nType]; pItem; pItem = pItem->m_pNextRenderer )
         {
-            if ( iter->first->GetRendererType() == nType )
+            if ( pItem->m_nRetired || !pItem->GetUploadSize() )
             {
-                iter->first->UpdateTexture();
+                continue;
             }
+
+            if ( nDirty == VIDEORENDERER_UPLOADS )
+            {
+                ++pItem->m_nDeferred;
+                continue;
+            }
+
+            int i = nDirty++;
+
+            for ( ; i > 0 && pDirty[i - 1]->GetUploadScore() < pItem->GetUploadScore(); --i )
+            {
+                pDirty[i] = pDirty[i - 1];
+            }
+
+            pDirty[i] = pItem;
         }
 
+        // upload the most important ones, at least one so everything progresses (unless limited)
+        unsigned nBytes = 0;
+        vpx_usec_timer tUpload;
+        vpx_usec_timer_start( &tUpload );
+
+        for ( int i = 0; i < nDirty; ++i )
+        {
+            CVideoRenderer* pItem = pDirty[i];
+            unsigned nSize = pItem->GetUploadSize();
+
+            if ( i > 0 || bLimited )
+            {
+                vpx_usec_timer_mark( &tUpload );
+                float fElapsed = float( vpx_usec_timer_elapsed( &tUpload ) );
+
+                if ( ( nBudgetBytes && nBytes + nSize > nBudgetBytes ) || ( fBudgetTime > 0 && fElapsed + nSize * fVideoUploadTimePerByte[nType] > fBudgetTime ) )
+                {
+                    // defer, newer frames overwrite the data until it gets its turn
+                    for ( ; i < nDirty; ++i )
+                    {
+                        ++pDirty[i]->m_nDeferred;
+                    }
+
+                    break;
+                }
+            }
+
+            vpx_usec_timer tItem;
+            vpx_usec_timer_start( &tItem );
+
+            ( ( IVideoRenderer* )pItem )->UpdateTexture();
+            pItem->m_nDeferred = 0;
+            nBytes += nSize;
+
+            vpx_usec_timer_mark( &tItem );
+            float fItem = float( vpx_usec_timer_elapsed( &tItem ) );
+            fVideoUploadTimePerByte[nType] += ( fItem / nSize - fVideoUploadTimePerByte[nType] ) * 0.1f;
+
+            pItem->m_fUploadTime = fItem;
+            InterlockedIncrement( &pItem->m_nUploads );
+        }
+
+        InterlockedExchange( pReader, 0 );
 #endif
     };
-}
\ No newline at end of file
+}
+#endif
@@ -2,8 +2,16 @@
 
 #include "stdint.h"
 #include "stdlib.h"
-#include <BaseTsd.h>
 #include <memory.h>
+#include <Renderer/yuvconv.h>
+
+#if defined(VP_STANDALONE) && !defined(_WIN32)
+#include <malloc.h>
+typedef intptr_t INT_PTR;
+typedef int32_t LONG;
+#else
+#include <BaseTsd.h>
+#endif
 
 #pragma once
 
@@ -11,78 +19,26 @@
 #define USE_SEPERATEMEMORY // for thread safety split texture update and yuv conversion
 #define USE_ALIGNEDMEMORY // for sse functions
 #define ALIGNEDMEMORY 16
+#define VIDEORENDERER_READERS 4 //!< threads that can update video resources at the same time
+#define VIDEORENDERER_UPLOADS 32 //!< renderers considered per update, the rest is deferred
+#define VIDEORENDERER_STALENESS 4 //!< deferred uploads that outweigh one upload priority
+#define VIDEORENDERER_NEAR 20.0f //!< in-world outputs closer than x meters get the near upload priority
+#define VIDEORENDERER_LIMITEDTIME 1.5f //!< upload budget in ms where long updates crash (32 bit DX11 ingame)
+#define VIDEORENDERER_LIMITEDCOST 0.0004f //!< assumed upload cost in microseconds per byte until one was measured there (2.5 GB/s)
 
 #define VIDEO_TEXTURE_FLAGS FILTER_LINEAR | FT_DONT_STREAM | FT_NOMIPS // | FT_DONT_RESIZE // doesn't help for old hardware and on new one we support resized textures anyways (the excess area wont be used)
 
+// VP_STANDALONE builds only the renderer base and the null renderer without the engine (tools/vpbench),
+// there is no renderer registry, pool or upload scheduling then
+
 namespace VideoplayerPlugin
 {
-    /**
-    * @brief byte order of the texture
-    */
-    enum eByteOrder
-    {
-        VBO_RGBA, //!< DX11 byte order
-        VBO_BGRA, //!< DX9 byte order
-    };
-
-    /**
-    * @brief this is a work in progress
-    */
-    enum eAlphaMode
-    {
-        VAM_FILL, //!< set alpha to 255
-        VAM_PASSTROUGH, //!< write alpha channel as it is
-        VAM_FALLOF, //!<  modify alpha channel using a fallof effect // TODO
-        VAM_COLORMASK //!< create alpha channel based on RGB channel // TODO
-    };
-
-    /**
-    * @brief this is a work in progress
-    */
-    typedef struct SAlphaGenParam_
-    {
-        SAlphaGenParam_()
-        {
-            r = 54;
-            g = 198;
-            b = 43;
-
-            ws = r + g + b;
-            wr = 1 << 8; //(r << 8) / ws;
-            wg = 1 << 8; //(g << 8) / ws;
-            wb = 1 << 8; //(b << 8) / ws;
-            ws = wr + wg + wb;
-            ws *= ws;
-
-            fallof = 50;
-            tolerance = 40;
-            diff = fallof - tolerance;
-            mull = 255 / diff;
-        }
-
-        int r, g, b; // colormask
-        int wr, wg, wb, ws; // color weights
-        int temp;
-        int temp2;
-        int fallof;
-        int tolerance;
-        int diff;
-        int mull;
-    } SAlphaGenParam;
-
-    unsigned char*  copyPlane( unsigned int cols, unsigned int lines, unsigned char* dst, unsigned int dstStride, unsigned char* src, unsigned int srcStride );
-
-    template<eByteOrder COLOR_DST_FMT, eAlphaMode ALPHAMODE>
-    void YV12_2_( unsigned char* y, unsigned char* u, unsigned char* v, unsigned char* a, unsigned int cols, unsigned int lines, uint32_t* dst, unsigned int dstStride, unsigned int srcStrideY, unsigned int srcStrideU, unsigned int srcStrideV, unsigned int srcStrideA, SAlphaGenParam& ap );
+#if defined(VP_STANDALONE)
+    extern eByteOrder eStandaloneByteOrder; //!< byte order of the conversions without an engine renderer (default DX9)
+#endif
 
     void YV12_2_TEX( unsigned char* y, unsigned char* u, unsigned char* v, unsigned char* a, unsigned int cols, unsigned int lines, uint32_t* dst, unsigned int dstStride, unsigned int srcStrideY, unsigned int srcStrideU, unsigned int srcStrideV, unsigned int srcStrideA, SAlphaGenParam& ap );
 
-    template<eByteOrder COLOR_DST_FMT, eAlphaMode ALPHAMODE>
-    void SSE2_YUV420_2_( uint8_t* yp, uint8_t* up, uint8_t* vp, uint8_t* yap,
-                         uint32_t sy, uint32_t suv, uint32_t sa,
-                         int width, int height,
-                         uint32_t* rgb, uint32_t srgb, SAlphaGenParam& ap );
-
     enum eVideoType
     {
         VT_LIBVPX, //!< WebM/IVF/RAW vp8 video
@@ -97,6 +53,19 @@ namespace VideoplayerPlugin
         VRT_DX9, //!< force dx9 renderer
         VRT_DX11, //!< force dx11 renderer // TODO partial implementation present
         VRT_CE3, //!< force cryengine3 api based renderer
+        VRT_NULL, //!< conversion only without any texture (benchmarks, headless)
+        VRT_MAX, //!< number of renderer types (internal)
+    };
+
+    /**
+    * @brief Importance of the texture upload when the upload budget is exceeded
+    */
+    enum eUploadPriority
+    {
+        VUP_FAR, //!< far away in-world output
+        VUP_NEAR, //!< near or unknown distance in-world output
+        VUP_2D, //!< 2D output (e.g. fullscreen)
+        VUP_CRITICAL, //!< critical video @see VPR_Critical
     };
 
     struct IVideoResource
@@ -118,23 +87,104 @@ namespace VideoplayerPlugin
         virtual INT_PTR GetRenderTarget( eRendererType eType ) = 0;
         virtual void RenderFrame( void* pData ) = 0;
         virtual void UpdateTexture() = 0;
+        virtual void SetUploadPriority( eUploadPriority ePriority ) = 0;
+
+        /**
+        * @brief Duration of the last texture upload if there was one since the last call
+        * @param[out] fUploadTime upload time in microseconds
+        * @return an upload happened since the last call
+        */
+        virtual bool TakeUploadTime( float& fUploadTime ) = 0;
+
+        /**
+        * @brief Tag the trace events of this renderer
+        * @param nTag video id (-1 none)
+        */
+        virtual void SetTraceTag( int nTag ) = 0;
+
+        /**
+        * @brief Memory held by the renderer
+        * @param[out] nStaging bytes of the conversion buffer
+        * @param[out] nTexture bytes of the texture (estimated from the converted size)
+        */
+        virtual void GetMemoryUsage( size_t& nStaging, size_t& nTexture ) = 0;
+
+        /**
+        * @brief Crossfade: blend the frames of another renderer into the own texture in the conversion stage
+        * While blending the own frames are converted into a second buffer and the source isn't uploaded,
+        * so only a single texture is updated and drawn.
+        * @param pSource renderer of the incoming video (same source size), NULL stops blending
+        * @param fWeight weight of the source (0-1)
+        * @return blending
+        */
+        virtual bool SetBlendSource( IVideoRenderer* pSource, float fWeight ) = 0;
     };
 
+    class CVideoRenderer;
+
+    /**
+    * @brief Create a video renderer and register it for updates
+    * Registration is lock free, so it can't block the render thread.
+    * @param eType renderer type
+    * @return renderer or NULL
+    */
     IVideoRenderer* createVideoRenderer( eRendererType eType );
 
+    /**
+    * @brief Get a video renderer with created resources
+    * Reuses a pooled renderer of the same type and size if available, else creates a new one.
+    * VRT_AUTO selects VRT_NULL without an engine renderer or when vp_nullrenderer is set.
+    * @param eType renderer type
+    * @param[out] bReused Set if the renderer came from the pool
+    * @return renderer or NULL if the resources couldn't be created
+    */
+    IVideoRenderer* acquireVideoRenderer( eRendererType eType, unsigned nSourceWidth, unsigned nSourceHeight, unsigned nTargetWidth, unsigned nTargetHeight, bool& bReused );
+
+    /**
+    * @brief Keep an unreferenced renderer for reuse instead of freeing it
+    * @param res renderer without references
+    * @return pooled (else it has to be marked for cleanup)
+    */
+    bool poolVideoRenderer( CVideoRenderer* res );
+
+    /**
+    * @brief Memory held by the pooled renderers
+    * @return bytes of their conversion buffers and textures
+    */
+    size_t getVideoRendererPoolBytes();
+
+    /**
+    * @brief Free unused pooled renderers
+    * @param bAll Free all of them (e.g. device reset), else only the idle/excess ones
+    */
+    void trimVideoRendererPool( bool bAll = false );
+
+    /**
+    * @brief Retrieve pool statistics
+    * @param[out] nHits renderers reused
+    * @param[out] nMisses renderers created
+    * @param[out] fCreateTime average creation time in seconds
+    */
+    void getVideoRendererPoolStats( unsigned& nHits, unsigned& nMisses, float& fCreateTime );
+
     /**
     * @brief Mark Video Resource for later cleanup
+    * The renderer is skipped by updates immediately, it is freed by cleanupVideoResources once no update can still see it.
     * @param res resource to be deleted
     */
-    void markVideoResourceForCleanup( IVideoResource* res );
+    void markVideoResourceForCleanup( CVideoRenderer* res );
 
     /**
     * @brief Cleanup all video resources marked for cleanup
+    * Renderers still visible to a running update are kept until a later call.
     */
     void cleanupVideoResources();
 
     /**
     * @brief Transfer video resources into gpu memory
+    * Doesn't lock, walks the renderer list of this type only.
+    * Uploads by priority and staleness within vp_uploadbudget/vp_uploadtime, the rest stays dirty
+    * and is coalesced with newer frames into a later upload.
     */
     void updateVideoResources( eRendererType nType );
 
@@ -149,21 +199,157 @@ namespace VideoplayerPlugin
             unsigned char* m_pData;
             unsigned int m_nSourceWidth;
             unsigned int m_nSourceHeight;
+            unsigned int m_nTargetWidth;
+            unsigned int m_nTargetHeight;
             unsigned int m_nSize;
             bool m_bDirty;
 
             CVideoRenderer()
             {
+                m_pNextRenderer = NULL;
+                m_pNextRetired = NULL;
+                m_nRetired = 0;
+                m_nRetireEpoch = 0;
+
                 m_nReferences = 1;
                 m_pData = NULL;
                 m_nSourceWidth = 0;
                 m_nSourceHeight = 0;
+                m_nTargetWidth = 0;
+                m_nTargetHeight = 0;
                 m_nSize = 0;
                 m_bDirty = false;
+
+                m_bPoolable = false;
+                m_fPooledTime = 0;
+
+                m_ePriority = VUP_NEAR;
+                m_nDeferred = 0;
+
+                m_nUploads = 0;
+                m_nUploadsTaken = 0;
+                m_fUploadTime = 0;
+
+                m_nTraceTag = -1;
+
+                m_pBlendSource = NULL;
+                m_pBlendData = NULL;
+                m_nBlendTargets = 0;
             };
 
         public:
 
+            // renderer registry (intrusive so the render thread doesn't need any allocations or locks)
+            CVideoRenderer* volatile m_pNextRenderer; //!< next renderer of the same type
+            CVideoRenderer* m_pNextRetired; //!< next renderer waiting for cleanup
+            volatile long m_nRetired; //!< marked for cleanup, updates skip it
+            long m_nRetireEpoch; //!< epoch in which it was unlinked
+
+            // renderer pool
+            bool m_bPoolable; //!< resources were created successfully so the renderer can be reused
+            float m_fPooledTime; //!< time it was returned to the pool
+
+            // upload scheduling (only used by the update of this renderer type)
+            eUploadPriority m_ePriority; //!< set by the video each frame
+            unsigned m_nDeferred; //!< updates that skipped this dirty renderer because of the budget
+
+            // upload statistics (written by the update, taken by the video)
+            volatile LONG m_nUploads; //!< uploads done
+            LONG m_nUploadsTaken; //!< uploads the video already took the time of
+            float m_fUploadTime; //!< duration of the last upload in microseconds
+
+            int m_nTraceTag; //!< tag of the trace events (video id, -1 none)
+
+            // crossfade (only used by the videos on the main thread)
+            CVideoRenderer* m_pBlendSource; //!< renderer blended into this one (referenced)
+            unsigned char* m_pBlendData; //!< own converted frame while blending, m_pData holds the blend
+            unsigned m_nBlendTargets; //!< renderers blending this one, its uploads are skipped meanwhile
+
+            /**
+            * @brief Bytes the next UpdateTexture will transfer
+            * @return 0 if there is nothing to upload
+            */
+            unsigned GetUploadSize()
+            {
+                return m_bDirty && m_pData && !m_nBlendTargets ? m_nSize : 0;
+            };
+
+            /**
+            * @brief Buffer the next frame is converted into
+            */
+            uint32_t* GetConvertTarget()
+            {
+                return ( uint32_t* )( m_pBlendData ? m_pBlendData : m_pData );
+            };
+
+            /**
+            * @brief Order of uploads when the budget is exceeded
+            * @return larger values first
+            */
+            unsigned GetUploadScore()
+            {
+                return unsigned( m_ePriority ) * VIDEORENDERER_STALENESS + m_nDeferred;
+            };
+
+            virtual void SetUploadPriority( eUploadPriority ePriority )
+            {
+                m_ePriority = ePriority;
+            };
+
+            virtual bool TakeUploadTime( float& fUploadTime )
+            {
+                LONG nUploads = m_nUploads;
+
+                if ( nUploads == m_nUploadsTaken )
+                {
+                    return false;
+                }
+
+                m_nUploadsTaken = nUploads;
+                fUploadTime = m_fUploadTime;
+                return true;
+            };
+
+            virtual void SetTraceTag( int nTag )
+            {
+                m_nTraceTag = nTag;
+            };
+
+            virtual bool SetBlendSource( IVideoRenderer* pSource, float fWeight );
+
+            virtual void GetMemoryUsage( size_t& nStaging, size_t& nTexture )
+            {
+                nStaging = ( m_pData ? m_nSize : 0 ) + ( m_pBlendData ? m_nSize : 0 );
+                nTexture = m_pData && GetRendererType() != VRT_NULL ? m_nSize : 0;
+            };
+
+            /**
+            * @brief Check if the renderer resources fit the requested size
+            * @return matching
+            */
+            bool MatchesResources( unsigned nSourceWidth, unsigned nSourceHeight, unsigned nTargetWidth, unsigned nTargetHeight )
+            {
+                return m_nSourceWidth == ( ( nSourceWidth >> RESBASE ) << RESBASE )
+                       && m_nSourceHeight == ( ( nSourceHeight >> RESBASE ) << RESBASE )
+                       && m_nTargetWidth == nTargetWidth
+                       && m_nTargetHeight == nTargetHeight;
+            };
+
+            /**
+            * @brief Take a pooled renderer back into use
+            * The last frame of the previous video is cleared like on creation.
+            */
+            void Reuse()
+            {
+                m_nReferences = 1;
+
+                if ( m_pData )
+                {
+                    memset( m_pData, 255, m_nSize );
+                    m_bDirty = true;
+                }
+            };
+
             virtual void AddRef()
             {
                 m_nReferences += 1;
@@ -194,6 +380,8 @@ namespace VideoplayerPlugin
 
                 m_nSourceWidth  = ( nSourceWidth >> RESBASE ) << RESBASE;
                 m_nSourceHeight = ( nSourceHeight >> RESBASE ) << RESBASE;
+                m_nTargetWidth  = nTargetWidth;
+                m_nTargetHeight = nTargetHeight;
 
                 m_nSize = m_nSourceWidth * m_nSourceHeight * 4;
 
@@ -212,24 +400,7 @@ namespace VideoplayerPlugin
                 return m_pData;
             };
 
-            virtual void ReleaseResources()
-            {
-                if ( m_pData )
-                {
-#if defined(USE_ALIGNEDMEMORY)
-#if defined(_WIN32)
-                    _aligned_free( m_pData );
-#else
-                    free( m_pData );
-#endif
-#else
-                    delete [] m_pData;
-#endif
-                    m_pData = NULL;
-                }
-
-                m_bDirty = false;
-            };
+            virtual void ReleaseResources();
 
         private:
 
@@ -78,6 +78,8 @@ namespace VideoplayerPlugin
 
     void CVideoRendererCE3::RenderFrame( void* pData )
     {
+        VPXDEC_TRACE( "RenderFrame", m_nTraceTag );
+
         if ( pData && m_iTex > 0 )
         {
             // if no img then frame was dropped
@@ -85,8 +87,8 @@ namespace VideoplayerPlugin
             SAlphaGenParam ap;
 
 #if defined(USE_SEPERATEMEMORY)
-            YV12_2_TEX( img->planes[VPX_PLANE_Y], img->planes[VPX_PLANE_U], img->planes[VPX_PLANE_V], NULL, m_nSourceWidth, m_nSourceHeight, ( uint32_t* ) m_pData, m_nSourceWidth, img->stride[VPX_PLANE_Y], img->stride[VPX_PLANE_V], img->stride[VPX_PLANE_U], 0, ap );
-            m_bDirty = true;
+            YV12_2_TEX( img->planes[VPX_PLANE_Y], img->planes[VPX_PLANE_U], img->planes[VPX_PLANE_V], NULL, m_nSourceWidth, m_nSourceHeight, GetConvertTarget(), m_nSourceWidth, img->stride[VPX_PLANE_Y], img->stride[VPX_PLANE_V], img->stride[VPX_PLANE_U], 0, ap );
+            m_bDirty = !m_pBlendData; // while blending the blend is uploaded
 #elif defined(USE_LOCK_RECT)
 
             int nPitch;
@@ -131,6 +133,8 @@ namespace VideoplayerPlugin
 
     void CVideoRendererCE3::UpdateTexture()
     {
+        VPXDEC_TRACE( "UpdateTexture", m_nTraceTag );
+
 #if defined(USE_SEPERATEMEMORY)
 
         if ( m_pData && m_bDirty )
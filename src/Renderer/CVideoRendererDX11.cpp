@@ -34,6 +34,8 @@ namespace VideoplayerPlugin
 
     void CVideoRendererDX11::RenderFrame( void* pData )
     {
+        VPXDEC_TRACE( "RenderFrame", m_nTraceTag );
+
         if ( pData )
         {
             // if no img then frame was dropped
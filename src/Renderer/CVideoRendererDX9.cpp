@@ -199,6 +199,8 @@ namespace VideoplayerPlugin
 
     void CVideoRendererDX9::RenderFrame( void* pData )
     {
+        VPXDEC_TRACE( "RenderFrame", m_nTraceTag );
+
         if ( pData )
         {
             // if no img then frame was dropped
@@ -206,9 +208,9 @@ namespace VideoplayerPlugin
 #if defined(USE_SEPERATEMEMORY)
             vpx_image_t* img = ( vpx_image_t* )pData;
             SAlphaGenParam ap;
-            YV12_2_TEX( img->planes[VPX_PLANE_Y], img->planes[VPX_PLANE_U], img->planes[VPX_PLANE_V], NULL, m_nSourceWidth, m_nSourceHeight, ( uint32_t* ) m_pData, m_nSourceWidth, img->stride[VPX_PLANE_Y], img->stride[VPX_PLANE_V], img->stride[VPX_PLANE_U], 0, ap );
+            YV12_2_TEX( img->planes[VPX_PLANE_Y], img->planes[VPX_PLANE_U], img->planes[VPX_PLANE_V], NULL, m_nSourceWidth, m_nSourceHeight, GetConvertTarget(), m_nSourceWidth, img->stride[VPX_PLANE_Y], img->stride[VPX_PLANE_V], img->stride[VPX_PLANE_U], 0, ap );
             //YV12_2_TEX( img->planes[VPX_PLANE_Y], img->planes[VPX_PLANE_U], img->planes[VPX_PLANE_V], img->planes[VPX_PLANE_Y], m_nSourceWidth, m_nSourceHeight, ( uint32_t* ) m_pData, m_nSourceWidth, img->stride[VPX_PLANE_Y], img->stride[VPX_PLANE_V], img->stride[VPX_PLANE_U], img->stride[VPX_PLANE_Y], ap );
-            m_bDirty = true;
+            m_bDirty = !m_pBlendData; // while blending the blend is uploaded
 #else
             D3DLOCKED_RECT LockedRect;
             memset( &LockedRect, 0, sizeof( LockedRect ) );
@@ -303,6 +305,8 @@ namespace VideoplayerPlugin
 
     void CVideoRendererDX9::UpdateTexture()
     {
+        VPXDEC_TRACE( "UpdateTexture", m_nTraceTag );
+
 #if defined(USE_SEPERATEMEMORY)
 
         if ( m_pData && m_bDirty )
@@ -0,0 +1,159 @@
+/* Videoplayer_Plugin - for licensing and copyright see license.txt */
+
+#if !defined(VP_STANDALONE)
+#include <StdAfx.h>
+#include <Renderer/CVideoRendererNull.h>
+#include <WebM/vpxdec_ext.h>
+#include <CPluginVideoplayer.h>
+#include <CVideoplayerSystem.h>
+
+#define NULL_CHECKSUM ( gVideoplayerSystem ? gVideoplayerSystem->vp_nullchecksum : 0 )
+#define NULL_LOG gPlugin->LogAlways
+#else
+#include <Renderer/CVideoRendererNull.h>
+#include <WebM/vpxdec_ext.h>
+#include <algorithm>
+
+#define NULL_CHECKSUM nStandaloneChecksum
+#define NULL_LOG( sFormat, ... ) printf( sFormat "\n", __VA_ARGS__ )
+#define MICROSECOND 1000000.0f
+#define MILLISECOND 1000.0f
+
+using std::max;
+#endif
+
+namespace VideoplayerPlugin
+{
+#if defined(VP_STANDALONE)
+    int nStandaloneChecksum = 0;
+#endif
+
+    /**
+    * @brief Adler-32 of a memory block
+    */
+    static uint32_t adler32( const unsigned char* pData, size_t nSize )
+    {
+        uint32_t a = 1;
+        uint32_t b = 0;
+
+        while ( nSize )
+        {
+            // largest block that can't overflow before the modulo
+            size_t nBlock = nSize < 5552 ? nSize : 5552;
+            nSize -= nBlock;
+
+            while ( nBlock-- )
+            {
+                a += *pData++;
+                b += a;
+            }
+
+            a %= 65521;
+            b %= 65521;
+        }
+
+        return ( b << 16 ) | a;
+    }
+
+    CVideoRendererNull::CVideoRendererNull()
+    {
+        m_nFrames = 0;
+        m_fConvertTime = 0;
+        m_fConvertTimeMax = 0;
+        m_nChecksum = 0;
+
+#if defined(_DEBUG)
+        NULL_LOG( "%s", "Created Null VideoRenderer" );
+#endif
+    }
+
+    CVideoRendererNull::~CVideoRendererNull()
+    {
+    }
+
+    void CVideoRendererNull::Release()
+    {
+        // report per video, the renderer itself might be reused by the pool
+        if ( m_nReferences == 1 && m_nFrames > 0 )
+        {
+            NULL_LOG( "Null renderer size(%ux%u) frames(%u) convert avg(%.2fms) max(%.2fms) checksum(%08x)", m_nSourceWidth, m_nSourceHeight, m_nFrames, m_fConvertTime / m_nFrames * MILLISECOND, m_fConvertTimeMax * MILLISECOND, m_nChecksum );
+
+            m_nFrames = 0;
+            m_fConvertTime = 0;
+            m_fConvertTimeMax = 0;
+            m_nChecksum = 0;
+        }
+
+        CVideoRenderer::Release();
+    }
+
+    void CVideoRendererNull::ReleaseResources()
+    {
+        CVideoRenderer::ReleaseResources();
+    }
+
+    INT_PTR CVideoRendererNull::GetRenderTarget( eRendererType eType )
+    {
+        switch ( eType )
+        {
+            case VRT_NULL:
+                return INT_PTR( m_pData );
+
+            default:
+                break;
+        }
+
+        return 0;
+    }
+
+    bool CVideoRendererNull::CreateResources( unsigned nSourceWidth, unsigned nSourceHeight, unsigned nTargetWidth, unsigned nTargetHeight )
+    {
+        ReleaseResources();
+
+        return CVideoRenderer::CreateResources( nSourceWidth, nSourceHeight, nTargetWidth, nTargetHeight ) && m_pData;
+    }
+
+    void CVideoRendererNull::RenderFrame( void* pData )
+    {
+        VPXDEC_TRACE( "RenderFrame", m_nTraceTag );
+
+        if ( pData && m_pData )
+        {
+            vpx_image_t* img = ( vpx_image_t* )pData;
+            SAlphaGenParam ap;
+
+            vpx_usec_timer tConvert;
+            vpx_usec_timer_start( &tConvert );
+
+            YV12_2_TEX( img->planes[VPX_PLANE_Y], img->planes[VPX_PLANE_U], img->planes[VPX_PLANE_V], NULL, m_nSourceWidth, m_nSourceHeight, GetConvertTarget(), m_nSourceWidth, img->stride[VPX_PLANE_Y], img->stride[VPX_PLANE_V], img->stride[VPX_PLANE_U], 0, ap );
+
+            vpx_usec_timer_mark( &tConvert );
+            float fTime = float( vpx_usec_timer_elapsed( &tConvert ) ) / MICROSECOND;
+
+            ++m_nFrames;
+            m_fConvertTime += fTime;
+            m_fConvertTimeMax = max( m_fConvertTimeMax, fTime );
+
+            // nothing is uploaded, so the data is never dirty
+            if ( NULL_CHECKSUM > 0 )
+            {
+                uint32_t nFrameChecksum = adler32( m_pData, m_nSize );
+                m_nChecksum = m_nChecksum * 31 + nFrameChecksum;
+
+                if ( NULL_CHECKSUM > 1 )
+                {
+                    NULL_LOG( "Null renderer frame(%u) checksum(%08x) convert(%.2fms)", m_nFrames, nFrameChecksum, fTime * MILLISECOND );
+                }
+            }
+        }
+    }
+
+    uint32_t CVideoRendererNull::GetStats( unsigned& nFrames, float& fConvertTime, float& fConvertTimeMax )
+    {
+        nFrames = m_nFrames;
+        fConvertTime = m_nFrames ? m_fConvertTime / m_nFrames : 0;
+        fConvertTimeMax = m_fConvertTimeMax;
+
+        return m_nChecksum;
+    }
+}
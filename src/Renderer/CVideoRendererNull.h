@@ -0,0 +1,52 @@
+/* Videoplayer_Plugin - for licensing and copyright see license.txt */
+
+#include <Renderer/CVideoRenderer.h>
+
+namespace VideoplayerPlugin
+{
+#if defined(VP_STANDALONE)
+    extern int nStandaloneChecksum; //!< vp_nullchecksum without the engine (0 off, 1 per renderer, 2 also per frame)
+#endif
+
+    /**
+    * @brief Renderer without engine or device resources
+    * Converts each frame into its (pooled) memory like the other renderers but never uploads it.
+    * Used for benchmarks and headless runs (no gEnv->pRenderer).
+    */
+    class CVideoRendererNull :
+        public CVideoRenderer
+    {
+            unsigned        m_nFrames; //!< frames converted since the renderer was acquired
+            float           m_fConvertTime; //!< total conversion time in seconds
+            float           m_fConvertTimeMax; //!< slowest conversion in seconds
+            uint32_t        m_nChecksum; //!< checksum of all converted frames (if vp_nullchecksum is enabled)
+
+        public:
+            CVideoRendererNull();
+            virtual ~CVideoRendererNull();
+
+            virtual eRendererType GetRendererType()
+            {
+                return VRT_NULL;
+            };
+
+            virtual void Release();
+
+            virtual bool CreateResources( unsigned nSourceWidth, unsigned nSourceHeight, unsigned nTargetWidth, unsigned nTargetHeight );
+            virtual void ReleaseResources();
+
+            virtual INT_PTR GetRenderTarget( eRendererType eType );
+
+            virtual void RenderFrame( void* pData );
+            virtual void UpdateTexture() {};
+
+            /**
+            * @brief Retrieve the statistics of the frames converted until now
+            * @param[out] nFrames converted frames
+            * @param[out] fConvertTime average conversion time in seconds
+            * @param[out] fConvertTimeMax slowest conversion in seconds
+            * @return checksum of all frames (0 if disabled)
+            */
+            uint32_t GetStats( unsigned& nFrames, float& fConvertTime, float& fConvertTimeMax );
+    };
+}
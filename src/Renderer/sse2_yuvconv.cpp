@@ -17,7 +17,7 @@
 #include "emmintrin.h"
 #include "mmintrin.h"
 
-#include <Renderer/CVideoRenderer.h>
+#include <Renderer/yuvconv.h>
 
 namespace VideoplayerPlugin
 {
@@ -280,7 +280,7 @@ namespace VideoplayerPlugin
     uint32_t *rgb, uint32_t srgb, SAlphaGenParam& ap
 
     template<eByteOrder COLOR_DST_FMT, eAlphaMode ALPHAMODE>
-    inline void SSE2_YUV420_2_( PARAMS )
+    void SSE2_YUV420_2_( PARAMS )
     {
         __m128i y0r0, y0r1, u0, v0;
         __m128i a0r0, a0r1;
@@ -411,22 +411,49 @@ namespace VideoplayerPlugin
         }
     }
 
-    void SSE2_YUV420_2_dummy()
-    {
-        // force the compiler to include these template variations
-        SAlphaGenParam d;
+    // explicit instantiation of the template variations (the conversion dispatch is in another translation unit)
 #undef PARAMS
-#define PARAMS 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, d
+#define PARAMS uint8_t*, uint8_t*, uint8_t*, uint8_t*, uint32_t, uint32_t, uint32_t, int, int, uint32_t*, uint32_t, SAlphaGenParam&
+
+    template void SSE2_YUV420_2_<VBO_RGBA, VAM_FILL>( PARAMS );
+    template void SSE2_YUV420_2_<VBO_RGBA, VAM_PASSTROUGH>( PARAMS );
+    template void SSE2_YUV420_2_<VBO_RGBA, VAM_FALLOF>( PARAMS );
+    template void SSE2_YUV420_2_<VBO_RGBA, VAM_COLORMASK>( PARAMS );
 
-        SSE2_YUV420_2_<VBO_RGBA, VAM_FILL>( PARAMS );
-        SSE2_YUV420_2_<VBO_RGBA, VAM_PASSTROUGH>( PARAMS );
-        SSE2_YUV420_2_<VBO_RGBA, VAM_FALLOF>( PARAMS );
-        SSE2_YUV420_2_<VBO_RGBA, VAM_COLORMASK>( PARAMS );
+    template void SSE2_YUV420_2_<VBO_BGRA, VAM_FILL>( PARAMS );
+    template void SSE2_YUV420_2_<VBO_BGRA, VAM_PASSTROUGH>( PARAMS );
+    template void SSE2_YUV420_2_<VBO_BGRA, VAM_FALLOF>( PARAMS );
+    template void SSE2_YUV420_2_<VBO_BGRA, VAM_COLORMASK>( PARAMS );
+
+    void SSE2_blendRGB( uint32_t* dst, const uint32_t* src0, const uint32_t* src1, unsigned int nPixels, unsigned int nWeight )
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i w1 = _mm_set1_epi16( short( nWeight ) );
+        const __m128i w0 = _mm_set1_epi16( short( 256 - nWeight ) );
+
+        // 4 pixels at once, the products (at most 255 * 256) fit into unsigned 16 bit
+        unsigned int nBlocks = nPixels >> 2;
+
+        for ( unsigned int i = 0; i < nBlocks; ++i )
+        {
+            __m128i a = _mm_loadu_si128( ( const __m128i* )src0 + i );
+            __m128i b = _mm_loadu_si128( ( const __m128i* )src1 + i );
 
-        SSE2_YUV420_2_<VBO_BGRA, VAM_FILL>( PARAMS );
-        SSE2_YUV420_2_<VBO_BGRA, VAM_PASSTROUGH>( PARAMS );
-        SSE2_YUV420_2_<VBO_BGRA, VAM_FALLOF>( PARAMS );
-        SSE2_YUV420_2_<VBO_BGRA, VAM_COLORMASK>( PARAMS );
+            __m128i lo = _mm_add_epi16( _mm_mullo_epi16( _mm_unpacklo_epi8( a, zero ), w0 ), _mm_mullo_epi16( _mm_unpacklo_epi8( b, zero ), w1 ) );
+            __m128i hi = _mm_add_epi16( _mm_mullo_epi16( _mm_unpackhi_epi8( a, zero ), w0 ), _mm_mullo_epi16( _mm_unpackhi_epi8( b, zero ), w1 ) );
+
+            _mm_storeu_si128( ( __m128i* )dst + i, _mm_packus_epi16( _mm_srli_epi16( lo, 8 ), _mm_srli_epi16( hi, 8 ) ) );
+        }
+
+        // remaining pixels
+        const unsigned char* p0 = ( const unsigned char* )( src0 + ( nBlocks << 2 ) );
+        const unsigned char* p1 = ( const unsigned char* )( src1 + ( nBlocks << 2 ) );
+        unsigned char* pd = ( unsigned char* )( dst + ( nBlocks << 2 ) );
+
+        for ( unsigned int i = ( nPixels & 3 ) * 4; i > 0; --i )
+        {
+            *pd++ = ( unsigned char )( ( *p0++ * ( 256 - nWeight ) + *p1++ * nWeight ) >> 8 );
+        }
     }
 
 }
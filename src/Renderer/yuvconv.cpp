@@ -0,0 +1,333 @@
+/* Videoplayer_Plugin - for licensing and copyright see license.txt */
+
+#include <Renderer/yuvconv.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#endif
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define USE_SSE2 // use fast software conversion if available
+#endif
+
+namespace VideoplayerPlugin
+{
+    unsigned char* copyPlane( unsigned int cols, unsigned int lines, unsigned char* dst, unsigned int dstStride, unsigned char* src, unsigned int srcStride )
+    {
+        if ( srcStride == dstStride )
+        {
+            // source and destination paddings equal
+            memcpy( dst, src, srcStride * lines );
+            dst += srcStride * lines;
+        }
+
+        else
+        {
+            // source and destination paddings need to be converted
+            ++lines;
+
+            while ( --lines )
+            {
+                memcpy( dst, src, cols );
+                src += srcStride;
+                dst += dstStride;
+            }
+        }
+
+        return dst;
+    }
+
+    // create conditional parameter that resolves at compile time
+#define PARAMS uint32_t* dst, unsigned char r, unsigned char g, unsigned char b, unsigned char a, SAlphaGenParam& ap
+    template<eByteOrder COLOR_DST_FMT, eAlphaMode ALPHAMODE>
+    inline void write_pixel( PARAMS )
+    {};
+
+    template<> inline void write_pixel<VBO_RGBA, VAM_PASSTROUGH>( PARAMS )
+    {
+        *dst = ( ( ( a ) << 24 ) | ( ( b ) << 16 ) | ( ( g ) << 8 ) | ( r ) ); // RGBA (little endian)
+    }
+
+    template<> inline void write_pixel<VBO_BGRA, VAM_PASSTROUGH>( PARAMS )
+    {
+        write_pixel<VBO_RGBA, VAM_PASSTROUGH>( dst, b, g, r, a, ap );
+    }
+
+    template<> inline void write_pixel<VBO_RGBA, VAM_FILL>( PARAMS )
+    {
+        *dst = ( 0xff000000 | ( ( b ) << 16 ) | ( ( g ) << 8 ) | ( r ) ); // RGBX (little endian)
+    }
+
+    template<> inline void write_pixel<VBO_BGRA, VAM_FILL>( PARAMS )
+    {
+        write_pixel<VBO_RGBA, VAM_FILL>( dst, b, g, r, a, ap );
+    }
+
+    template<> inline void write_pixel<VBO_RGBA, VAM_FALLOF>( PARAMS )
+    {
+        if ( a <= ap.tolerance )
+        {
+            a = 0;
+        }
+
+        else if ( a >= ap.fallof )
+        {
+            a = 255;
+        }
+
+        else
+        {
+            a = a * ap.mull;
+        }
+
+        write_pixel<VBO_RGBA, VAM_PASSTROUGH>( dst, r, g, b, a, ap );
+    }
+
+    template<> inline void write_pixel<VBO_BGRA, VAM_FALLOF>( PARAMS )
+    {
+        write_pixel<VBO_RGBA, VAM_FALLOF>( dst, b, g, r, a, ap );
+    }
+
+    template<> inline void write_pixel<VBO_RGBA, VAM_COLORMASK>( PARAMS )
+    {
+        ap.temp2 = abs( ap.r - r );
+        ap.temp = ap.temp2 * ap.temp2 * ap.wr;
+        ap.temp2 = abs( ap.g - g );
+        ap.temp += ap.temp2 * ap.temp2 * ap.wg;
+        ap.temp2 = abs( ap.b - b );
+        ap.temp += ap.temp2 * ap.temp2 * ap.wb;
+        ap.temp /= ap.ws;
+
+        //ap.temp = (abs(ap.r - r) * ap.wr + abs(ap.g - g) * ap.wg + abs(ap.b - b) * ap.wb) / ap.ws;
+
+        a = ap.temp;
+        write_pixel<VBO_RGBA, VAM_FALLOF>( dst, r, g, b, a, ap );
+    }
+
+    template<> inline void write_pixel<VBO_BGRA, VAM_COLORMASK>( PARAMS )
+    {
+        write_pixel<VBO_RGBA, VAM_FALLOF>( dst, b, g, r, a, ap );
+    }
+
+#define SAT(x) ( ( x ) < 0 ? 0 : ( ( x ) > 255 ? 255 : ( x ) ) ) // Saturate
+
+#ifdef USE_SSE2
+    /**
+    * @brief Check once if the cpu supports SSE2
+    */
+    static bool hasSSE2()
+    {
+#if defined(_WIN32)
+        static const bool bSSE2 = ::IsProcessorFeaturePresent( PF_XMMI64_INSTRUCTIONS_AVAILABLE ) != FALSE;
+#elif defined(__SSE2__)
+        static const bool bSSE2 = true;
+#elif defined(__GNUC__) && ( defined(__i386__) || defined(__x86_64__) )
+        static const bool bSSE2 = __builtin_cpu_supports( "sse2" );
+#else
+        static const bool bSSE2 = false;
+#endif
+        return bSSE2;
+    }
+#endif
+
+    template<eByteOrder COLOR_DST_FMT, eAlphaMode ALPHAMODE>
+    void YV12_2_( unsigned char* y, unsigned char* u, unsigned char* v, unsigned char* a, unsigned int cols, unsigned int lines, uint32_t* dst, unsigned int dstStride, unsigned int srcStrideY, unsigned int srcStrideU, unsigned int srcStrideV, unsigned int srcStrideA, SAlphaGenParam& ap )
+    {
+#ifdef USE_SSE2
+
+        if ( hasSSE2() )
+        {
+            //SSE2 available
+            SSE2_YUV420_2_<COLOR_DST_FMT, ALPHAMODE>( y, u, v, a, srcStrideY, srcStrideV, srcStrideA, cols, lines, dst, dstStride, ap );
+            return;
+        }
+
+        //else slow fall back
+#endif
+
+        int Y;
+
+        int CY;
+        signed char CU;
+        signed char CV;
+
+        float fCY;
+        float fCV;
+        float fCUV;
+        float fCU;
+
+        float R;
+        float G;
+        float B;
+
+        unsigned int lcols;
+        uint32_t* ldst;
+        unsigned char* ly;
+        unsigned char* la;
+
+        uint32_t* ldst2;
+        unsigned char* ly2;
+        unsigned char* la2;
+
+        signed char* lu;
+        signed char* lv;
+
+        if ( !a )
+        {
+            // if alpha not available use luminance so I don't need another function
+            a = y;
+            srcStrideA = srcStrideY;
+        }
+
+        unsigned int srcStrideA2 = srcStrideA << 1;
+        unsigned int srcStrideY2 = srcStrideY << 1;
+        unsigned int dstStride2 = dstStride << 1;
+
+        cols >>= 1;
+        lines >>= 1;
+
+        ++lines;
+
+        while ( --lines )
+        {
+            ldst = dst;
+            ly = y;
+            la = a;
+
+            ldst2 = dst + dstStride;
+            ly2 = y   + srcStrideY;
+            la2 = a   + srcStrideA;
+
+            lu = ( signed char* )u;
+            lv = ( signed char* )v;
+
+            lcols = cols + 1;
+
+            while ( --lcols )
+            {
+                // process 4 pixels each time
+
+                // the UV values are valid for 4 pixel
+                CU = ( *lu ) - 128;
+                ++lu;
+                CV = ( *lv ) - 128;
+                ++lv;
+
+                fCV = 1.596f * CV;
+                fCUV = -0.391f * CU - 0.813f * CV;
+                fCU = 2.018f * CU;
+
+                // first line first col
+                Y = *ly;
+                ++ly;
+                CY = Y - 16;
+                fCY = 1.164f * CY;
+
+                R = fCY + fCV + 0.5f;
+                G = fCY + fCUV + 0.5f;
+                B = fCY + fCU + 0.5f;
+
+                write_pixel<COLOR_DST_FMT, ALPHAMODE>( ldst, SAT( R ), SAT( G ), SAT( B ), *la++, ap );
+                ++ldst;
+
+                // first line second col
+                Y = *ly;
+                ++ly;
+                CY = Y - 16;
+                fCY = 1.164f * CY;
+
+                R = fCY + fCV + 0.5f;
+                G = fCY + fCUV + 0.5f;
+                B = fCY + fCU + 0.5f;
+
+                write_pixel<COLOR_DST_FMT, ALPHAMODE>( ldst, SAT( R ), SAT( G ), SAT( B ), *la++, ap );
+                ++ldst;
+
+                // second line first col
+                Y = *ly2;
+                ++ly2;
+                CY = Y - 16;
+                fCY = 1.164f * CY;
+
+                R = fCY + fCV + 0.5f;
+                G = fCY + fCUV + 0.5f;
+                B = fCY + fCU + 0.5f;
+
+                write_pixel<COLOR_DST_FMT, ALPHAMODE>( ldst2,  SAT( R ), SAT( G ), SAT( B ), *la2++, ap );
+                ++ldst2;
+
+                // second line second col
+                Y = *ly2;
+                ++ly2;
+                CY = Y - 16;
+                fCY = 1.164f * CY;
+
+                R = fCY + fCV + 0.5f;
+                G = fCY + fCUV + 0.5f;
+                B = fCY + fCU + 0.5f;
+
+                write_pixel<COLOR_DST_FMT, ALPHAMODE>( ldst2, SAT( R ), SAT( G ), SAT( B ), *la2++, ap );
+                ++ldst2;
+            }
+
+            y += srcStrideY2;
+            a += srcStrideA2;
+
+            dst += dstStride2;
+            u += srcStrideU;
+            v += srcStrideV;
+        }
+    }
+
+    void YV12_2_RGB( eByteOrder eOrder, unsigned char* y, unsigned char* u, unsigned char* v, unsigned char* a, unsigned int cols, unsigned int lines, uint32_t* dst, unsigned int dstStride, unsigned int srcStrideY, unsigned int srcStrideU, unsigned int srcStrideV, unsigned int srcStrideA, SAlphaGenParam& ap )
+    {
+        if ( eOrder == VBO_RGBA )
+        {
+            if ( a )
+            {
+                YV12_2_<VBO_RGBA, VAM_PASSTROUGH>( y, u, v, a, cols, lines, dst, dstStride, srcStrideY, srcStrideU, srcStrideV, srcStrideA, ap );
+            }
+
+            else
+            {
+                YV12_2_<VBO_RGBA, VAM_FILL>( y, u, v, a, cols, lines, dst, dstStride, srcStrideY, srcStrideU, srcStrideV, srcStrideA, ap );
+            }
+        }
+
+        else
+        {
+            if ( a )
+            {
+                YV12_2_<VBO_BGRA, VAM_PASSTROUGH>( y, u, v, a, cols, lines, dst, dstStride, srcStrideY, srcStrideU, srcStrideV, srcStrideA, ap );
+            }
+
+            else
+            {
+                YV12_2_<VBO_BGRA, VAM_FILL>( y, u, v, a, cols, lines, dst, dstStride, srcStrideY, srcStrideU, srcStrideV, srcStrideA, ap );
+            }
+        }
+    }
+
+    void blendRGB( uint32_t* dst, const uint32_t* src0, const uint32_t* src1, unsigned int nPixels, unsigned int nWeight )
+    {
+#ifdef USE_SSE2
+
+        if ( hasSSE2() )
+        {
+            SSE2_blendRGB( dst, src0, src1, nPixels, nWeight );
+            return;
+        }
+
+#endif
+
+        const unsigned char* p0 = ( const unsigned char* )src0;
+        const unsigned char* p1 = ( const unsigned char* )src1;
+        unsigned char* pd = ( unsigned char* )dst;
+        unsigned int nInverse = 256 - nWeight;
+
+        for ( unsigned int i = nPixels * 4; i > 0; --i )
+        {
+            *pd++ = ( unsigned char )( ( *p0++ * nInverse + *p1++ * nWeight ) >> 8 );
+        }
+    }
+}
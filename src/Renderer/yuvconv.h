@@ -0,0 +1,92 @@
+/* Videoplayer_Plugin - for licensing and copyright see license.txt */
+
+#include "stdint.h"
+#include "stdlib.h"
+#include <string.h>
+
+#pragma once
+
+// Engine independent YV12 conversion kernels (used by the video renderers and the standalone decode library)
+
+namespace VideoplayerPlugin
+{
+    /**
+    * @brief byte order of the texture
+    */
+    enum eByteOrder
+    {
+        VBO_RGBA, //!< DX11 byte order
+        VBO_BGRA, //!< DX9 byte order
+    };
+
+    /**
+    * @brief this is a work in progress
+    */
+    enum eAlphaMode
+    {
+        VAM_FILL, //!< set alpha to 255
+        VAM_PASSTROUGH, //!< write alpha channel as it is
+        VAM_FALLOF, //!<  modify alpha channel using a fallof effect // TODO
+        VAM_COLORMASK //!< create alpha channel based on RGB channel // TODO
+    };
+
+    /**
+    * @brief this is a work in progress
+    */
+    typedef struct SAlphaGenParam_
+    {
+        SAlphaGenParam_()
+        {
+            r = 54;
+            g = 198;
+            b = 43;
+
+            ws = r + g + b;
+            wr = 1 << 8; //(r << 8) / ws;
+            wg = 1 << 8; //(g << 8) / ws;
+            wb = 1 << 8; //(b << 8) / ws;
+            ws = wr + wg + wb;
+            ws *= ws;
+
+            fallof = 50;
+            tolerance = 40;
+            diff = fallof - tolerance;
+            mull = 255 / diff;
+        }
+
+        int r, g, b; // colormask
+        int wr, wg, wb, ws; // color weights
+        int temp;
+        int temp2;
+        int fallof;
+        int tolerance;
+        int diff;
+        int mull;
+    } SAlphaGenParam;
+
+    unsigned char*  copyPlane( unsigned int cols, unsigned int lines, unsigned char* dst, unsigned int dstStride, unsigned char* src, unsigned int srcStride );
+
+    template<eByteOrder COLOR_DST_FMT, eAlphaMode ALPHAMODE>
+    void YV12_2_( unsigned char* y, unsigned char* u, unsigned char* v, unsigned char* a, unsigned int cols, unsigned int lines, uint32_t* dst, unsigned int dstStride, unsigned int srcStrideY, unsigned int srcStrideU, unsigned int srcStrideV, unsigned int srcStrideA, SAlphaGenParam& ap );
+
+    /**
+    * @brief Convert a YV12 image to 32 bit RGB with the byte order chosen at runtime
+    * @param a alpha plane or NULL (alpha is filled)
+    */
+    void YV12_2_RGB( eByteOrder eOrder, unsigned char* y, unsigned char* u, unsigned char* v, unsigned char* a, unsigned int cols, unsigned int lines, uint32_t* dst, unsigned int dstStride, unsigned int srcStrideY, unsigned int srcStrideU, unsigned int srcStrideV, unsigned int srcStrideA, SAlphaGenParam& ap );
+
+    template<eByteOrder COLOR_DST_FMT, eAlphaMode ALPHAMODE>
+    void SSE2_YUV420_2_( uint8_t* yp, uint8_t* up, uint8_t* vp, uint8_t* yap,
+                         uint32_t sy, uint32_t suv, uint32_t sa,
+                         int width, int height,
+                         uint32_t* rgb, uint32_t srgb, SAlphaGenParam& ap );
+
+    /**
+    * @brief Crossfade two converted 32 bit images: dst = src0 + (src1 - src0) * weight / 256 for each channel
+    * @param nPixels pixels of each image (same layout)
+    * @param nWeight weight of src1 (0-256)
+    */
+    void blendRGB( uint32_t* dst, const uint32_t* src0, const uint32_t* src1, unsigned int nPixels, unsigned int nWeight );
+
+    void SSE2_blendRGB( uint32_t* dst, const uint32_t* src0, const uint32_t* src1, unsigned int nPixels, unsigned int nWeight );
+}
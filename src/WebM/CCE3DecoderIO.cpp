@@ -0,0 +1,387 @@
+/* Videoplayer_Plugin - for licensing and copyright see license.txt */
+
+#include <StdAfx.h>
+#include <CPluginVideoplayer.h>
+#include <WebM/CCE3DecoderIO.h>
+#include <ICryPak.h>
+
+namespace VideoplayerPlugin
+{
+    CCE3DecoderIO gCE3DecoderIO;
+
+    string CCE3DecoderIO::GetFileKey( const char* sFile )
+    {
+        string sKey = sFile;
+        sKey.replace( '\\', '/' );
+        sKey.MakeLower();
+        return sKey;
+    }
+
+    CCE3DecoderIO::CCE3DecoderIO()
+    {
+        m_nPrefetchedBytes = 0;
+    }
+
+    bool CCE3DecoderIO::Prefetch( const char* sFile, size_t nBudget )
+    {
+        string sKey = GetFileKey( sFile );
+
+        {
+            Concurrency::critical_section::scoped_lock lock( m_csPrefetched );
+
+            if ( m_mapPrefetched.find( sKey ) != m_mapPrefetched.end() )
+            {
+                return true;
+            }
+        }
+
+        // pipes are live and can't be read ahead
+        if ( _strnicmp( sFile, "\\\\.\\pipe\\", 9 ) == 0 )
+        {
+            return false;
+        }
+
+        FILE* pFile = gEnv->pCryPak->FOpen( sFile, "rb" );
+
+        if ( !pFile )
+        {
+            return false;
+        }
+
+        SPrefetchedFile* pData = NULL;
+        size_t nSize = gEnv->pCryPak->FGetSize( pFile );
+
+        if ( nSize > 0 && m_nPrefetchedBytes + nSize <= nBudget )
+        {
+            pData = new SPrefetchedFile();
+            pData->vecData.resize( nSize );
+            pData->nRefs = 0;
+            pData->bDropped = false;
+
+            if ( gEnv->pCryPak->FReadRaw( &pData->vecData[0], 1, nSize, pFile ) != nSize )
+            {
+                SAFE_DELETE( pData );
+            }
+        }
+
+        gEnv->pCryPak->FClose( pFile );
+
+        if ( !pData )
+        {
+            return false;
+        }
+
+        Concurrency::critical_section::scoped_lock lock( m_csPrefetched );
+        m_mapPrefetched[sKey] = pData;
+        m_nPrefetchedBytes += nSize;
+
+        return true;
+    }
+
+    void CCE3DecoderIO::ClearPrefetched()
+    {
+        Concurrency::critical_section::scoped_lock lock( m_csPrefetched );
+
+        for ( std::map<string, SPrefetchedFile*>::iterator iter = m_mapPrefetched.begin(); iter != m_mapPrefetched.end(); ++iter )
+        {
+            if ( iter->second->nRefs > 0 )
+            {
+                iter->second->bDropped = true;
+            }
+
+            else
+            {
+                m_nPrefetchedBytes -= min( iter->second->vecData.size(), m_nPrefetchedBytes );
+                delete iter->second;
+            }
+        }
+
+        m_mapPrefetched.clear();
+    }
+
+    void CCE3DecoderIO::ReleasePrefetched( const char* sFile )
+    {
+        Concurrency::critical_section::scoped_lock lock( m_csPrefetched );
+
+        if ( m_mapPrefetched.empty() || !sFile )
+        {
+            return;
+        }
+
+        std::map<string, SPrefetchedFile*>::iterator iter = m_mapPrefetched.find( GetFileKey( sFile ) );
+
+        if ( iter == m_mapPrefetched.end() )
+        {
+            return;
+        }
+
+        if ( iter->second->nRefs > 0 )
+        {
+            iter->second->bDropped = true;
+        }
+
+        else
+        {
+            m_nPrefetchedBytes -= min( iter->second->vecData.size(), m_nPrefetchedBytes );
+            delete iter->second;
+        }
+
+        m_mapPrefetched.erase( iter );
+    }
+
+    FILE* CCE3DecoderIO::OpenPrefetched( const char* sFile )
+    {
+        Concurrency::critical_section::scoped_lock lock( m_csPrefetched );
+
+        if ( m_mapPrefetched.empty() )
+        {
+            return NULL;
+        }
+
+        std::map<string, SPrefetchedFile*>::iterator iter = m_mapPrefetched.find( GetFileKey( sFile ) );
+
+        if ( iter == m_mapPrefetched.end() )
+        {
+            return NULL;
+        }
+
+        SMemoryFile* pMemory = new SMemoryFile();
+        pMemory->pFile = iter->second;
+        pMemory->nPos = 0;
+        pMemory->bEof = false;
+        ++pMemory->pFile->nRefs;
+
+        FILE* pFile = ( FILE* )pMemory;
+        m_setMemoryFiles.insert( pFile );
+
+        return pFile;
+    }
+
+    CCE3DecoderIO::SMemoryFile* CCE3DecoderIO::GetMemoryFile( FILE* pFile )
+    {
+        Concurrency::critical_section::scoped_lock lock( m_csPrefetched );
+        return !m_setMemoryFiles.empty() && m_setMemoryFiles.find( pFile ) != m_setMemoryFiles.end() ? ( SMemoryFile* )pFile : NULL;
+    }
+
+    FILE* CCE3DecoderIO::Open( const char* sFile, const char* sMode )
+    {
+        // local pipes of live inputs aren't part of the file system
+        if ( _strnicmp( sFile, "\\\\.\\pipe\\", 9 ) == 0 )
+        {
+            FILE* pFile = getVPXDecStdIO()->Open( sFile, sMode );
+
+            if ( pFile )
+            {
+                Concurrency::critical_section::scoped_lock lock( m_csPipes );
+                m_setPipes.insert( pFile );
+            }
+
+            return pFile;
+        }
+
+        // files read ahead during level loading
+        if ( sMode && sMode[0] == 'r' )
+        {
+            FILE* pFile = OpenPrefetched( sFile );
+
+            if ( pFile )
+            {
+                return pFile;
+            }
+        }
+
+        return gEnv->pCryPak->FOpen( sFile, sMode );
+    }
+
+    size_t CCE3DecoderIO::Read( void* pData, size_t nSize, size_t nCount, FILE* pFile )
+    {
+        if ( IsPipe( pFile ) )
+        {
+            return getVPXDecStdIO()->Read( pData, nSize, nCount, pFile );
+        }
+
+        SMemoryFile* pMemory = GetMemoryFile( pFile );
+
+        if ( pMemory )
+        {
+            const std::vector<uint8>& vecData = pMemory->pFile->vecData;
+            size_t nRead = min( nSize * nCount, vecData.size() - min( pMemory->nPos, vecData.size() ) );
+
+            if ( nRead > 0 )
+            {
+                memcpy( pData, &vecData[pMemory->nPos], nRead );
+            }
+
+            pMemory->nPos += nRead;
+            pMemory->bEof = nRead < nSize * nCount;
+            return nSize ? nRead / nSize : 0;
+        }
+
+        return gEnv->pCryPak->FReadRaw( pData, nSize, nCount, pFile );
+    }
+
+    int CCE3DecoderIO::Seek( FILE* pFile, long nOffset, int nMode )
+    {
+        if ( IsPipe( pFile ) )
+        {
+            return getVPXDecStdIO()->Seek( pFile, nOffset, nMode );
+        }
+
+        SMemoryFile* pMemory = GetMemoryFile( pFile );
+
+        if ( pMemory )
+        {
+            long nBase = nMode == SEEK_CUR ? long( pMemory->nPos ) : nMode == SEEK_END ? long( pMemory->pFile->vecData.size() ) : 0;
+
+            if ( nBase + nOffset < 0 )
+            {
+                return -1;
+            }
+
+            pMemory->nPos = size_t( nBase + nOffset );
+            pMemory->bEof = false;
+            return 0;
+        }
+
+        return gEnv->pCryPak->FSeek( pFile, nOffset, nMode );
+    }
+
+    long CCE3DecoderIO::Tell( FILE* pFile )
+    {
+        if ( IsPipe( pFile ) )
+        {
+            return getVPXDecStdIO()->Tell( pFile );
+        }
+
+        SMemoryFile* pMemory = GetMemoryFile( pFile );
+
+        if ( pMemory )
+        {
+            return long( pMemory->nPos );
+        }
+
+        return gEnv->pCryPak->FTell( pFile );
+    }
+
+    int CCE3DecoderIO::Eof( FILE* pFile )
+    {
+        if ( IsPipe( pFile ) )
+        {
+            return getVPXDecStdIO()->Eof( pFile );
+        }
+
+        SMemoryFile* pMemory = GetMemoryFile( pFile );
+
+        if ( pMemory )
+        {
+            return pMemory->bEof ? 1 : 0;
+        }
+
+        return gEnv->pCryPak->FEof( pFile );
+    }
+
+    int CCE3DecoderIO::Error( FILE* pFile )
+    {
+        if ( IsPipe( pFile ) )
+        {
+            return getVPXDecStdIO()->Error( pFile );
+        }
+
+        if ( GetMemoryFile( pFile ) )
+        {
+            return 0;
+        }
+
+        return gEnv->pCryPak->FError( pFile );
+    }
+
+    int CCE3DecoderIO::Close( FILE* pFile )
+    {
+        if ( IsPipe( pFile ) )
+        {
+            {
+                Concurrency::critical_section::scoped_lock lock( m_csPipes );
+                m_setPipes.erase( pFile );
+            }
+
+            return getVPXDecStdIO()->Close( pFile );
+        }
+
+        {
+            Concurrency::critical_section::scoped_lock lock( m_csPrefetched );
+
+            if ( m_setMemoryFiles.erase( pFile ) )
+            {
+                SMemoryFile* pMemory = ( SMemoryFile* )pFile;
+
+                // the last handle of a dropped file frees its data
+                if ( --pMemory->pFile->nRefs <= 0 && pMemory->pFile->bDropped )
+                {
+                    m_nPrefetchedBytes -= min( pMemory->pFile->vecData.size(), m_nPrefetchedBytes );
+                    delete pMemory->pFile;
+                }
+
+                delete pMemory;
+                return 0;
+            }
+        }
+
+        return gEnv->pCryPak->FClose( pFile );
+    }
+
+    size_t CCE3DecoderIO::ReadAvailable( void* pData, size_t nSize, FILE* pFile )
+    {
+        if ( IsPipe( pFile ) )
+        {
+            return getVPXDecStdIO()->ReadAvailable( pData, nSize, pFile );
+        }
+
+        // prefetched files don't grow
+        if ( GetMemoryFile( pFile ) )
+        {
+            return Read( pData, 1, nSize, pFile );
+        }
+
+        size_t nRead = gEnv->pCryPak->FReadRaw( pData, 1, nSize, pFile );
+
+        // a growing file only reached the end for now (seeking clears the end of file state)
+        if ( nRead < nSize )
+        {
+            gEnv->pCryPak->FSeek( pFile, 0, SEEK_CUR );
+        }
+
+        return nRead;
+    }
+
+    bool CCE3DecoderIO::IsPipe( FILE* pFile )
+    {
+        Concurrency::critical_section::scoped_lock lock( m_csPipes );
+        return !m_setPipes.empty() && m_setPipes.find( pFile ) != m_setPipes.end();
+    }
+
+    bool CCE3DecoderIO::IsAvailable()
+    {
+        return gEnv->pSystem && !gEnv->pSystem->IsQuitting();
+    }
+
+    void CCE3DecoderIO::LogV( eVPXDecLogLevel eLevel, const char* sFormat, va_list args )
+    {
+        char sMessage[1024];
+        vsnprintf( sMessage, sizeof( sMessage ), sFormat, args );
+        sMessage[sizeof( sMessage ) - 1] = 0;
+
+        switch ( eLevel )
+        {
+            case VLL_INFO:
+                gPlugin->LogAlways( "%s", sMessage );
+                break;
+
+            case VLL_WARNING:
+                gPlugin->LogWarning( "%s", sMessage );
+                break;
+
+            default:
+                gPlugin->LogError( "%s", sMessage );
+        }
+    }
+}
@@ -0,0 +1,120 @@
+/* Videoplayer_Plugin - for licensing and copyright see license.txt */
+
+#include <WebM/vpxdec_io.h>
+#include <set>
+#include <map>
+#include <vector>
+#include <concrt.h>
+
+#pragma once
+
+namespace VideoplayerPlugin
+{
+    /**
+    * @brief Binds the decoder to CryEngine
+    * Files are read through the CryPak (pak file support) and messages go to the plugin log.
+    * Local pipes (\\.\pipe\name) of live inputs bypass the CryPak.
+    * Files prefetched during level loading are read from memory.
+    */
+    class CCE3DecoderIO :
+        public IVPXDecIO,
+        public IVPXDecLog
+    {
+        public:
+            CCE3DecoderIO();
+
+            /**
+            * @brief Case and separator independent key of a file path
+            */
+            static string GetFileKey( const char* sFile );
+
+            /**
+            * @brief Read a file into memory, following opens read it from there
+            * @param sFile file
+            * @param nBudget bytes all prefetched files may use
+            * @return prefetched (also if it already was)
+            */
+            bool Prefetch( const char* sFile, size_t nBudget );
+
+            /**
+            * @brief Drop all prefetched files (files still open keep their data until they are closed)
+            */
+            void ClearPrefetched();
+
+            /**
+            * @brief Drop a prefetched file once its video opened it, the open handles keep the data until they are closed
+            * @param sFile file
+            */
+            void ReleasePrefetched( const char* sFile );
+
+            /**
+            * @brief Bytes held by the prefetched files (dropped files still open included)
+            */
+            size_t GetPrefetchedBytes()
+            {
+                return m_nPrefetchedBytes;
+            };
+
+            // IVPXDecIO
+            virtual FILE* Open( const char* sFile, const char* sMode );
+            virtual size_t Read( void* pData, size_t nSize, size_t nCount, FILE* pFile );
+            virtual int Seek( FILE* pFile, long nOffset, int nMode );
+            virtual long Tell( FILE* pFile );
+            virtual int Eof( FILE* pFile );
+            virtual int Error( FILE* pFile );
+            virtual int Close( FILE* pFile );
+            virtual size_t ReadAvailable( void* pData, size_t nSize, FILE* pFile );
+            virtual bool IsAvailable();
+
+            // IVPXDecLog
+            virtual void LogV( eVPXDecLogLevel eLevel, const char* sFormat, va_list args );
+
+        private:
+            std::set<FILE*> m_setPipes; //!< open local pipes
+            Concurrency::critical_section m_csPipes; //!< decoders of the reverse playback read on workers
+
+            /**
+            * @brief Was the file opened as local pipe
+            */
+            bool IsPipe( FILE* pFile );
+
+            /**
+            * @brief Content of a prefetched file
+            */
+            struct SPrefetchedFile
+            {
+                std::vector<uint8> vecData;
+                int nRefs; //!< open handles
+                bool bDropped; //!< deleted once the last handle is closed
+            };
+
+            /**
+            * @brief Open handle of a prefetched file
+            */
+            struct SMemoryFile
+            {
+                SPrefetchedFile* pFile;
+                size_t nPos; //!< read position
+                bool bEof; //!< a read hit the end
+            };
+
+            std::map<string, SPrefetchedFile*> m_mapPrefetched; //!< prefetched files by normalized path
+            std::set<FILE*> m_setMemoryFiles; //!< open handles of prefetched files (SMemoryFile)
+            size_t m_nPrefetchedBytes; //!< bytes of the prefetched files, dropped ones count until their last handle is closed
+            Concurrency::critical_section m_csPrefetched; //!< decoders of the reverse playback read on workers
+
+            /**
+            * @brief Open a prefetched file
+            * @return NULL if it isn't prefetched
+            */
+            FILE* OpenPrefetched( const char* sFile );
+
+            /**
+            * @brief Handle of a prefetched file
+            * @return NULL if the file wasn't opened from memory
+            */
+            SMemoryFile* GetMemoryFile( FILE* pFile );
+    };
+
+    extern CCE3DecoderIO gCE3DecoderIO; //!< installed by the plugin on init
+}
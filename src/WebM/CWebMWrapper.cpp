@@ -18,6 +18,7 @@ namespace VideoplayerPlugin
         m_bSkipping = false;
         m_bPaused = true;
         m_nVideoId = nVideoId;
+        m_decoder.m_nTraceTag = nVideoId;
         m_fSpeed = 1;
         m_nWidth = 0;
         m_nHeight = 0;
@@ -26,7 +27,99 @@ namespace VideoplayerPlugin
         m_eTS = VTS_Default;
         m_eDM = VDM_Default;
 
+        m_eVP = VVP_Default;
+        m_nLastVisibleFrame = 0;
+        m_bVisible = true;
+        m_bHiddenPaused = false;
+        m_bHiddenClock = false;
+        m_ePriority = VPR_Default;
+
+        m_nLast2DFrame = 0;
+        m_fDistance = -1;
+        m_fDecimationScale = 1;
+        m_nDecimation = 1;
+        m_nDecimationCounter = 0;
+        m_nFramesDecimated = 0;
+        m_fDecodeTime = 0;
+        m_fConvertTime = 0;
+
+        m_fFramePeriod = 0;
+        m_pAheadImg = NULL;
+        m_fAheadPos = 0;
+        m_nFramesPresented = 0;
+        m_nFramesEarly = 0;
+        m_nFramesLate = 0;
+        m_nFramesDropped = 0;
+
+        m_bPrepared = false;
+        m_bPreparing = false;
+        m_bStartPending = false;
+
+        m_fClockError = 0;
+        m_fClockErrorMax = 0;
+        m_nClockSynced = 0;
+        m_nClockResyncs = 0;
+
+        m_statDecode.Reset();
+        m_statConvert.Reset();
+        m_statUpload.Reset();
+        m_statClock.Reset();
+        m_nSeeks = 0;
+
+        m_bHibernating = false;
+        m_fIdleSince = 0;
+        m_fHibernatePos = 0;
+        m_bHibernateLoop = false;
+        m_fHibernateStart = 0;
+        m_fHibernateEnd = 0;
+        m_fHibernateDuration = 0;
+        m_nHibernations = 0;
+
+        m_bTrickMode = false;
+        m_nTrickFrames = 0;
+
+        m_bReverse = false;
+        m_bReverseStart = false;
+        m_nReverseFront = 0;
+        m_bReversePrefetching = false;
+        m_fReversePrefetchEnd = 0;
+        m_nReverseBudget = 0;
+        m_nReversePrefetched = 0;
+        m_pReverseImg = NULL;
+        m_nReverseFrames = 0;
+        m_nReverseDecoded = 0;
+        m_nReverseStalls = 0;
+
+        m_bLoopWorking = false;
+        m_nLoopCached = 0;
+        m_nLoopReserved = 0;
+        m_fLoopResume = -1;
+        m_bLoopWrapped = false;
+        m_pLoopImg = NULL;
+        m_nLoopWraps = 0;
+        m_nLoopStalls = 0;
+        m_fLoopStart = 0;
+        m_fLoopEnd = 0;
+        m_fLoopDuration = 0;
+        m_fLoopFPS = 0;
+        m_nLoopWidth = 0;
+        m_nLoopHeight = 0;
+        m_nLoopMemory = 0;
+        m_nLoopBytesRead = 0;
+        m_nLoopFramesDecoded = 0;
+        m_nLoopFramesSkipped = 0;
+
+        m_bLiveCatchup = false;
+        m_fLiveOffset = 0;
+        m_fLiveLag = 0;
+        m_nLiveFramesRead = 0;
+        m_nLiveFrames = 0;
+        m_nLiveCatchups = 0;
+        m_fLiveLatencySum = 0;
+        m_fLiveLatencyMax = 0;
+
         m_VRenderer = NULL;
+        m_bRendererReused = false;
     }
 
     CWebMWrapper::~CWebMWrapper()
@@ -38,6 +131,59 @@ namespace VideoplayerPlugin
     void CWebMWrapper::Close()
     {
         m_bPaused = true;
+        StopReverse();
+        StopLoop();
+
+        if ( m_bLoopWorking )
+        {
+            m_evLoop.wait();
+            m_bLoopWorking = false;
+        }
+
+        m_LoopCache.close();
+        gVideoplayerSystem->ReleaseLoopBudget( m_nLoopReserved );
+        m_nLoopReserved = 0;
+
+        if ( m_nFramesDecimated > 0 )
+        {
+            gPlugin->LogAlways( "Decimation id(%d) frames(%u) skipped decodes(%u) saved(%.2fms)", m_nVideoId, m_nFramesDecimated, m_decoder.m_nDecodesSkipped, ( m_nFramesDecimated * m_fConvertTime + m_decoder.m_nDecodesSkipped * m_fDecodeTime ) * MILLISECOND );
+        }
+
+        if ( m_nFramesPresented > 0 )
+        {
+            gPlugin->LogAlways( "Schedule id(%d) presented(%u) early(%u) late(%u) dropped(%u)", m_nVideoId, m_nFramesPresented, m_nFramesEarly, m_nFramesLate, m_nFramesDropped );
+        }
+
+        if ( m_nLoopWraps > 0 )
+        {
+            gPlugin->LogAlways( "Loop id(%d) seamless(%u) cached(%d) stalls(%u)", m_nVideoId, m_nLoopWraps, m_nLoopCached, m_nLoopStalls );
+        }
+
+        if ( m_nReverseFrames > 0 )
+        {
+            gPlugin->LogAlways( "Reverse id(%d) frames(%u) decoded(%u) prefetch stalls(%u)", m_nVideoId, m_nReverseFrames, m_nReverseDecoded, m_nReverseStalls );
+        }
+
+        if ( m_nTrickFrames > 0 )
+        {
+            gPlugin->LogAlways( "Trick id(%d) keyframes(%u) skipped decodes(%u)", m_nVideoId, m_nTrickFrames, m_decoder.m_nDecodesSkipped );
+        }
+
+        if ( m_nClockSynced > 0 )
+        {
+            gPlugin->LogAlways( "Clock id(%d) synced(%u) resyncs(%u) max error(%.2fms)", m_nVideoId, m_nClockSynced, m_nClockResyncs, m_fClockErrorMax * MILLISECOND );
+        }
+
+        if ( m_nLiveFrames > 0 )
+        {
+            gPlugin->LogAlways( "Live id(%d) frames(%u) presented(%u) skipped droppable(%u) catchups(%u) latency avg(%.2fms) max(%.2fms)", m_nVideoId, m_nLiveFramesRead, m_nLiveFrames, m_decoder.m_nLiveSkipped, m_nLiveCatchups,
+                                m_fLiveLatencySum / m_nLiveFrames * MILLISECOND, m_fLiveLatencyMax * MILLISECOND );
+        }
+
+        if ( m_nHibernations > 0 )
+        {
+            gPlugin->LogAlways( "Hibernate id(%d) times(%u)", m_nVideoId, m_nHibernations );
+        }
 
         m_Sound.Close();
 
@@ -47,11 +193,96 @@ namespace VideoplayerPlugin
 #endif
         m_bSkipping = false;
         m_bSkippable = true;
+
+        m_vecVisibilityEntities.clear();
+        m_bHiddenPaused = false;
+        m_bHiddenClock = false;
+
+        m_fDistance = -1;
+        m_nDecimation = 1;
+        m_nDecimationCounter = 0;
+        m_nFramesDecimated = 0;
+
+        m_fFramePeriod = 0;
+        m_pAheadImg = NULL;
+        m_fAheadPos = 0;
+        m_nFramesPresented = 0;
+        m_nFramesEarly = 0;
+        m_nFramesLate = 0;
+        m_nFramesDropped = 0;
+
+        m_bPrepared = false;
+        m_bPreparing = false;
+        m_bStartPending = false;
+
+        m_fClockError = 0;
+        m_fClockErrorMax = 0;
+        m_nClockSynced = 0;
+        m_nClockResyncs = 0;
+
+        m_statDecode.Reset();
+        m_statConvert.Reset();
+        m_statUpload.Reset();
+        m_statClock.Reset();
+        m_nSeeks = 0;
+
+        m_bHibernating = false;
+        m_fIdleSince = 0;
+        m_fHibernatePos = 0;
+        m_bHibernateLoop = false;
+        m_fHibernateStart = 0;
+        m_fHibernateEnd = 0;
+        m_fHibernateDuration = 0;
+        m_nHibernations = 0;
+
+        m_bTrickMode = false;
+        m_nTrickFrames = 0;
+
+        m_bReverse = false;
+        m_bReverseStart = false;
+        m_nReverseFront = 0;
+        m_bReversePrefetching = false;
+        m_fReversePrefetchEnd = 0;
+        m_nReverseBudget = 0;
+        m_nReversePrefetched = 0;
+        m_pReverseImg = NULL;
+        m_nReverseFrames = 0;
+        m_nReverseDecoded = 0;
+        m_nReverseStalls = 0;
+
+        m_bLoopWorking = false;
+        m_nLoopCached = 0;
+        m_nLoopReserved = 0;
+        m_fLoopResume = -1;
+        m_bLoopWrapped = false;
+        m_pLoopImg = NULL;
+        m_nLoopWraps = 0;
+        m_nLoopStalls = 0;
+        m_fLoopStart = 0;
+        m_fLoopEnd = 0;
+        m_fLoopDuration = 0;
+        m_fLoopFPS = 0;
+        m_nLoopWidth = 0;
+        m_nLoopHeight = 0;
+        m_nLoopMemory = 0;
+        m_nLoopBytesRead = 0;
+        m_nLoopFramesDecoded = 0;
+        m_nLoopFramesSkipped = 0;
+
+        m_bLiveCatchup = false;
+        m_fLiveOffset = 0;
+        m_fLiveLag = 0;
+        m_nLiveFramesRead = 0;
+        m_nLiveFrames = 0;
+        m_nLiveCatchups = 0;
+        m_fLiveLatencySum = 0;
+        m_fLiveLatencyMax = 0;
     }
 
     bool CWebMWrapper::ReleaseResources( bool bResetOverride )
     {
         gVideoplayerSystem->RestoreMaterials( this, bResetOverride ); // restore materials using this video
+        m_fDecimationScale = 1; // recollected when the overrides are applied again
 
         SAFE_RELEASE( m_VRenderer );
         m_iCE3Tex = 0;
@@ -66,19 +297,26 @@ namespace VideoplayerPlugin
     bool CWebMWrapper::CreateResources()
     {
         // needed for 2d placement
-        m_nRendererWidth = gEnv->pRenderer->GetWidth();
-        m_nRendererHeight = gEnv->pRenderer->GetHeight();
+        m_nRendererWidth = gEnv->pRenderer ? gEnv->pRenderer->GetWidth() : 0;
+        m_nRendererHeight = gEnv->pRenderer ? gEnv->pRenderer->GetHeight() : 0;
+
+        // new outputs get some frames to become visible
+        m_nLastVisibleFrame = GetFrameId();
 
         // release old data
         m_pCE3Tex = NULL;
         SAFE_RELEASE( m_VRenderer );
 
-        // create new data
-        if ( m_VRenderer = createVideoRenderer( VRT_AUTO ) )
+        // create new data (or reuse pooled data of the same size)
+        if ( m_VRenderer = acquireVideoRenderer( VRT_AUTO, m_decoder.m_nWidth, m_decoder.m_nHeight, m_nWidth, m_nHeight, m_bRendererReused ) )
         {
-            if ( m_VRenderer->CreateResources( m_decoder.m_nWidth, m_decoder.m_nHeight, m_nWidth, m_nHeight ) )
+            m_VRenderer->SetTraceTag( m_nVideoId );
+            m_pCE3Tex = reinterpret_cast<ITexture*>( m_VRenderer->GetRenderTarget( VRT_CE3 ) );
+
+            // conversion only, there is nothing to override
+            if ( m_VRenderer->GetRendererType() == VRT_NULL )
             {
-                m_pCE3Tex = reinterpret_cast<ITexture*>( m_VRenderer->GetRenderTarget( VRT_CE3 ) );
+                return true;
             }
         }
 
@@ -100,6 +338,176 @@ namespace VideoplayerPlugin
         return false;
     }
 
+    size_t CWebMWrapper::GetMemoryUsage( size_t& nDecoder, size_t& nStaging, size_t& nTexture )
+    {
+        nDecoder = ( IsLoopResuming() ? m_nLoopMemory : m_decoder.getMemoryUsage() ) + m_LoopCache.getBytes() + m_ReverseCache[0].getBytes() + m_ReverseCache[1].getBytes();
+        nStaging = 0;
+        nTexture = 0;
+
+        if ( m_VRenderer )
+        {
+            m_VRenderer->GetMemoryUsage( nStaging, nTexture );
+        }
+
+        return nDecoder + nStaging + nTexture;
+    }
+
+    float CWebMWrapper::GetIdleTime()
+    {
+        // live inputs can't return to their position
+        if ( m_bHibernating || !m_VRenderer || !m_decoder.isOpen() || IsLive() )
+        {
+            return -1;
+        }
+
+        // without the texture only tracked entities tell when a hidden video becomes visible again
+        if ( !m_bPaused && !( m_bHiddenPaused && !m_vecVisibilityEntities.empty() ) )
+        {
+            return -1;
+        }
+
+        float fNow = gEnv->pTimer->GetAsyncCurTime();
+
+        // paused videos can still show their last frame (hidden ones are checked by Advance)
+        if ( m_bPaused )
+        {
+            UpdateVisibility();
+        }
+
+        if ( m_bVisible )
+        {
+            m_fIdleSince = fNow;
+            return -1;
+        }
+
+        return fNow - m_fIdleSince;
+    }
+
+    bool CWebMWrapper::Crossfade( CWebMWrapper* pSource, float fWeight )
+    {
+        if ( !m_VRenderer )
+        {
+            return false;
+        }
+
+        if ( pSource )
+        {
+            pSource->m_nLastVisibleFrame = max( pSource->m_nLastVisibleFrame, m_nLastVisibleFrame );
+            pSource->m_nLast2DFrame = max( pSource->m_nLast2DFrame, m_nLast2DFrame );
+        }
+
+        return m_VRenderer->SetBlendSource( pSource ? pSource->m_VRenderer : NULL, fWeight );
+    }
+
+    bool CWebMWrapper::Prepare()
+    {
+        if ( m_bPrepared || !m_bPaused || m_bHibernating || !m_VRenderer || !m_decoder.isOpen() || IsLive() || m_decoder.m_nFramesDecoded > 0 )
+        {
+            return m_bPrepared;
+        }
+
+        VPXDEC_TRACE( "Prepare", m_nVideoId );
+
+        vpx_image_t* img = NULL;
+        bool bDirty = false;
+
+        // the start event would resume the video, it is dispatched by Resume instead
+        m_bPreparing = true;
+        bool bRead = m_decoder.readFrame( &img, bDirty ) == EXIT_SUCCESS && img && bDirty;
+        m_bPreparing = false;
+
+        if ( bRead )
+        {
+            m_VRenderer->RenderFrame( img );
+            m_bPrepared = true;
+        }
+
+#if defined(_DEBUG)
+        gPlugin->LogAlways( "Prepare id(%d) video(%.2fs) %s", m_nVideoId, m_decoder.getPosition(), bRead ? "ready" : "failed" );
+#endif
+        return m_bPrepared;
+    }
+
+    bool CWebMWrapper::Hibernate()
+    {
+        if ( m_bHibernating || !m_decoder.isOpen() || IsLive() )
+        {
+            return false;
+        }
+
+        size_t nDecoder, nStaging, nTexture;
+        size_t nBytes = GetMemoryUsage( nDecoder, nStaging, nTexture );
+        float fPos = GetPosition();
+
+        // workers use the decoder and the frame caches
+        StopReverse();
+        StopLoop();
+
+        if ( m_bLoopWorking )
+        {
+            m_evLoop.wait();
+            m_bLoopWorking = false;
+        }
+
+        m_LoopCache.close();
+        gVideoplayerSystem->ReleaseLoopBudget( m_nLoopReserved );
+        m_nLoopReserved = 0;
+        m_nLoopCached = 0;
+        m_fLoopResume = -1;
+        m_pAheadImg = NULL;
+
+        // decoding modes are chosen again after wake up
+        m_nDecimation = 1;
+        m_nDecimationCounter = 0;
+        m_bTrickMode = false;
+
+        m_sHibernateFile = m_decoder.getFile();
+        m_bHibernateLoop = m_decoder.m_bLoop;
+        m_fHibernateStart = m_decoder.m_fStartAt;
+        m_fHibernateEnd = m_decoder.m_fEndAfter;
+        m_fHibernateDuration = m_decoder.getDuration();
+        m_fHibernatePos = fPos;
+        m_decoder.cleanup();
+
+        // the memory is given back instead of keeping the renderer in the pool
+        if ( m_VRenderer )
+        {
+            static_cast<CVideoRenderer*>( m_VRenderer )->m_bPoolable = false;
+        }
+
+        ReleaseResources(); // overrides are applied again on wake up
+
+        m_bHibernating = true;
+        ++m_nHibernations;
+
+        gPlugin->LogAlways( "Hibernate id(%d) video(%.2fs) freed(%.0fKB)", m_nVideoId, fPos, float( nBytes ) / 1024.0f );
+        return true;
+    }
+
+    bool CWebMWrapper::WakeUp()
+    {
+        m_bHibernating = false;
+
+        if ( EXIT_SUCCESS != m_decoder.open( ( char* )m_sHibernateFile.c_str(), m_bHibernateLoop, m_fHibernateStart, m_fHibernateEnd, this, false ) )
+        {
+            gPlugin->LogError( "Wake up id(%d) file(%s) failed", m_nVideoId, m_sHibernateFile.c_str() );
+            return false;
+        }
+
+        // the decoder continues at the keyframe before the position, the drop modes catch up
+        if ( m_fHibernatePos > VIDEO_EPSILON )
+        {
+            m_decoder.seek( m_fHibernatePos, false );
+        }
+
+        CreateResources();
+
+#if defined(_DEBUG)
+        gPlugin->LogAlways( "Wake up id(%d) video(%.2fs) renderer(%s)", m_nVideoId, m_fHibernatePos, m_bRendererReused ? "reused" : "created" );
+#endif
+        return m_VRenderer;
+    }
+
     ISoundplayer* CWebMWrapper::GetSoundplayer()
     {
         return &m_Sound;
@@ -118,7 +526,13 @@ namespace VideoplayerPlugin
         SetTimesource( eTS );
         m_eDM = eDM;
 
-        if ( EXIT_SUCCESS == m_decoder.open( ( char* )sFile, bLoop, fStartAt, fEndAfter, this ) )
+        // live WebM (growing file or local pipe) is demuxed as it arrives
+        bool bOpened = EXIT_SUCCESS == m_decoder.open( ( char* )sFile, bLoop, fStartAt, fEndAfter, this, IsLive() );
+
+        // a video warmed up during level loading passes its renderer on through the pool, the decoder already holds the read ahead file
+        gVideoplayerSystem->ReleasePreloaded( sFile );
+
+        if ( bOpened )
         {
             m_nWidth = nCustomWidth > 0 ? nCustomWidth : m_decoder.m_nWidth;
             m_nHeight = nCustomHeight > 0 ? nCustomHeight : m_decoder.m_nHeight;
@@ -128,9 +542,14 @@ namespace VideoplayerPlugin
 
         m_Sound.Open( sSound, this, bLoop );
 
-        gPlugin->LogAlways( "Open id(%d) file(%s) sound(%s)", m_nVideoId, sFile, sSound );
+        unsigned nPoolHits, nPoolMisses;
+        float fCreateTime;
+        getVideoRendererPoolStats( nPoolHits, nPoolMisses, fCreateTime );
 
-        return m_pCE3Tex;
+        gPlugin->LogAlways( "Open id(%d) file(%s) sound(%s) renderer(%s) pool hitrate(%.0f%%) saved(%.2fms)", m_nVideoId, sFile, sSound, m_bRendererReused ? "reused" : "created",
+                            nPoolHits + nPoolMisses ? 100.0f * nPoolHits / ( nPoolHits + nPoolMisses ) : 0.0f, m_bRendererReused ? fCreateTime * MILLISECOND : 0.0f );
+
+        return m_VRenderer;
     }
 
     void CWebMWrapper::SetTimesource( eTimeSource eTS )
@@ -147,6 +566,176 @@ namespace VideoplayerPlugin
         {
             m_eTS = eTS;
         }
+
+        m_decoder.m_bLive = IsLive();
+    }
+
+    bool CWebMWrapper::IsLive()
+    {
+        return ( m_eTS & VTS_Live ) || ( m_eDM & VDM_Live );
+    }
+
+    void CWebMWrapper::SetVisibilityPolicy( eVisibilityPolicy eVP )
+    {
+        m_eVP = eVP;
+    }
+
+    eVisibilityPolicy CWebMWrapper::GetVisibilityPolicy()
+    {
+        return m_eVP;
+    }
+
+    void CWebMWrapper::SetPriority( eVideoPriority ePriority )
+    {
+        m_ePriority = ePriority;
+    }
+
+    eVideoPriority CWebMWrapper::GetPriority()
+    {
+        return m_ePriority;
+    }
+
+    eVideoPriority CWebMWrapper::GetPriorityClass()
+    {
+        if ( m_ePriority != VPR_Auto )
+        {
+            return m_ePriority;
+        }
+
+        if ( ( GetFrameId() - m_nLast2DFrame ) <= gVideoplayerSystem->vp_visibilityframes )
+        {
+            return VPR_UI;
+        }
+
+        // unknown distance counts as near
+        return m_fDistance >= VIDEORENDERER_NEAR ? VPR_Far : VPR_Near;
+    }
+
+    bool CWebMWrapper::IsVisible()
+    {
+        return m_bVisible;
+    }
+
+    void CWebMWrapper::TrackVisibility( EntityId nEntityId, bool bTrack )
+    {
+        std::vector<EntityId>::iterator iter = std::find( m_vecVisibilityEntities.begin(), m_vecVisibilityEntities.end(), nEntityId );
+
+        if ( bTrack && iter == m_vecVisibilityEntities.end() )
+        {
+            m_vecVisibilityEntities.push_back( nEntityId );
+        }
+
+        else if ( !bTrack && iter != m_vecVisibilityEntities.end() )
+        {
+            m_vecVisibilityEntities.erase( iter );
+        }
+    }
+
+    int CWebMWrapper::GetFrameId()
+    {
+        // headless runs have no renderer frames, everything counts as visible
+        return gEnv->pRenderer ? gEnv->pRenderer->GetFrameID( false ) : 0;
+    }
+
+    bool CWebMWrapper::UpdateVisibility()
+    {
+        // material overrides and 2D outputs access the texture
+        if ( m_pCE3Tex )
+        {
+            m_nLastVisibleFrame = max( m_nLastVisibleFrame, m_pCE3Tex->GetAccessFrameId() );
+        }
+
+        // render nodes of tracked entities
+        Vec3 vCamera = gEnv->pSystem->GetViewCamera().GetPosition();
+        m_fDistance = -1;
+
+        for ( std::vector<EntityId>::const_iterator iter = m_vecVisibilityEntities.begin(); iter != m_vecVisibilityEntities.end(); ++iter )
+        {
+            IEntity* pEntity = gEnv->pEntitySystem->GetEntity( *iter );
+            IEntityRenderProxy* pProxy = pEntity ? static_cast<IEntityRenderProxy*>( pEntity->GetProxy( ENTITY_PROXY_RENDER ) ) : NULL;
+            IRenderNode* pNode = pProxy ? pProxy->GetRenderNode() : NULL;
+
+            if ( pNode )
+            {
+                m_nLastVisibleFrame = max( m_nLastVisibleFrame, pNode->GetDrawFrame() );
+            }
+
+            if ( pEntity )
+            {
+                float fDistance = vCamera.GetDistance( pEntity->GetWorldPos() );
+                m_fDistance = m_fDistance < 0 ? fDistance : min( m_fDistance, fDistance );
+            }
+        }
+
+        int nFrameId = GetFrameId();
+        m_bVisible = ( nFrameId - m_nLastVisibleFrame ) <= gVideoplayerSystem->vp_visibilityframes;
+
+        // uploads of critical videos first, then 2D outputs, then near and then far in-world outputs
+        if ( m_VRenderer )
+        {
+            switch ( GetPriorityClass() )
+            {
+                case VPR_Critical:
+                    m_VRenderer->SetUploadPriority( VUP_CRITICAL );
+                    break;
+
+                case VPR_UI:
+                    m_VRenderer->SetUploadPriority( VUP_2D );
+                    break;
+
+                case VPR_Far:
+                    m_VRenderer->SetUploadPriority( VUP_FAR );
+                    break;
+
+                default:
+                    m_VRenderer->SetUploadPriority( VUP_NEAR );
+            }
+        }
+
+        return m_bVisible;
+    }
+
+    unsigned CWebMWrapper::GetDecimation()
+    {
+        unsigned nDistance = GetDistanceDecimation();
+        unsigned nLoad = gVideoplayerSystem->GetLoadDecimation( GetPriorityClass() );
+
+        // only keyframes (0) is the strongest decimation
+        return nDistance && nLoad ? max( nDistance, nLoad ) : 0;
+    }
+
+    unsigned CWebMWrapper::GetDistanceDecimation()
+    {
+        // distance is only known for tracked entities
+        if ( !gVideoplayerSystem->vp_decimation || m_fDecimationScale <= 0 || m_fDistance < 0 )
+        {
+            return 1;
+        }
+
+        // 2D outputs are always presented with the full rate
+        if ( ( GetFrameId() - m_nLast2DFrame ) <= gVideoplayerSystem->vp_visibilityframes )
+        {
+            return 1;
+        }
+
+        float fDistance = m_fDistance * m_fDecimationScale;
+
+        if ( gVideoplayerSystem->vp_decimationkeyframes > 0 && fDistance >= gVideoplayerSystem->vp_decimationkeyframes )
+        {
+            return 0;
+        }
+
+        if ( gVideoplayerSystem->vp_decimationquarter > 0 && fDistance >= gVideoplayerSystem->vp_decimationquarter )
+        {
+            return 4;
+        }
+
+        if ( gVideoplayerSystem->vp_decimationhalf > 0 && fDistance >= gVideoplayerSystem->vp_decimationhalf )
+        {
+            return 2;
+        }
+
+        return 1;
     }
 
     void CWebMWrapper::SetSpeed( float fSpeed )
@@ -168,7 +757,7 @@ namespace VideoplayerPlugin
 
     bool CWebMWrapper::IsActive()
     {
-        return m_decoder.isOpen();
+        return m_decoder.isOpen() || m_bHibernating;
     }
 
     bool CWebMWrapper::IsPlaying()
@@ -178,15 +767,36 @@ namespace VideoplayerPlugin
 
     void CWebMWrapper::Resume()
     {
+        // hibernated videos restore their resources lazily
+        if ( m_bHibernating && !WakeUp() )
+        {
+            return;
+        }
+
+        // a prepared video starts at its presented first frame
+        if ( m_bStartPending )
+        {
+            m_bStartPending = false;
+            OnStart();
+            return;
+        }
+
         m_bPaused = false;
+        m_bHiddenPaused = false;
+        m_nLastVisibleFrame = GetFrameId();
 
-        // initialize timers
-        if ( m_eTS & VTS_SystemTime )
+        // initialize timers (the sound clock is filtered against the system time)
+        if ( m_eTS & ( VTS_SystemTime | VTS_Sound ) )
         {
             vpx_usec_timer_start( &m_timer );
         }
 
-        m_fTimer = m_decoder.getPosition();
+        // playing backwards or from the loop cache continues from its own position
+        if ( !m_bReverse && !m_bLoopWrapped )
+        {
+            m_fTimer = m_decoder.getPosition();
+        }
+
         m_fTimerNextFrame = m_fTimer - GetFrameDuration(); // forces output of next frame
 
         // resume playback at last position
@@ -199,6 +809,8 @@ namespace VideoplayerPlugin
     void CWebMWrapper::Pause()
     {
         m_bPaused = true;
+        m_bHiddenPaused = false;
+        m_fIdleSince = gEnv->pTimer->GetAsyncCurTime();
         m_Sound.Pause();
 #if defined(_DEBUG)
         gPlugin->LogAlways( "Pause id(%d) video(%.2fs) sound(%.2fs) duration(%.2fs)", m_nVideoId, GetPosition(), m_Sound.GetPosition(), GetDuration() );
@@ -240,11 +852,7 @@ namespace VideoplayerPlugin
             // TODO maybe sometime decide this based on tone mapping settings
 
             // general
-            sShaderName = "Illum"; // "Monitor"
-
-            pShader = gEnv->pRenderer->EF_LoadShader( sShaderName ); // Important to release it (else crash on exit)
-            //uGenerationMask = pShader->GetGenerationMask();
-            SAFE_RELEASE( pShader ); // Important else CE3 will crash on exit
+            sShaderName = "Illum"; // "Monitor", loaded by the shader item
 
             ResTemp.m_LMaterial.m_SpecShininess = 0;
             //Res.m_LMaterial.m_Specular = ColorF(0,0,0,0);
@@ -272,14 +880,22 @@ namespace VideoplayerPlugin
 
         if ( m_pCE3Tex && pSamp )
         {
+            m_fDecimationScale = min( m_fDecimationScale, mOverride.fDecimationScale );
+
             pSamp->m_pITex = m_pCE3Tex;
             ULONG nrefcount = m_pCE3Tex->AddRef();
 
             pTex->m_TexFlags = FT_USAGE_RENDERTARGET;
             pTex->m_Name = m_sCE3Tex; // name is important
 
-            mOverride.pMaterial->AssignShaderItem( gEnv->pRenderer->EF_LoadShaderItem( sShaderName, true, 0, &ResTemp, uGenerationMask ) );// TODOTODO Generation params pShader->GetGenerationParams()
-            bRet = true;
+            // shared with other materials showing this video with the same shader and parameters
+            SShaderItem shaderItemVideo = gVideoplayerSystem->LoadShaderItem( m_pCE3Tex, sShaderName, uGenerationMask, mOverride.nTextureslot, ResTemp );
+
+            if ( shaderItemVideo.m_pShader )
+            {
+                mOverride.pMaterial->SetShaderItem( shaderItemVideo );
+                bRet = true;
+            }
         }
 
         // end if pShader
@@ -368,6 +984,9 @@ namespace VideoplayerPlugin
             // height and width are in virtual resolution so they are now converted and ready to use
             if ( info.cRGBA.a >= 0.01 )
             {
+                m_nLastVisibleFrame = gEnv->pRenderer->GetFrameID( false );
+                m_nLast2DFrame = m_nLastVisibleFrame;
+
                 bool bDrawBG = info.cBG_RGBA.a >= 0.01 && ( info.nResizeMode == VRM_TouchInside || info.nResizeMode == VRM_Original );
 
                 if ( gVideoplayerSystem->IsGameLoopActive() && info.nZPos == VZP_AboveMenu )
@@ -450,6 +1069,16 @@ namespace VideoplayerPlugin
 
     float CWebMWrapper::GetEnd()
     {
+        if ( m_bHibernating )
+        {
+            return m_fHibernateEnd > VIDEO_EPSILON ? min( m_fHibernateDuration, m_fHibernateEnd ) : m_fHibernateDuration;
+        }
+
+        if ( IsLoopResuming() )
+        {
+            return m_fLoopEnd;
+        }
+
         if ( !m_decoder.isOpen() )
         {
             return -1;
@@ -465,6 +1094,16 @@ namespace VideoplayerPlugin
 
     float CWebMWrapper::GetStart()
     {
+        if ( m_bHibernating )
+        {
+            return m_fHibernateStart > VIDEO_EPSILON ? m_fHibernateStart : 0;
+        }
+
+        if ( IsLoopResuming() )
+        {
+            return m_fLoopStart;
+        }
+
         if ( !m_decoder.isOpen() )
         {
             return -1;
@@ -480,27 +1119,87 @@ namespace VideoplayerPlugin
 
     float CWebMWrapper::GetDuration()
     {
+        if ( m_bHibernating )
+        {
+            return m_fHibernateDuration;
+        }
+
+        if ( IsLoopResuming() )
+        {
+            return m_fLoopDuration;
+        }
+
         return m_decoder.isOpen() ? m_decoder.getDuration() : -1;
     }
 
     float CWebMWrapper::GetPosition()
     {
+        if ( m_bHibernating )
+        {
+            return m_fHibernatePos;
+        }
+
+        if ( m_bReverse || m_bLoopWrapped )
+        {
+            return m_fTimer;
+        }
+
         return m_decoder.isOpen() ? m_decoder.getPosition() : -1;
     }
 
     float CWebMWrapper::GetFPS()
     {
+        if ( IsLoopResuming() )
+        {
+            return m_fLoopFPS;
+        }
+
         return m_decoder.isOpen() ? m_decoder.getFPS() : 0;
     }
 
-    unsigned CWebMWrapper::GetHeight()
+    bool CWebMWrapper::GetStats( SVideoStats& stats )
     {
-        return m_pCE3Tex ? m_decoder.m_nHeight : 0;
+        bool bResuming = IsLoopResuming();
+        stats.sFile = m_bHibernating ? m_sHibernateFile.c_str() : bResuming ? m_sLoopFile.c_str() : m_decoder.isOpen() ? m_decoder.getFile() : "";
+
+        m_statDecode.GetPercentiles( stats.decode );
+        m_statConvert.GetPercentiles( stats.convert );
+        m_statUpload.GetPercentiles( stats.upload );
+        m_statClock.GetPercentiles( stats.clockdrift );
+
+        stats.nBytesRead = bResuming ? m_nLoopBytesRead : m_decoder.m_nBytesRead;
+        stats.nFramesDecoded = bResuming ? m_nLoopFramesDecoded : m_decoder.m_nFramesDecoded;
+        stats.nFramesPresented = m_nFramesPresented + m_nLiveFrames + m_nTrickFrames + m_nReverseFrames;
+        stats.nFramesDropped = m_nFramesDropped;
+        stats.nFramesSkipped = bResuming ? m_nLoopFramesSkipped : m_decoder.m_nDecodesSkipped + m_decoder.m_nLiveSkipped;
+        stats.nSeeks = m_nSeeks;
+        stats.fClockDrift = m_fClockError;
+
+        GetMemoryUsage( stats.nMemoryDecoder, stats.nMemoryStaging, stats.nMemoryTexture );
+        stats.bHibernating = m_bHibernating;
+        stats.nHibernations = m_nHibernations;
+
+        return IsActive();
     }
 
-    unsigned CWebMWrapper::GetWidth()
+    unsigned CWebMWrapper::GetHeight()
+    {
+        if ( IsLoopResuming() )
+        {
+            return m_VRenderer ? m_nLoopHeight : 0;
+        }
+
+        return m_VRenderer ? m_decoder.m_nHeight : 0;
+    }
+
+    unsigned CWebMWrapper::GetWidth()
     {
-        return m_pCE3Tex ? m_decoder.m_nWidth : 0;
+        if ( IsLoopResuming() )
+        {
+            return m_VRenderer ? m_nLoopWidth : 0;
+        }
+
+        return m_VRenderer ? m_decoder.m_nWidth : 0;
     }
 
     // IVideoplayerEventListener
@@ -527,12 +1226,32 @@ namespace VideoplayerPlugin
 
     bool CWebMWrapper::Seek( float fPos )
     {
+        // applied by the keyframe seek on wake up
+        if ( m_bHibernating )
+        {
+            ++m_nSeeks;
+            m_fHibernatePos = fPos;
+            m_Sound.Seek( fPos );
+            return true;
+        }
+
+        // playing backwards restarts at the new position
+        StopReverse();
+        StopLoop();
+
+        ++m_nSeeks;
         bool bRet = ( 0 == m_decoder.seek( fPos ) );
         return bRet;
     }
 
     void CWebMWrapper::OnStart()
     {
+        if ( m_bPreparing )
+        {
+            m_bStartPending = true;
+            return;
+        }
+
         // resume playback
         Resume();
 
@@ -573,12 +1292,12 @@ namespace VideoplayerPlugin
 
     void CWebMWrapper::OnSeek()
     {
-        // read at least one frame to get position
-        bool bDirty;
-        m_decoder.readFrame( NULL, bDirty, false, true );
+        // the frame at the new position is presented next
+        float fPos = m_decoder.peekPosition();
+        m_pAheadImg = NULL;
 
         // reset timers
-        m_fTimer = m_decoder.getPosition();
+        m_fTimer = fPos >= 0.0f ? fPos : m_decoder.getPosition();
         m_fTimerNextFrame = m_fTimer - GetFrameDuration(); // forces output of next frame
 
         // seek synchronized sound
@@ -591,27 +1310,399 @@ namespace VideoplayerPlugin
         }
 
         // restart timer
-        if ( m_eTS & VTS_SystemTime )
+        if ( m_eTS & ( VTS_SystemTime | VTS_Sound ) )
         {
             vpx_usec_timer_start( &m_timer );
         }
 
+        // the sound clock starts over
+        m_fClockError = 0;
+
 #if defined(_DEBUG)
         gPlugin->LogAlways( "OnSeek id(%d) video(%.2fs) sound(%.2fs) duration(%.2fs)", m_nVideoId, GetPosition(), m_Sound.GetPosition(), GetDuration() );
 #endif
     }
 
+    void CWebMWrapper::PrefetchReverse( void* pWrapper )
+    {
+        CWebMWrapper* pThis = ( CWebMWrapper* )pWrapper;
+
+        pThis->m_nReversePrefetched = pThis->m_ReverseCache[pThis->m_nReverseFront ^ 1].decode( pThis->m_fReversePrefetchEnd, pThis->m_nReverseBudget );
+        pThis->m_evReversePrefetch.set();
+    }
+
+    void CWebMWrapper::StopReverse()
+    {
+        if ( m_bReversePrefetching )
+        {
+            m_evReversePrefetch.wait();
+            m_bReversePrefetching = false;
+        }
+
+        if ( m_bReverse )
+        {
+            m_nReverseDecoded += m_ReverseCache[0].m_nDecoded + m_ReverseCache[1].m_nDecoded;
+            m_ReverseCache[0].close();
+            m_ReverseCache[1].close();
+            m_bReverse = false;
+            m_pReverseImg = NULL;
+        }
+    }
+
+    void CWebMWrapper::AdvanceReverse( float fDeltaTime )
+    {
+        float fStart = GetStart();
+
+        if ( !m_bReverse )
+        {
+            m_bReverse = true;
+            m_bReverseStart = false;
+            m_nReverseFront = 0;
+            m_nReverseBudget = size_t( max( gVideoplayerSystem->vp_reversebudget, 1.0f ) * 1024 * 1024 / 2 );
+            m_pReverseImg = NULL;
+            StopLoop();
+
+            // the current GOP is decoded right away, the ones before it are prefetched while playing
+            if ( m_ReverseCache[0].open( m_decoder.getFile(), m_decoder.m_fStartAt, m_decoder.m_fEndAfter ) || m_ReverseCache[1].open( m_decoder.getFile(), m_decoder.m_fStartAt, m_decoder.m_fEndAfter )
+                    || m_ReverseCache[0].decode( m_fTimer + VIDEO_EPSILON, m_nReverseBudget ) <= 0 )
+            {
+                gPlugin->LogWarning( "Reverse id(%d) not supported by this video (needs a seekable WebM)", m_nVideoId );
+            }
+        }
+
+        VPXDecGOPCache* pFront = &m_ReverseCache[m_nReverseFront];
+
+        if ( pFront->getStart() < 0.0f )
+        {
+            return; // not supported, the current frame stays
+        }
+
+        // playback runs backwards, the delta is negative
+        m_fTimer = max( m_fTimer + min( fDeltaTime, 0.0f ), fStart );
+
+        // presented GOP is used up, continue with the prefetched one
+        if ( !m_bReverseStart && m_fTimer < pFront->getStart() )
+        {
+            if ( m_bReversePrefetching && m_evReversePrefetch.wait( 0 ) != 0 )
+            {
+                // the worker didn't finish in time
+                ++m_nReverseStalls;
+                m_evReversePrefetch.wait();
+            }
+
+            if ( m_bReversePrefetching && m_nReversePrefetched > 0 )
+            {
+                m_nReverseFront ^= 1;
+                pFront = &m_ReverseCache[m_nReverseFront];
+            }
+
+            m_bReversePrefetching = false;
+        }
+
+        // first frame reached
+        if ( !m_bReverseStart && ( m_fTimer <= fStart || m_fTimer < pFront->getStart() ) )
+        {
+            m_bReverseStart = true;
+            m_fTimer = max( m_fTimer, pFront->getStart() );
+            OnEnd(); // dispatch events to listeners
+
+            if ( m_decoder.m_bLoop && GetEnd() > fStart + VIDEO_EPSILON )
+            {
+                // continue backwards from the end
+                StopReverse();
+                OnStart(); // dispatch events to listeners
+                m_fTimer = GetEnd();
+                return;
+            }
+        }
+
+        // prefetch the GOP before the presented one on a worker
+        if ( !m_bReverseStart && !m_bReversePrefetching && pFront->getStart() > fStart + VIDEO_EPSILON )
+        {
+            m_fReversePrefetchEnd = pFront->getStart();
+            m_nReversePrefetched = 0;
+            m_bReversePrefetching = true;
+            m_evReversePrefetch.reset();
+            Concurrency::CurrentScheduler::ScheduleTask( &CWebMWrapper::PrefetchReverse, this );
+        }
+
+        vpx_image_t* img = pFront->getFrame( m_fTimer );
+
+        if ( img && img != m_pReverseImg )
+        {
+            m_pReverseImg = img;
+            ++m_nReverseFrames;
+
+            if ( m_VRenderer )
+            {
+                m_VRenderer->RenderFrame( img );
+            }
+
+            OnFrame();
+        }
+    }
+
+    void CWebMWrapper::FillLoopCache( void* pWrapper )
+    {
+        CWebMWrapper* pThis = ( CWebMWrapper* )pWrapper;
+        VPXDec* pDecoder = &pThis->m_decoder;
+
+        pThis->m_nLoopCached = -1;
+
+        if ( EXIT_SUCCESS == pThis->m_LoopCache.open( pDecoder->getFile(), pDecoder->m_fStartAt, pDecoder->m_fEndAfter ) )
+        {
+            pThis->m_nLoopCached = pThis->m_LoopCache.decodeStart( pThis->m_nLoopReserved, &pThis->m_fLoopResume );
+            pThis->m_nLoopCached = pThis->m_nLoopCached > 0 ? pThis->m_nLoopCached : -1;
+        }
+
+        // the cache is decoded once and reused by every loop
+        pThis->m_LoopCache.closeDecoder();
+        pThis->m_evLoop.set();
+    }
+
+    void CWebMWrapper::ResumeLoop( void* pWrapper )
+    {
+        CWebMWrapper* pThis = ( CWebMWrapper* )pWrapper;
+
+        pThis->m_decoder.resumeAt( pThis->m_fLoopResume );
+        pThis->m_evLoop.set();
+    }
+
+    void CWebMWrapper::StopLoop()
+    {
+        // only the worker positioning the decoder has to finish, filling the cache doesn't use the decoder
+        if ( m_bLoopWorking && m_bLoopWrapped )
+        {
+            m_evLoop.wait();
+            m_bLoopWorking = false;
+        }
+
+        m_bLoopWrapped = false;
+        m_pLoopImg = NULL;
+    }
+
+    bool CWebMWrapper::IsLoopResuming()
+    {
+        return m_bLoopWorking && m_bLoopWrapped;
+    }
+
+    bool CWebMWrapper::WrapLoop()
+    {
+        if ( ( m_bLoopWorking && m_evLoop.wait( 0 ) != 0 ) || m_nLoopCached <= 0 || !m_decoder.m_bLoop )
+        {
+            return false; // the decoder seeks back to the start
+        }
+
+        m_bLoopWorking = false;
+
+        // no seek, sound resync or decoder reset: the start is presented from the cache while a worker positions the decoder behind it
+        for ( std::vector<IVideoplayerEventListener*>::const_iterator iterQueue = vecQueue.begin(); iterQueue != vecQueue.end(); ++iterQueue )
+        {
+            ( *iterQueue )->OnEnd();
+        }
+
+        for ( std::vector<IVideoplayerEventListener*>::const_iterator iterQueue = vecQueue.begin(); iterQueue != vecQueue.end(); ++iterQueue )
+        {
+            ( *iterQueue )->OnStart();
+        }
+
+        m_bLoopWrapped = true;
+        m_pLoopImg = NULL;
+        m_pAheadImg = NULL;
+        m_fTimer = m_LoopCache.getStart();
+        m_fTimerNextFrame = m_fTimer;
+        ++m_nLoopWraps;
+
+#if defined(_DEBUG)
+        gPlugin->LogAlways( "Loop id(%d) seamless cached(%.2fs-%.2fs)", m_nVideoId, m_LoopCache.getStart(), m_LoopCache.getEnd() );
+#endif
+
+        if ( m_fLoopResume < 0.0f )
+        {
+            return true; // the whole video is cached, the decoder isn't needed anymore
+        }
+
+        // the worker owns the decoder until AdvanceLoop joins it, so everything reported meanwhile is taken now
+        m_fLoopStart = GetStart();
+        m_fLoopEnd = GetEnd();
+        m_fLoopDuration = GetDuration();
+        m_fLoopFPS = GetFPS();
+        m_nLoopWidth = m_decoder.m_nWidth;
+        m_nLoopHeight = m_decoder.m_nHeight;
+        m_nLoopMemory = m_decoder.getMemoryUsage();
+        m_sLoopFile = m_decoder.getFile();
+        m_nLoopBytesRead = m_decoder.m_nBytesRead;
+        m_nLoopFramesDecoded = m_decoder.m_nFramesDecoded;
+        m_nLoopFramesSkipped = m_decoder.m_nDecodesSkipped + m_decoder.m_nLiveSkipped;
+
+        m_bLoopWorking = true;
+        m_evLoop.reset();
+        Concurrency::CurrentScheduler::ScheduleTask( &CWebMWrapper::ResumeLoop, this );
+        return true;
+    }
+
+    bool CWebMWrapper::AdvanceLoop( float fDisplay )
+    {
+        if ( m_fLoopResume >= 0.0f && fDisplay >= m_fLoopResume )
+        {
+            // the decoder continues behind the cached frames
+            if ( m_bLoopWorking && m_evLoop.wait( 0 ) != 0 )
+            {
+                ++m_nLoopStalls;
+                m_evLoop.wait();
+            }
+
+            m_bLoopWorking = false;
+            m_bLoopWrapped = false;
+            m_pLoopImg = NULL;
+            return false;
+        }
+
+        if ( m_fLoopResume < 0.0f && fDisplay >= m_LoopCache.getEnd() + GetFrameDuration() )
+        {
+            WrapLoop();
+            return true;
+        }
+
+        vpx_image_t* img = m_LoopCache.getFrame( fDisplay );
+        m_fTimerNextFrame = m_fTimer;
+
+        if ( img && img != m_pLoopImg )
+        {
+            m_pLoopImg = img;
+            ++m_nFramesPresented;
+
+            if ( m_VRenderer )
+            {
+                m_VRenderer->RenderFrame( img );
+            }
+
+            OnFrame();
+        }
+
+        return true;
+    }
+
+    bool CWebMWrapper::IsTrickMode()
+    {
+        // the speed only applies without sound (and live inputs are presented as they arrive)
+        return gVideoplayerSystem->vp_trickspeed > 0 && m_fSpeed >= gVideoplayerSystem->vp_trickspeed && !m_Sound.IsActive() && !IsLive();
+    }
+
     float CWebMWrapper::GetFrameDuration()
     {
         if ( !( ( m_eTS | VTS_Sound ) && m_Sound.IsActive() ) )
         {
             // only modify based on speed if the time source is based on sound (but not implemented anyways)
-            return 1.0f / ( m_fSpeed * m_decoder.getFPS() );
+            return 1.0f / ( fabs( m_fSpeed ) * GetFPS() );
         }
 
         else
         {
-            return 1.0f / m_decoder.getFPS();
+            return 1.0f / GetFPS();
+        }
+    }
+
+    void CWebMWrapper::AdvanceLive( float fDeltaTime )
+    {
+        // live inputs resume decoding at the next keyframe instead of seeking
+        unsigned nDecimation = GetDecimation();
+
+        if ( nDecimation != m_nDecimation )
+        {
+            m_nDecimation = nDecimation;
+            m_nDecimationCounter = 0;
+            m_decoder.m_bKeyframesOnly = nDecimation == 0;
+        }
+
+        // without VDM_Live every frame is presented in arrival order, else only the newest one
+        bool bNewest = m_eDM & VDM_Live;
+
+        // hidden inputs are only read (decoding resumes at the next keyframe)
+        bool bHidden = !m_bVisible && m_eVP == VVP_ClockOnlyWhenHidden;
+
+        bool bPresent = m_nDecimation <= 1 || ( m_nDecimationCounter++ % m_nDecimation ) == 0;
+
+        // reading without decoding is cheap
+        bool bDropDecode = bHidden || m_bLiveCatchup;
+        unsigned nMaxFrames = bNewest ? ( bDropDecode ? LIVE_MAXFRAMES * 16 : LIVE_MAXFRAMES ) : 1;
+
+        vpx_image_t* img = NULL;
+        vpx_usec_timer tFrame;
+        bool bDirty;
+
+        vpx_usec_timer_start( &tFrame );
+        int nFrames = m_decoder.readLiveFrames( bPresent ? &img : NULL, bDirty, nMaxFrames, bDropDecode );
+        vpx_usec_timer_mark( &tFrame );
+        float fDecode = float( vpx_usec_timer_elapsed( &tFrame ) ) / MICROSECOND;
+
+        if ( nFrames <= 0 )
+        {
+            // no data arrived yet (or a read error, which is retried next time)
+            return;
+        }
+
+        // the input is drained, decoding resumes at the next keyframe
+        if ( m_bLiveCatchup && unsigned( nFrames ) < nMaxFrames )
+        {
+            m_bLiveCatchup = false;
+        }
+
+        // the first frame defines the wall clock
+        if ( m_nLiveFramesRead == 0 )
+        {
+            vpx_usec_timer_start( &m_liveTimer );
+        }
+
+        m_nLiveFramesRead += nFrames;
+
+        // the input delay is unknown, so the lag is measured against the fastest frame seen so far
+        vpx_usec_timer_mark( &m_liveTimer );
+        float fOffset = float( vpx_usec_timer_elapsed( &m_liveTimer ) ) / MICROSECOND - m_decoder.getPosition();
+
+        if ( m_nLiveFramesRead == unsigned( nFrames ) || fOffset < m_fLiveOffset )
+        {
+            m_fLiveOffset = fOffset;
+        }
+
+        m_fLiveLag = fOffset - m_fLiveOffset;
+
+        // lagging too far behind (decoding too slow, was paused, opened with a backlog): skip ahead to the next keyframe
+        bool bBacklog = !bDropDecode && unsigned( nFrames ) >= nMaxFrames;
+
+        if ( bNewest && !m_bLiveCatchup && gVideoplayerSystem->vp_livelatency > 0 && ( m_fLiveLag > gVideoplayerSystem->vp_livelatency || bBacklog ) )
+        {
+#ifdef _DEBUG
+            gPlugin->LogWarning( "Advance Live Catchup id(%d) lag(%.2fs)", m_nVideoId, m_fLiveLag );
+#endif
+            m_bLiveCatchup = true;
+            ++m_nLiveCatchups;
+        }
+
+        // decoded frame needs now to be transfered into video memory
+        if ( m_VRenderer && img && bDirty )
+        {
+            m_fDecodeTime = m_fDecodeTime * 0.9f + 0.1f * fDecode;
+            m_statDecode.Add( fDecode * MICROSECOND );
+
+            vpx_usec_timer_start( &tFrame );
+            m_VRenderer->RenderFrame( img );
+            vpx_usec_timer_mark( &tFrame );
+            float fConvert = float( vpx_usec_timer_elapsed( &tFrame ) ) / MICROSECOND;
+            m_fConvertTime = m_fConvertTime * 0.9f + 0.1f * fConvert;
+            m_statConvert.Add( fConvert * MICROSECOND );
+
+            // glass-to-glass: input lag, decode and conversion, upload and present with the next rendered frame (estimated by the last frame time)
+            float fLatency = m_fLiveLag + fDecode + fConvert + max( fDeltaTime, 0.0f );
+
+            ++m_nLiveFrames;
+            m_fLiveLatencySum += fLatency;
+            m_fLiveLatencyMax = max( m_fLiveLatencyMax, fLatency );
+        }
+
+        else if ( m_nDecimation != 1 )
+        {
+            ++m_nFramesDecimated;
         }
     }
 
@@ -625,8 +1716,58 @@ namespace VideoplayerPlugin
             return;
         }
 
-        if ( m_iCE3Tex > 0 && !m_bPaused && m_decoder.isOpen() )
+        // hibernated hidden videos wake up once their tracked entities are rendered again
+        if ( m_bHibernating )
         {
+            if ( m_bHiddenPaused && !m_bPaused && UpdateVisibility() )
+            {
+                Resume();
+            }
+
+            return;
+        }
+
+        VPXDEC_TRACE( "Advance", m_nVideoId );
+
+        float fUploadTime;
+
+        if ( m_VRenderer && m_VRenderer->TakeUploadTime( fUploadTime ) )
+        {
+            m_statUpload.Add( fUploadTime );
+        }
+
+        if ( m_VRenderer && !m_bPaused && m_decoder.isOpen() )
+        {
+            UpdateVisibility();
+
+            if ( m_bHiddenPaused && ( m_bVisible || m_eVP != VVP_PauseWhenHidden ) )
+            {
+                // visible again, continue where we stopped
+                Resume();
+            }
+
+            else if ( !m_bVisible && m_eVP == VVP_PauseWhenHidden )
+            {
+                if ( !m_bHiddenPaused )
+                {
+#if defined(_DEBUG)
+                    gPlugin->LogAlways( "Hidden id(%d) video(%.2fs) paused", m_nVideoId, GetPosition() );
+#endif
+                    m_Sound.Pause();
+                    m_bHiddenPaused = true;
+                    m_fIdleSince = gEnv->pTimer->GetAsyncCurTime();
+                }
+
+                return;
+            }
+
+            // live inputs are presented as the data arrives
+            if ( IsLive() )
+            {
+                AdvanceLive( fDeltaTime );
+                return;
+            }
+
             // decoder is in initialized state
             float fActualDelta = 0.0f;
             float fSoundPos = 0.0f;
@@ -638,7 +1779,43 @@ namespace VideoplayerPlugin
 
             if ( !bEditorPlayback && ( m_eTS & VTS_Sound ) && bSoundPlaying && m_fTimer > VIDEO_EPSILON && ( fSoundPos = m_Sound.GetPosition() ) > VIDEO_EPSILON )
             {
-                fActualDelta = fSoundPos - m_fTimer; // no speed since pitch doesn't work on sounds...
+                // no speed since pitch doesn't work on sounds...
+                float fClockError = fSoundPos - m_fTimer;
+                m_statClock.Add( float( fabs( fClockError ) ) * MILLISECOND );
+
+                vpx_usec_timer_mark( &m_timer );
+                float fSystemDelta = float( vpx_usec_timer_elapsed( &m_timer ) ) / MICROSECOND;
+                vpx_usec_timer_start( &m_timer );
+
+                float fMaxDrift = gVideoplayerSystem->vp_clockdrift;
+
+                if ( fMaxDrift <= 0 || fabs( fClockError ) > CLOCK_RESYNC || fSystemDelta < 0 || fSystemDelta > VIDEO_TIMEOUT )
+                {
+                    // discontinuity (sound seek/loop, hitch or unfiltered): jump to the sound position
+                    fActualDelta = fClockError;
+                    m_fClockError = 0;
+
+                    if ( fMaxDrift > 0 && fabs( fClockError ) > CLOCK_RESYNC )
+                    {
+                        ++m_nClockResyncs;
+#if defined(_DEBUG)
+                        gPlugin->LogAlways( "Clock resync id(%d) video(%.2fs) sound(%.2fs)", m_nVideoId, m_fTimer, fSoundPos );
+#endif
+                    }
+                }
+
+                else
+                {
+                    // the sound position only updates in blocks, so follow the system time
+                    // and pull the video towards the low-passed sound position by adjusting the playback rate slightly
+                    m_fClockError = m_fClockError * 0.9f + fClockError * 0.1f;
+                    m_fClockErrorMax = max( m_fClockErrorMax, float( fabs( fClockError ) ) );
+                    ++m_nClockSynced;
+
+                    // (proportional: 10ms error = 1% faster, closes the error within about a second)
+                    float fCorrection = min( max( m_fClockError, -fMaxDrift ), fMaxDrift );
+                    fActualDelta = fSystemDelta * ( 1.0f + fCorrection );
+                }
 
                 // needed if sound end should trigger end/loop event
                 if ( fActualDelta < -VIDEO_TIMEOUT )
@@ -681,6 +1858,22 @@ namespace VideoplayerPlugin
                 fActualDelta = max( fDeltaTime, VIDEO_EPSILON ); // use game time or fall back
             }
 
+            // negative speeds play backwards from the GOP caches (the speed only applies without sound)
+            if ( m_fSpeed < 0.0f && !m_Sound.IsActive() )
+            {
+                AdvanceReverse( fActualDelta );
+                return;
+            }
+
+            else if ( m_bReverse )
+            {
+                // forward again from the position reached backwards
+                float fPos = m_fTimer;
+                StopReverse();
+                Seek( fPos );
+                return;
+            }
+
             // Handle cases related to video end
             float fEnd = GetEnd();
 
@@ -701,63 +1894,269 @@ namespace VideoplayerPlugin
 
             m_fTimer += max( fActualDelta, 0.0f );
 
-            // CryLogAlways(PLUGIN_CONSOLE_PREFIX "Advance id(%d) delta(%.2fs) current(%.2fs) target(%.2fs)", m_nVideoId, fActualDelta, m_fTimerNextFrame, m_fTimer);
+            if ( ( !m_bVisible && m_eVP == VVP_ClockOnlyWhenHidden ) || gVideoplayerSystem->IsLoadPaused( GetPriorityClass() ) )
+            {
+                // only the clock advances, decoding and conversion are skipped while hidden or degraded by the load
+                m_bHiddenClock = true;
+
+                if ( fEnd > VIDEO_EPSILON && m_fTimer > fEnd )
+                {
+                    goto videoend;
+                }
+
+                return;
+            }
+
+            if ( m_bHiddenClock )
+            {
+                m_bHiddenClock = false;
+
+                // visible again, resync with a keyframe seek instead of decoding everything in between
+                if ( m_fTimer - m_fTimerNextFrame >= GetFrameDuration() )
+                {
+#if defined(_DEBUG)
+                    gPlugin->LogAlways( "Visible id(%d) resync current(%.2fs) target(%.2fs)", m_nVideoId, m_fTimerNextFrame, m_fTimer );
+#endif
+                    Seek( m_fTimer );
+                    return;
+                }
+            }
+
+            // the frame presented by this update is displayed with the next engine frame
+            if ( fActualDelta > 0.0f )
+            {
+                m_fFramePeriod = m_fFramePeriod > 0.0f ? m_fFramePeriod * 0.9f + 0.1f * fActualDelta : fActualDelta;
+            }
+
+            float fDisplay = m_fTimer + m_fFramePeriod;
+
+            // the first GOP of looping videos is decoded once on a worker, so looping doesn't have to wait for a seek and keyframe decode
+            if ( !m_bLoopWorking && m_nLoopCached == 0 && m_decoder.m_bLoop && gVideoplayerSystem->vp_loopbudget > 0 && !IsLive() )
+            {
+                // all videos share the budget, videos finding less than a frame left seek when looping
+                m_nLoopReserved = gVideoplayerSystem->ReserveLoopBudget( size_t( m_decoder.m_nWidth ) * m_decoder.m_nHeight * 3 / 2 );
+
+                if ( m_nLoopReserved > 0 )
+                {
+                    m_bLoopWorking = true;
+                    m_evLoop.reset();
+                    Concurrency::CurrentScheduler::ScheduleTask( &CWebMWrapper::FillLoopCache, this );
+                }
+
+                else
+                {
+                    m_nLoopCached = -1;
+                }
+            }
+
+            // once filled only the cached frames keep their share of the budget
+            else if ( m_nLoopReserved > m_LoopCache.getBytes() && m_nLoopCached != 0 && !m_bLoopWrapped && ( !m_bLoopWorking || m_evLoop.wait( 0 ) == 0 ) )
+            {
+                gVideoplayerSystem->ReleaseLoopBudget( m_nLoopReserved - m_LoopCache.getBytes() );
+                m_nLoopReserved = m_LoopCache.getBytes();
+            }
+
+            // after a seamless loop the start is presented from the loop cache
+            if ( m_bLoopWrapped && AdvanceLoop( fDisplay ) )
+            {
+                return;
+            }
+
+            // decimation and trick mode switch the decoder, so they wait until AdvanceLoop joined the loop worker
+            unsigned nDecimation = GetDecimation();
+            bool bTrickMode = IsTrickMode();
 
-            float fDifference = max( 0.0f, m_fTimer - m_fTimerNextFrame );
+            if ( nDecimation != m_nDecimation || bTrickMode != m_bTrickMode )
+            {
+                bool bWasKeyframesOnly = m_nDecimation == 0 || m_bTrickMode;
+
+                m_nDecimation = nDecimation;
+                m_nDecimationCounter = 0;
+                m_bTrickMode = bTrickMode;
+                m_decoder.m_bKeyframesOnly = nDecimation == 0 || bTrickMode;
+
+                // trick mode reuses the decoder image, so a frame decoded ahead isn't valid anymore
+                if ( bTrickMode )
+                {
+                    m_pAheadImg = NULL;
+                }
+
+                // frames since the last keyframe were never decoded, so seek back to it and catch up using the drop modes
+                if ( bWasKeyframesOnly && !m_decoder.m_bKeyframesOnly )
+                {
+                    Seek( m_fTimer );
+                    return;
+                }
+            }
+
+            // frames are scheduled by their timestamps, so variable framerates don't cause drops
+            float fNext = m_pAheadImg ? m_fAheadPos : m_decoder.peekPosition();
+            bool bDirty;
+
+            if ( fNext < 0.0f )
+            {
+                // the decoder handles end and loop once the last frame was displayed for its duration
+                if ( fDisplay >= m_decoder.getPosition() + GetFrameDuration() && !WrapLoop() )
+                {
+                    m_decoder.readFrame( NULL, bDirty, false, true );
+                }
+
+                return;
+            }
+
+            m_fTimerNextFrame = fNext;
+
+            // fast-forward reads up to the display time but only decodes the newest keyframe, so the cost scales with the keyframes instead of the frames
+            if ( m_bTrickMode )
+            {
+                vpx_image_t* img = NULL;
+
+                if ( fNext <= fDisplay && m_decoder.readKeyframe( &img, bDirty, fDisplay ) == EXIT_SUCCESS && img )
+                {
+                    ++m_nTrickFrames;
+
+                    if ( m_VRenderer )
+                    {
+                        m_VRenderer->RenderFrame( img );
+                    }
+                }
+
+                return;
+            }
+
+            // CryLogAlways(PLUGIN_CONSOLE_PREFIX "Advance id(%d) delta(%.2fs) next(%.2fs) display(%.2fs)", m_nVideoId, fActualDelta, fNext, fDisplay);
+
+            float fDifference = max( 0.0f, fDisplay - fNext );
 
             // Which actions should be taken
             bool bNeedSeek = fDifference >= gVideoplayerSystem->vp_seekthreshold;
-            bool bNeedDrop = fDifference >= gVideoplayerSystem->vp_dropthreshold;
-
-            unsigned uFrames = 0.5f + ( fDifference / GetFrameDuration() );
-            unsigned uMaxDrop = 0.5f + ( gVideoplayerSystem->vp_dropmaxduration / GetFrameDuration() );
+            bool bNeedDrop = fDifference >= gVideoplayerSystem->vp_dropthreshold && ( m_eDM & ( VDM_Drop | VDM_DropOutput ) );
 
             if ( bNeedSeek && ( m_eDM & VDM_Seek ) )
             {
                 // Trigger seek
 #ifdef _DEBUG
-                gPlugin->LogWarning( "Advance Seek id(%d) frames(%u) diff(%.2f) current(%.2fs) target(%.2fs)",  m_nVideoId, uFrames, fDifference, m_fTimerNextFrame, m_fTimer );
+                gPlugin->LogWarning( "Advance Seek id(%d) diff(%.2f) next(%.2fs) display(%.2fs)",  m_nVideoId, fDifference, fNext, fDisplay );
 #endif
 
                 Seek( m_fTimer );
                 return;
             }
 
-            bool bDirty;
+#ifdef _DEBUG
 
-            if ( bNeedDrop && ( m_eDM & ( VDM_Drop | VDM_DropOutput ) ) )
+            if ( bNeedDrop )
             {
-                // Trigger frame drop
-#ifdef _DEBUG
-                gPlugin->LogWarning( "Advance Drop id(%d) frames(%u) diff(%.2f) current(%.2fs) target(%.2fs)",  m_nVideoId, uFrames, fDifference, m_fTimerNextFrame, m_fTimer );
+                gPlugin->LogWarning( "Advance Drop id(%d) diff(%.2f) next(%.2fs) display(%.2fs)",  m_nVideoId, fDifference, fNext, fDisplay );
+            }
+
 #endif
 
-                // read until one frame to be rendered is left (drop data) or the max drop duration is reached
-                while ( uFrames > 1 && uMaxDrop > 0 )
+            vpx_image_t* img = NULL;
+            vpx_usec_timer tFrame;
+            float fDecode = 0.0f;
+            float fDropUntil = fNext + gVideoplayerSystem->vp_dropmaxduration; // drop at most x seconds before outputting again
+            bool bRead = false;
+
+            // read the due frames, a frame whose successor is due as well is late
+            while ( fNext >= 0.0f && fNext <= fDisplay )
+            {
+                if ( bRead )
+                {
+                    // without dropping the late frame is presented and the next ones follow with the next updates
+                    if ( !bNeedDrop || fNext > fDropUntil )
+                    {
+                        break;
+                    }
+
+                    if ( img )
+                    {
+                        ++m_nFramesDropped;
+                    }
+                }
+
+                // frame decoded ahead by a previous update
+                if ( m_pAheadImg )
+                {
+                    img = m_pAheadImg;
+                    m_pAheadImg = NULL;
+                    fNext = m_decoder.peekPosition();
+                    bRead = true;
+                    continue;
+                }
+
+                // temporal decimation only decodes frames that are not presented (keyframes only mode is handled by the decoder)
+                bool bPresent = m_nDecimation <= 1 || ( m_nDecimationCounter++ % m_nDecimation ) == 0;
+
+                vpx_usec_timer_start( &tFrame );
+
+                if ( m_decoder.readFrame( bPresent ? &img : NULL, bDirty ) )
+                {
+                    img = NULL;
+                    break;
+                }
+
+                vpx_usec_timer_mark( &tFrame );
+                fDecode = float( vpx_usec_timer_elapsed( &tFrame ) ) / MICROSECOND;
+
+                img = bDirty ? img : NULL;
+                fNext = m_decoder.peekPosition();
+                bRead = true;
+
+                if ( !img && m_nDecimation != 1 )
                 {
-                    // TODO: see http://code.google.com/p/webm/issues/detail?id=471
-                    //m_decoder.readFrame( NULL, bDirty, m_eDM & VDM_Drop, m_eDM & VDM_DropOutput ); // drop frame
-                    m_decoder.readFrame( NULL, bDirty, false, true ); // drop frame
-                    --uFrames;
-                    --uMaxDrop;
+                    ++m_nFramesDecimated;
                 }
             }
 
-            // output the current frame
-            if ( uFrames )
+            // present the newest due frame
+            if ( img )
             {
-                vpx_image_t* img = NULL;
+                ++m_nFramesPresented;
 
-                // decode the next frame
-                if ( !m_decoder.readFrame( &img, bDirty ) )
+                if ( fNext >= 0.0f && fNext <= fDisplay )
                 {
-                    m_fTimerNextFrame = m_decoder.getPosition() + GetFrameDuration(); // output next frame
+                    ++m_nFramesLate;
+                }
 
-                    // decoded frame needs now to be transfered into video memory
-                    if ( m_VRenderer && img && bDirty )
+                // decoded frame needs now to be transfered into video memory
+                if ( m_VRenderer )
+                {
+                    if ( fDecode > 0.0f )
                     {
-                        m_VRenderer->RenderFrame( img ); // let the video renderer handle this
+                        m_fDecodeTime = m_fDecodeTime * 0.9f + 0.1f * fDecode;
+                        m_statDecode.Add( fDecode * MICROSECOND );
                     }
+
+                    vpx_usec_timer_start( &tFrame );
+                    m_VRenderer->RenderFrame( img ); // let the video renderer handle this
+                    vpx_usec_timer_mark( &tFrame );
+                    m_fConvertTime = m_fConvertTime * 0.9f + 0.1f * float( vpx_usec_timer_elapsed( &tFrame ) ) / MICROSECOND;
+                    m_statConvert.Add( float( vpx_usec_timer_elapsed( &tFrame ) ) );
+                }
+            }
+
+            // nothing was due: decode ahead when the next frame is due with the following engine frame, so only its conversion is left then
+            if ( !bRead && !m_pAheadImg && fNext >= 0.0f && fNext <= fDisplay + m_fFramePeriod )
+            {
+                bool bPresent = m_nDecimation <= 1 || ( m_nDecimationCounter++ % m_nDecimation ) == 0;
+
+                vpx_usec_timer_start( &tFrame );
+
+                if ( !m_decoder.readFrame( bPresent ? &img : NULL, bDirty ) && img && bDirty )
+                {
+                    vpx_usec_timer_mark( &tFrame );
+                    m_fDecodeTime = m_fDecodeTime * 0.9f + 0.1f * float( vpx_usec_timer_elapsed( &tFrame ) ) / MICROSECOND;
+                    m_statDecode.Add( float( vpx_usec_timer_elapsed( &tFrame ) ) );
+
+                    m_pAheadImg = img;
+                    m_fAheadPos = m_decoder.getPosition();
+                    ++m_nFramesEarly;
+                }
+
+                else if ( m_nDecimation != 1 )
+                {
+                    ++m_nFramesDecimated;
                 }
             }
         }
@@ -765,6 +2164,13 @@ namespace VideoplayerPlugin
         return;
 
 videoend:
+
+        if ( WrapLoop() )
+        {
+            return;
+        }
+
+        StopLoop();
         OnEnd(); // dispatch events to listeners
 
         if ( m_decoder.m_bLoop )
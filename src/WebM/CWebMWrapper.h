@@ -4,9 +4,12 @@
 #include <IPluginVideoplayer.h>
 
 #include <CVideoplayerSystem.h>
+#include <CVideoStatWindow.h>
 #include <WebM/vpxdec_ext.h>
+#include <WebM/vpxdec_gop.h>
 #include <Sound/CCE3SoundWrapper.h>
 #include <Renderer/CVideoRenderer.h>
+#include <concrt.h>
 
 #pragma once
 
@@ -18,11 +21,29 @@ namespace VideoplayerPlugin
     */
     class CWebMWrapper :
         public IVideoplayer,
-        private IVideoplayerEventListener
+        private IVideoplayerEventListener,
+        private IVPXDecListener
     {
         private:
             std::vector<IVideoplayerEventListener*>     vecQueue; //!< Event listeners
             float GetFrameDuration(); //!< Frametime (1 / FPS)
+            int GetFrameId(); //!< Current renderer frame (0 without renderer)
+            bool UpdateVisibility(); //!< Check if any output was rendered recently
+            unsigned GetDecimation(); //!< Present every nth frame (0 only keyframes) based on distance and load
+            unsigned GetDistanceDecimation(); //!< Present every nth frame (0 only keyframes) based on distance
+            bool IsLive(); //!< Input is live @see VTS_Live @see VDM_Live
+            void AdvanceLive( float fDeltaTime ); //!< Present frames of a live input as they arrive
+            bool IsTrickMode(); //!< Speed is high enough to present only keyframes @see vp_trickspeed
+            void AdvanceReverse( float fDeltaTime ); //!< Present cached frames backwards and prefetch the previous GOP
+            void StopReverse(); //!< Wait for the prefetch and free the GOP caches
+            static void PrefetchReverse( void* pWrapper ); //!< Worker task decoding the GOP before the presented one
+            bool WrapLoop(); //!< Loop by presenting the loop cache while a worker positions the decoder behind it (false if the cache isn't ready)
+            bool AdvanceLoop( float fDisplay ); //!< Present the loop cache after a seamless loop (false once the decoder takes over again)
+            void StopLoop(); //!< Wait for the loop worker and hand the playback back to the decoder
+            static void FillLoopCache( void* pWrapper ); //!< Worker task decoding the first GOP into the loop cache
+            static void ResumeLoop( void* pWrapper ); //!< Worker task positioning the decoder behind the loop cache
+            bool IsLoopResuming(); //!< The loop worker owns the decoder, only the values cached by WrapLoop may be reported
+            bool WakeUp(); //!< Reopen decoder and renderer of a hibernated video with a keyframe seek to the remembered position
 
         public:
             CWebMWrapper( int nVideoId );
@@ -32,6 +53,49 @@ namespace VideoplayerPlugin
             bool ReleaseResources( bool bResetOverride = false );
             bool CreateResources();
 
+            /**
+            * @brief Memory held by this video
+            * @param[out] nDecoder bytes of the decoder frame buffers and frame caches
+            * @param[out] nStaging bytes of the conversion buffer
+            * @param[out] nTexture bytes of the texture
+            * @return total bytes
+            */
+            size_t GetMemoryUsage( size_t& nDecoder, size_t& nStaging, size_t& nTexture );
+
+            /**
+            * @brief Seconds the video is paused or hidden without any rendered output
+            * @return -1 if it can't hibernate (playing, visible, live or already hibernating)
+            */
+            float GetIdleTime();
+
+            /**
+            * @brief Priority class used by the scheduler
+            * @return the set class, VPR_Auto is resolved by the outputs
+            */
+            eVideoPriority GetPriorityClass();
+
+            /**
+            * @brief Free decoder and renderer but remember the position, restored by Resume
+            * @return hibernated
+            */
+            bool Hibernate();
+
+            /**
+            * @brief Crossfade into another video, its frames are blended into the texture of this one
+            * The other video counts as visible through the outputs of this one.
+            * @param pSource incoming video (same size), NULL stops the crossfade
+            * @param fWeight weight of the incoming video (0-1)
+            * @return blending
+            */
+            bool Crossfade( CWebMWrapper* pSource, float fWeight );
+
+            /**
+            * @brief Decode and convert the first frame of a paused video, so it is shown as soon as the video resumes
+            * The start event is held back until then.
+            * @return first frame is ready
+            */
+            bool Prepare();
+
             // IMediaPlayback
             virtual bool ReOpen();
             virtual void SetSpeed( float fSpeed = 1.0f );
@@ -52,10 +116,17 @@ namespace VideoplayerPlugin
             // IVideoplayer
             virtual bool Open( const char* sFile, const char* sSound = "", bool bLoop = false, bool bSkippable = true, bool bBlockGame = false, eTimeSource eTS = VTS_Default, eDropMode eDM = VDM_Default, float fStartAt = 0, float fEndAfter = 0, int nCustomWidth = -1, int nCustomHeight = -1 );
             virtual void SetTimesource( eTimeSource eTS = VTS_Default );
+            virtual void SetVisibilityPolicy( eVisibilityPolicy eVP = VVP_Default );
+            virtual eVisibilityPolicy GetVisibilityPolicy();
+            virtual void SetPriority( eVideoPriority ePriority = VPR_Default );
+            virtual eVideoPriority GetPriority();
+            virtual bool IsVisible();
+            virtual void TrackVisibility( EntityId nEntityId, bool bTrack = true );
             virtual bool OverrideMaterial( SMaterialOverride& mOverride );
             virtual void Draw2D( S2DVideo& info );
             virtual ITexture* GetTexture();
             virtual float GetFPS();
+            virtual bool GetStats( SVideoStats& stats );
             virtual unsigned GetHeight();
             virtual unsigned GetWidth();
             virtual ISoundplayer* GetSoundplayer();
@@ -87,6 +158,7 @@ namespace VideoplayerPlugin
             CCE3SoundWrapper m_Sound; //!< Sound output of this video
 
             IVideoRenderer* m_VRenderer; //!< Video render for this video
+            bool m_bRendererReused; //!< video renderer came from the pool
 
             int m_nVideoId; //!< video id
             bool m_bPaused; //!< currently paused
@@ -105,5 +177,104 @@ namespace VideoplayerPlugin
 
             eTimeSource m_eTS; //!< time source to be used
             eDropMode m_eDM; //!< active drop mode
+
+            eVisibilityPolicy m_eVP; //!< behaviour while hidden
+            std::vector<EntityId> m_vecVisibilityEntities; //!< entities whose render nodes show this video
+            int m_nLastVisibleFrame; //!< last renderer frame an output of this video was rendered
+            bool m_bVisible; //!< result of the last visibility check
+            bool m_bHiddenPaused; //!< paused because of the visibility policy
+            bool m_bHiddenClock; //!< decoding was skipped because of the visibility policy or the load (resync needed)
+            eVideoPriority m_ePriority; //!< priority class under load
+
+            int m_nLast2DFrame; //!< last renderer frame a 2D output of this video was drawn
+            float m_fDistance; //!< distance to the nearest tracked entity (-1 if unknown)
+            float m_fDecimationScale; //!< smallest distance scale of the material overrides
+            unsigned m_nDecimation; //!< present every nth frame (0 only keyframes)
+            unsigned m_nDecimationCounter; //!< frames since the decimation level changed
+            unsigned m_nFramesDecimated; //!< frames not converted/uploaded because of decimation
+            float m_fDecodeTime; //!< average decode time of a presented frame in seconds
+            float m_fConvertTime; //!< average conversion time of a presented frame in seconds
+
+            float m_fFramePeriod; //!< average media time between updates, predicts when the next engine frame is displayed
+            vpx_image_t* m_pAheadImg; //!< frame decoded ahead of its deadline, presented by a later update
+            float m_fAheadPos; //!< timestamp of the frame decoded ahead
+            unsigned m_nFramesPresented; //!< frames presented by the deadline scheduler
+            unsigned m_nFramesEarly; //!< frames decoded ahead of their deadline
+            unsigned m_nFramesLate; //!< frames presented after the deadline of their successor
+            unsigned m_nFramesDropped; //!< late frames that were decoded but never presented
+
+            bool m_bPrepared; //!< first frame was presented while paused @see Prepare
+            bool m_bPreparing; //!< Prepare is reading the first frame
+            bool m_bStartPending; //!< start event of a prepared video, dispatched once it resumes
+
+            bool m_bTrickMode; //!< fast-forward presenting only keyframes
+            unsigned m_nTrickFrames; //!< keyframes presented in trick mode
+
+            bool m_bReverse; //!< playing backwards from the GOP caches
+            bool m_bReverseStart; //!< playing backwards reached the first frame
+            VPXDecGOPCache m_ReverseCache[2]; //!< presented GOP and the GOP before it (prefetched by a worker)
+            unsigned m_nReverseFront; //!< index of the presented GOP cache
+            bool m_bReversePrefetching; //!< worker is decoding the GOP before the presented one
+            Concurrency::event m_evReversePrefetch; //!< set when the worker finished the prefetch
+            float m_fReversePrefetchEnd; //!< the prefetch decodes the frames before this position
+            size_t m_nReverseBudget; //!< bytes available to each GOP cache
+            int m_nReversePrefetched; //!< frames cached by the last prefetch (-1 on errors)
+            vpx_image_t* m_pReverseImg; //!< frame presented last while playing backwards
+            unsigned m_nReverseFrames; //!< frames presented backwards
+            unsigned m_nReverseDecoded; //!< frames decoded into the GOP caches
+            unsigned m_nReverseStalls; //!< times playback had to wait for the prefetch
+
+            VPXDecGOPCache m_LoopCache; //!< first GOP of a looping video, decoded once by a worker
+            bool m_bLoopWorking; //!< worker is filling the loop cache or positioning the decoder
+            Concurrency::event m_evLoop; //!< set when the loop worker finished
+            int m_nLoopCached; //!< frames in the loop cache (0 not filled yet, -1 not supported)
+            size_t m_nLoopReserved; //!< bytes of the global loop budget held by this video @see CVideoplayerSystem::ReserveLoopBudget
+            float m_fLoopResume; //!< the decoder continues at this position after the cached frames (-1 the whole video is cached)
+            bool m_bLoopWrapped; //!< presenting the loop cache, the decoder is used by the worker
+            vpx_image_t* m_pLoopImg; //!< frame of the loop cache presented last
+            unsigned m_nLoopWraps; //!< seamless loops
+            unsigned m_nLoopStalls; //!< times playback had to wait for the decoder after a seamless loop
+            float m_fLoopStart; //!< start reported while the worker positions the decoder
+            float m_fLoopEnd; //!< end reported while the worker positions the decoder
+            float m_fLoopDuration; //!< duration reported while the worker positions the decoder
+            float m_fLoopFPS; //!< framerate reported while the worker positions the decoder
+            unsigned m_nLoopWidth; //!< decoder width reported while the worker positions the decoder
+            unsigned m_nLoopHeight; //!< decoder height reported while the worker positions the decoder
+            size_t m_nLoopMemory; //!< decoder memory reported while the worker positions the decoder
+            string m_sLoopFile; //!< file reported while the worker positions the decoder
+            uint64 m_nLoopBytesRead; //!< bytes read reported while the worker positions the decoder
+            unsigned m_nLoopFramesDecoded; //!< decoded frames reported while the worker positions the decoder
+            unsigned m_nLoopFramesSkipped; //!< skipped frames reported while the worker positions the decoder
+
+            float m_fClockError; //!< low-passed difference between sound and video clock in seconds
+            float m_fClockErrorMax; //!< largest raw difference between sound and video clock while filtered
+            unsigned m_nClockSynced; //!< updates that followed the filtered sound clock
+            unsigned m_nClockResyncs; //!< times the video jumped to the sound position (discontinuities)
+
+            CVideoStatWindow m_statDecode; //!< decode time per decoder call in microseconds
+            CVideoStatWindow m_statConvert; //!< conversion time per presented frame in microseconds
+            CVideoStatWindow m_statUpload; //!< texture upload time in microseconds
+            CVideoStatWindow m_statClock; //!< absolute sound clock error in milliseconds
+            unsigned m_nSeeks; //!< seeks since open
+
+            bool m_bHibernating; //!< decoder and renderer are freed until the video resumes
+            float m_fIdleSince; //!< time the video was paused, hidden or last visible while paused
+            float m_fHibernatePos; //!< position the video continues at
+            string m_sHibernateFile; //!< file reopened on wake up
+            bool m_bHibernateLoop; //!< loop setting of the decoder
+            float m_fHibernateStart; //!< custom start of the decoder
+            float m_fHibernateEnd; //!< custom end of the decoder
+            float m_fHibernateDuration; //!< duration reported while hibernating
+            unsigned m_nHibernations; //!< times the video hibernated
+
+            vpx_usec_timer m_liveTimer; //!< wall clock since the first frame of a live input
+            bool m_bLiveCatchup; //!< live input lags too far behind, reading without decoding until the next keyframe
+            float m_fLiveOffset; //!< smallest difference between wall clock and stream position (frame without input delay)
+            float m_fLiveLag; //!< how far the newest read frame lags behind the input in seconds
+            unsigned m_nLiveFramesRead; //!< frames read from the live input
+            unsigned m_nLiveFrames; //!< live frames presented
+            unsigned m_nLiveCatchups; //!< times the live input skipped ahead to the next keyframe
+            float m_fLiveLatencySum; //!< sum of the glass-to-glass latencies of the presented live frames in seconds
+            float m_fLiveLatencyMax; //!< largest glass-to-glass latency of a presented live frame in seconds
     };
 }
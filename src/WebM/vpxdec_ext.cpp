@@ -2,35 +2,176 @@
 * based on libvpx - vpxdec.c
 */
 
-#include <StdAfx.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdarg.h>
 #include <string.h>
 #include <limits.h>
-
-#include <CPluginVideoplayer.h>
+#include <algorithm>
 
 #include "vpxdec_ext.h"
 
+#if defined(_WIN32)
+#include <windows.h>
+#include <io.h>
+#else
+#include <sys/stat.h>
+#include <sys/ioctl.h>
+#endif
+
+#if defined(_MSC_VER)
 #pragma comment(lib, "vpxmt.lib") // link the library (libvpx)
 //#pragma comment(lib, "vpxmtd.lib") // debug versions for stack trace regarding eider crash
+#endif
+
+namespace VideoplayerPlugin
+{
+    /**
+    * @brief Default file access (stdio)
+    */
+    class CVPXDecStdIO :
+        public IVPXDecIO,
+        public IVPXDecLog
+    {
+        public:
+            virtual FILE* Open( const char* sFile, const char* sMode )
+            {
+                return fopen( sFile, sMode );
+            };
+
+            virtual size_t Read( void* pData, size_t nSize, size_t nCount, FILE* pFile )
+            {
+                return fread( pData, nSize, nCount, pFile );
+            };
+
+            virtual int Seek( FILE* pFile, long nOffset, int nMode )
+            {
+                return fseek( pFile, nOffset, nMode );
+            };
+
+            virtual long Tell( FILE* pFile )
+            {
+                return ftell( pFile );
+            };
+
+            virtual int Eof( FILE* pFile )
+            {
+                return feof( pFile );
+            };
+
+            virtual int Error( FILE* pFile )
+            {
+                return ferror( pFile );
+            };
+
+            virtual int Close( FILE* pFile )
+            {
+                return fclose( pFile );
+            };
+
+            virtual size_t ReadAvailable( void* pData, size_t nSize, FILE* pFile )
+            {
+                // pipes block until data arrives, so only the bytes waiting in the pipe are read (unbuffered)
+#if defined(_WIN32)
+                HANDLE hFile = ( HANDLE )_get_osfhandle( _fileno( pFile ) );
+
+                if ( GetFileType( hFile ) == FILE_TYPE_PIPE )
+                {
+                    DWORD nAvail = 0;
+                    DWORD nRead = 0;
+
+                    if ( !PeekNamedPipe( hFile, NULL, 0, NULL, &nAvail, NULL ) || !nAvail )
+                    {
+                        return 0;
+                    }
+
+                    return ReadFile( hFile, pData, DWORD( std::min<size_t>( nSize, nAvail ) ), &nRead, NULL ) ? nRead : 0;
+                }
+
+#else
+                struct stat st;
+
+                if ( fstat( fileno( pFile ), &st ) == 0 && S_ISFIFO( st.st_mode ) )
+                {
+                    int nAvail = 0;
+
+                    if ( ioctl( fileno( pFile ), FIONREAD, &nAvail ) || nAvail <= 0 )
+                    {
+                        return 0;
+                    }
+
+                    ssize_t nRead = read( fileno( pFile ), pData, std::min<size_t>( nSize, nAvail ) );
+                    return nRead > 0 ? size_t( nRead ) : 0;
+                }
+
+#endif
+                size_t nRead = fread( pData, 1, nSize, pFile );
+
+                // a growing file only reached the end for now
+                if ( nRead < nSize )
+                {
+                    clearerr( pFile );
+                }
+
+                return nRead;
+            };
+
+            virtual bool IsAvailable()
+            {
+                return true;
+            };
+
+            virtual void LogV( eVPXDecLogLevel eLevel, const char* sFormat, va_list args )
+            {
+                vfprintf( stderr, sFormat, args );
+                fputc( '\n', stderr ); // messages are lines like in the engine log
+            };
+    } gVPXDecStdIO;
+
+    IVPXDecIO* pVPXDecIO = &gVPXDecStdIO; //!< file access of all decoders
+    IVPXDecLog* pVPXDecLog = &gVPXDecStdIO; //!< message output of all decoders
+
+    void setVPXDecIO( IVPXDecIO* pIO )
+    {
+        pVPXDecIO = pIO ? pIO : &gVPXDecStdIO;
+    }
+
+    IVPXDecIO* getVPXDecIO()
+    {
+        return pVPXDecIO;
+    }
+
+    IVPXDecIO* getVPXDecStdIO()
+    {
+        return &gVPXDecStdIO;
+    }
+
+    void setVPXDecLog( IVPXDecLog* pLog )
+    {
+        pVPXDecLog = pLog ? pLog : &gVPXDecStdIO;
+    }
 
-// Override File Operations for CryEngine to support pak files
-#include <platform.h>
-#include <ICryPak.h>
-#define fread gEnv->pCryPak->FReadRaw
-#define fopen gEnv->pCryPak->FOpen
-#define fclose gEnv->pCryPak->FClose
-#define fseek gEnv->pCryPak->FSeek
-#define ftell gEnv->pCryPak->FTell
-#define feof gEnv->pCryPak->FEof
-#define ferror gEnv->pCryPak->FError
-#define rewind(stream) gEnv->pCryPak->FSeek(stream, 0L, SEEK_SET)
-
-// Override Error Log for CryEngine
-#define fprintf(fh, fmt, ...) gPlugin->LogError( fmt, __VA_ARGS__ )
-#define vfprintf(fh, fmt, args) gEnv->pLog->LogV( ILog::eAlways, format, args )
+    void logVPXDec( eVPXDecLogLevel eLevel, const char* sFormat, ... )
+    {
+        va_list args;
+        va_start( args, sFormat );
+        pVPXDecLog->LogV( eLevel, sFormat, args );
+        va_end( args );
+    }
+}
+
+// Redirect File Operations (the plugin uses the CryPak to support pak files)
+#define fread(data, size, count, stream) VideoplayerPlugin::pVPXDecIO->Read(data, size, count, stream)
+#define fopen(file, mode) VideoplayerPlugin::pVPXDecIO->Open(file, mode)
+#define fclose(stream) VideoplayerPlugin::pVPXDecIO->Close(stream)
+#define fseek(stream, offset, origin) VideoplayerPlugin::pVPXDecIO->Seek(stream, offset, origin)
+#define ftell(stream) VideoplayerPlugin::pVPXDecIO->Tell(stream)
+#define feof(stream) VideoplayerPlugin::pVPXDecIO->Eof(stream)
+#define ferror(stream) VideoplayerPlugin::pVPXDecIO->Error(stream)
+#define rewind(stream) VideoplayerPlugin::pVPXDecIO->Seek(stream, 0L, SEEK_SET)
+
+// Redirect Error Log
+#define fprintf(fh, fmt, ...) VideoplayerPlugin::logVPXDec( VideoplayerPlugin::VLL_ERROR, fmt, ##__VA_ARGS__ )
 
 #define VP8_FOURCC (0x00385056)
 
@@ -98,6 +239,202 @@ namespace VideoplayerPlugin
         return val;
     }
 
+    /**
+    * @brief Boolean entropy decoder of the VP8 frame header (RFC 6386 section 7)
+    */
+    struct vp8_bool_decoder
+    {
+        const uint8_t* input;
+        const uint8_t* end;
+        unsigned int value;
+        unsigned int range;
+        int bit_count;
+    };
+
+    static void vp8_bool_init( vp8_bool_decoder* bd, const uint8_t* buf, size_t sz )
+    {
+        bd->input = buf;
+        bd->end = buf + sz;
+        bd->value = 0;
+        bd->range = 255;
+        bd->bit_count = 0;
+
+        for ( int i = 0; i < 2; ++i )
+        {
+            bd->value = ( bd->value << 8 ) | ( bd->input < bd->end ? *bd->input++ : 0 );
+        }
+    }
+
+    static int vp8_bool_read( vp8_bool_decoder* bd, int prob )
+    {
+        unsigned int split = 1 + ( ( ( bd->range - 1 ) * prob ) >> 8 );
+        unsigned int bigsplit = split << 8;
+        int bit;
+
+        if ( bd->value >= bigsplit )
+        {
+            bit = 1;
+            bd->range -= split;
+            bd->value -= bigsplit;
+        }
+
+        else
+        {
+            bit = 0;
+            bd->range = split;
+        }
+
+        while ( bd->range < 128 )
+        {
+            bd->value <<= 1;
+            bd->range <<= 1;
+
+            if ( ++bd->bit_count == 8 )
+            {
+                bd->bit_count = 0;
+                bd->value |= bd->input < bd->end ? *bd->input++ : 0;
+            }
+        }
+
+        return bit;
+    }
+
+    static int vp8_bool_literal( vp8_bool_decoder* bd, int bits )
+    {
+        int v = 0;
+
+        while ( bits-- )
+        {
+            v = ( v << 1 ) | vp8_bool_read( bd, 128 );
+        }
+
+        return v;
+    }
+
+    /**
+    * @brief Read optional signed values in the frame header (flag, magnitude, sign)
+    * @param[in,out] values updated values (NULL to skip them)
+    */
+    static void vp8_bool_deltas( vp8_bool_decoder* bd, int count, int bits, signed char* values )
+    {
+        for ( int i = 0; i < count; ++i )
+        {
+            if ( vp8_bool_read( bd, 128 ) )
+            {
+                int v = vp8_bool_literal( bd, bits );
+
+                if ( vp8_bool_read( bd, 128 ) )
+                {
+                    v = -v;
+                }
+
+                if ( values )
+                {
+                    values[i] = ( signed char )v;
+                }
+            }
+        }
+    }
+
+    /**
+    * @brief Parse the VP8 frame header to check if a frame can be skipped without affecting later frames
+    * Interframes that don't refresh/copy any reference buffer, discard their probability updates
+    * and don't change the persistent segmentation and loop filter delta state are droppable.
+    * @param[in] buf compressed frame
+    * @param[in] sz size of the compressed frame
+    * @param[in] lf_deltas loop filter deltas (4 reference, 4 mode) before this frame
+    * @param[out] new_lf_deltas loop filter deltas after this frame (if it is decoded)
+    * @return droppable
+    */
+    static bool vp8_frame_is_droppable( const uint8_t* buf, size_t sz, const signed char* lf_deltas, signed char* new_lf_deltas )
+    {
+        memcpy( new_lf_deltas, lf_deltas, VP8_LF_DELTAS );
+
+        // frame tag, keyframes have additional 7 bytes start code and dimensions
+        bool key = buf && sz >= 3 && !( buf[0] & 1 );
+        size_t offset = key ? 10 : 3;
+
+        if ( !buf || sz < offset )
+        {
+            return false;
+        }
+
+        vp8_bool_decoder bd;
+        vp8_bool_init( &bd, buf + offset, sz - offset );
+
+        if ( key )
+        {
+            // keyframes reset the loop filter deltas, color space and clamping type
+            memset( new_lf_deltas, 0, VP8_LF_DELTAS );
+            vp8_bool_literal( &bd, 2 );
+        }
+
+        bool droppable = !key;
+
+        // segmentation
+        if ( vp8_bool_read( &bd, 128 ) )
+        {
+            int update_map = vp8_bool_read( &bd, 128 );
+            int update_data = vp8_bool_read( &bd, 128 );
+
+            if ( update_data )
+            {
+                vp8_bool_literal( &bd, 1 ); // absolute or delta values
+                vp8_bool_deltas( &bd, 4, 7, NULL ); // quantizer
+                vp8_bool_deltas( &bd, 4, 6, NULL ); // loop filter
+            }
+
+            if ( update_map )
+            {
+                for ( int i = 0; i < 3; ++i )
+                {
+                    if ( vp8_bool_read( &bd, 128 ) )
+                    {
+                        vp8_bool_literal( &bd, 8 );
+                    }
+                }
+            }
+
+            droppable = droppable && !update_map && !update_data;
+        }
+
+        // loop filter type, level, sharpness
+        vp8_bool_literal( &bd, 1 + 6 + 3 );
+
+        // loop filter deltas (encoders in error resilient mode repeat them on every frame)
+        if ( vp8_bool_read( &bd, 128 ) && vp8_bool_read( &bd, 128 ) )
+        {
+            vp8_bool_deltas( &bd, VP8_LF_DELTAS, 6, new_lf_deltas );
+            droppable = droppable && memcmp( new_lf_deltas, lf_deltas, VP8_LF_DELTAS ) == 0;
+        }
+
+        if ( !droppable )
+        {
+            return false;
+        }
+
+        // partitions
+        vp8_bool_literal( &bd, 2 );
+
+        // quantizer indices (y ac, y dc, y2 dc, y2 ac, uv dc, uv ac)
+        vp8_bool_literal( &bd, 7 );
+        vp8_bool_deltas( &bd, 5, 4, NULL );
+
+        // reference buffer updates
+        int refresh_golden = vp8_bool_read( &bd, 128 );
+        int refresh_alt = vp8_bool_read( &bd, 128 );
+        int copy_golden = refresh_golden ? 0 : vp8_bool_literal( &bd, 2 );
+        int copy_alt = refresh_alt ? 0 : vp8_bool_literal( &bd, 2 );
+
+        // sign bias golden, altref
+        vp8_bool_literal( &bd, 2 );
+
+        int refresh_entropy = vp8_bool_read( &bd, 128 );
+        int refresh_last = vp8_bool_read( &bd, 128 );
+
+        return !refresh_golden && !refresh_alt && !copy_golden && !copy_alt && !refresh_entropy && !refresh_last;
+    }
+
     /**
     * @brief Read the next frame
     * @param[in] input Which file
@@ -106,6 +443,7 @@ namespace VideoplayerPlugin
     * @param[out] buf_alloc_sz buffer memory size
     * @param[out] fTimeStamp timestamp of frame read (WebM format)
     * @param[out] bEnd end reached
+    * @param[in] bLive the end of the file only means that no new data arrived yet (partial frames are no error)
     * @return success=0 error!=0
     */
     static int read_frame( struct input_ctx* input,
@@ -113,7 +451,8 @@ namespace VideoplayerPlugin
                            size_t* buf_sz,
                            size_t* buf_alloc_sz,
                            float* fTimeStamp,
-                           bool* bEnd )
+                           bool* bEnd,
+                           bool bLive = false )
     {
         char            raw_hdr[IVF_FRAME_HDR_SZ];
         size_t          new_buf_sz;
@@ -122,7 +461,24 @@ namespace VideoplayerPlugin
 
         *bEnd = false;
 
-        if ( kind == WEBM_FILE )
+        if ( kind == WEBM_STREAM )
+        {
+            // demux what arrived meanwhile, the jitter buffer keeps the frames until they are needed
+            if ( input->stream->pump() < 0 )
+            {
+                return 1;
+            }
+
+            if ( !input->stream->readFrame( buf, buf_sz, fTimeStamp ) )
+            {
+                *bEnd = true;
+                return 1;
+            }
+
+            return 0;
+        }
+
+        else if ( kind == WEBM_FILE )
         {
             if ( input->chunk >= input->chunks )
             {
@@ -229,7 +585,11 @@ namespace VideoplayerPlugin
         {
             if ( fread( *buf, 1, *buf_sz, infile ) != *buf_sz )
             {
-                fprintf( stderr, "Failed to read full frame\n" );
+                if ( !bLive )
+                {
+                    fprintf( stderr, "Failed to read full frame\n" );
+                }
+
                 *bEnd = true;
                 return 1;
             }
@@ -374,6 +734,7 @@ namespace VideoplayerPlugin
     */
     static int nestegg_read_cb( void* buffer, size_t length, void* userdata )
     {
+        VPXDEC_TRACE( "nestegg_read", -1 );
         FILE* f = ( FILE* )userdata;
 
         if ( fread( buffer, 1, length, f ) < length )
@@ -397,6 +758,8 @@ namespace VideoplayerPlugin
     */
     static int nestegg_seek_cb( int64_t offset, int whence, void* userdata )
     {
+        VPXDEC_TRACE( "nestegg_seek", -1 );
+
         switch ( whence )
         {
             case NESTEGG_SEEK_SET:
@@ -432,8 +795,7 @@ namespace VideoplayerPlugin
         {
             va_list ap;
             va_start( ap, format );
-            vfprintf( stderr, format, ap );
-            fprintf( stderr, "\n" );
+            pVPXDecLog->LogV( severity >= NESTEGG_LOG_ERROR ? VLL_ERROR : ( severity >= NESTEGG_LOG_WARNING ? VLL_WARNING : VLL_INFO ), format, ap );
             va_end( ap );
         }
     }
@@ -484,6 +846,14 @@ namespace VideoplayerPlugin
             fseek( input->infile, nFallbackPos, SEEK_SET );    //goto fail;
         }
 
+        if ( i < 2 || tstamp < 1000 )
+        {
+            // too short to guess
+            *fps_num = 30;
+            *fps_den = 1;
+            return 0;
+        }
+
         *fps_num = ( i - 1 ) * 1000000;
         *fps_den = tstamp / 1000;
         return 0;
@@ -605,11 +975,77 @@ fail:
         return 0;
     }
 
-    int VPXDec::open( char* fn, bool bLoop, float fStartAt, float fEndAfter, IVideoplayerEventListener* pBroadcast )
+    float probeVPXDecDuration( const char* sFile )
+    {
+        VPXDEC_TRACE( "probeDuration", -1 );
+
+        float fDuration = -1;
+        FILE* infile = fopen( sFile, "rb" );
+
+        if ( !infile )
+        {
+            return fDuration;
+        }
+
+        char raw_hdr[32];
+
+        if ( fread( raw_hdr, 1, 32, infile ) == 32 && raw_hdr[0] == 'D' && raw_hdr[1] == 'K' && raw_hdr[2] == 'I' && raw_hdr[3] == 'F' )
+        {
+            unsigned int fps_num = mem_get_le32( raw_hdr + 16 );
+            unsigned int fps_den = mem_get_le32( raw_hdr + 20 );
+            unsigned int frames = mem_get_le32( raw_hdr + 24 );
+
+            // same timebase correction as file_is_ivf
+            if ( fps_num < 1000 )
+            {
+                if ( fps_num & 1 )
+                {
+                    fps_den <<= 1;
+                }
+
+                else
+                {
+                    fps_num >>= 1;
+                }
+            }
+
+            if ( fps_num && fps_den && frames )
+            {
+                fDuration = float( double( frames ) * fps_den / fps_num );
+            }
+        }
+
+        else
+        {
+            rewind( infile );
+
+            nestegg* ctx = NULL;
+            nestegg_io io = {nestegg_read_cb, nestegg_seek_cb, nestegg_tell_cb,
+                             infile
+                            };
+            uint64_t nDuration = 0;
+
+            if ( 0 == nestegg_init( &ctx, io, NULL ) && 0 == nestegg_duration( ctx, &nDuration ) )
+            {
+                fDuration = nDuration / NANOSECOND;
+            }
+
+            if ( ctx )
+            {
+                nestegg_destroy( ctx );
+            }
+        }
+
+        fclose( infile );
+        return fDuration;
+    }
+
+    int VPXDec::open( char* fn, bool bLoop, float fStartAt, float fEndAfter, IVPXDecListener* pBroadcast, bool bLive )
     {
         int i;
         cleanup();
 
+        m_bLive = bLive;
         m_bLoop = bLoop;
         m_fStartAt = fStartAt;
         m_fEndAfter = fEndAfter;
@@ -752,9 +1188,28 @@ fail:
             goto error_open;
         }
 
+        m_sFile = fn;
+
         m_input.infile = m_infile;
 
-        if ( file_is_ivf( m_infile, &m_fourcc, &m_nWidth, &m_nHeight, &m_nFPSDen, &m_nFPSNum ) )
+        if ( bLive && EXIT_SUCCESS == m_stream.open( m_infile ) )
+        {
+            // live WebM can't be seeked, so it isn't parsed by nestegg
+            m_input.kind = WEBM_STREAM;
+            m_input.stream = &m_stream;
+            m_fourcc = VP8_FOURCC;
+            m_nWidth = m_stream.m_nWidth;
+            m_nHeight = m_stream.m_nHeight;
+            m_fDuration = -1;
+        }
+
+        else if ( bLive && fseek( m_infile, 0, SEEK_SET ) )
+        {
+            fprintf( stderr, "Live input '%s' is no WebM stream and can't be rewound (pipe).\n", fn );
+            goto error_open;
+        }
+
+        else if ( file_is_ivf( m_infile, &m_fourcc, &m_nWidth, &m_nHeight, &m_nFPSDen, &m_nFPSNum ) )
         {
             m_input.kind = IVF_FILE;
         }
@@ -864,16 +1319,16 @@ error_open:
         return EXIT_FAILURE;
     }
 
-    int VPXDec::seek( float fTimepos )
+    int VPXDec::seek( float fTimepos, bool bBroadcast )
     {
         if ( m_fStartAt > VIDEO_EPSILON )
         {
-            fTimepos = max( fTimepos, m_fStartAt );
+            fTimepos = std::max( fTimepos, m_fStartAt );
         }
 
         if ( m_fEndAfter > VIDEO_EPSILON )
         {
-            fTimepos = min( fTimepos, m_fEndAfter );
+            fTimepos = std::min( fTimepos, m_fEndAfter );
         }
 
         if ( fTimepos < VIDEO_EPSILON )
@@ -883,6 +1338,9 @@ error_open:
 
         if ( m_input.kind == WEBM_FILE && m_input.nestegg_ctx )
         {
+            // the frame read ahead is from the old position
+            m_bPeeked = false;
+
             uint64_t nPos = fTimepos * NANOSECOND;
             m_fPos = fTimepos;
             m_nFrameIn =  fTimepos * getFPS();
@@ -915,7 +1373,7 @@ error_open:
                 m_nHeight = ( m_nHeight >> RESBASE ) << RESBASE;
             }
 
-            if ( nRet == 0 && m_pBroadcast )
+            if ( nRet == 0 && m_pBroadcast && bBroadcast )
             {
                 m_pBroadcast->OnSeek();
             }
@@ -926,6 +1384,31 @@ error_open:
         return -1;
     }
 
+    int VPXDec::resumeAt( float fTimepos )
+    {
+        IVPXDecListener* pBroadcast = m_pBroadcast;
+        m_pBroadcast = NULL;
+
+        // without cues decoding has to start at the beginning
+        int nRet = seek( fTimepos ) ? seek( 0 ) : 0;
+        bool bDirty;
+        float fNext;
+
+        while ( nRet == 0 && ( fNext = peekPosition() ) >= 0.0f && fNext < fTimepos - VIDEO_EPSILON * 0.5f )
+        {
+            nRet = readFrame( NULL, bDirty, false, true );
+        }
+
+        m_pBroadcast = pBroadcast;
+        return nRet;
+    }
+
+    bool VPXDec::isKeyframe()
+    {
+        // VP8 frame tag: first bit cleared means keyframe
+        return m_buf && m_buf_sz > 0 && !( m_buf[0] & 1 );
+    }
+
     float VPXDec::getDuration()
     {
         return m_fDuration;
@@ -938,13 +1421,22 @@ error_open:
 
     float VPXDec::getFPS()
     {
+        // the framerate of live streams is refined as frames arrive
+        if ( m_input.kind == WEBM_STREAM )
+        {
+            m_stream.getFramerate( &m_nFPSDen, &m_nFPSNum );
+        }
+
         return float( m_nFPSNum ) / float( m_nFPSDen );
     }
 
     int VPXDec::readFrame( vpx_image_t** pData, bool& bDirty, bool bDropDecode, bool bDropOutput )
     {
+        VPXDEC_TRACE( "readFrame", m_nTraceTag );
+
         float fCurrentPos = -1;
         bool bEnd = false;
+        bool bStart = false;
         int nRet = 0;
 
         // Nothing changed for now
@@ -968,7 +1460,7 @@ error_open:
         }
 
         // Goto Custom Start
-        bool bStart = m_fStartAt >= VIDEO_EPSILON && m_fPos < m_fStartAt;
+        bStart = m_fStartAt >= VIDEO_EPSILON && m_fPos < m_fStartAt;
 
         if ( bStart )
         {
@@ -988,8 +1480,19 @@ error_open:
             goto fail;
         }
 
-        // read file
-        nRet = read_frame( &m_input, &m_buf, &m_buf_sz, &m_buf_alloc_sz, &fCurrentPos, &bEnd );
+        // read file (or take the frame read ahead)
+        if ( m_bPeeked )
+        {
+            m_bPeeked = false;
+            nRet = m_nPeekRet;
+            bEnd = m_bPeekEnd;
+            fCurrentPos = m_fPeekPos;
+        }
+
+        else
+        {
+            nRet = read_frame( &m_input, &m_buf, &m_buf_sz, &m_buf_alloc_sz, &fCurrentPos, &bEnd );
+        }
 
         // Calculate current position
         if ( fCurrentPos >= 0.0f )
@@ -1012,8 +1515,24 @@ error_open:
             goto fail;
         }
 
-        // Dropping like this will produce a crash since 1.1 Eider
-        if ( !bDropDecode )
+        indexKeyframe();
+        m_nBytesRead += m_buf_sz;
+
+        // Inter frames depend on the previous frames, so after a skipped decode only a keyframe can resume decoding
+        if ( !isKeyframe() && ( m_bKeyframesOnly || m_bNeedKeyframe ) )
+        {
+            bDropDecode = true;
+            bDropOutput = true;
+        }
+
+        // Dropping like this will produce a crash since 1.1 Eider (unless decoding resumes at a keyframe)
+        if ( bDropDecode )
+        {
+            m_bNeedKeyframe = true;
+            ++m_nDecodesSkipped;
+        }
+
+        else
         {
             // Decode frame // TODO: Deadline if post processing is added sometime in the future
             if ( vpx_codec_decode( &m_decoder, m_buf, m_buf_sz, NULL, 0 ) )
@@ -1028,6 +1547,9 @@ error_open:
 
                 goto fail;
             }
+
+            ++m_nFramesDecoded;
+            m_bNeedKeyframe = false;
         }
 
         //else // added because of eider release but didn't help so for now uncommented again
@@ -1097,9 +1619,258 @@ fail:
         return EXIT_FAILURE;
     }
 
+    void VPXDec::indexKeyframe()
+    {
+        if ( !isKeyframe() )
+        {
+            return;
+        }
+
+        // usually appended, earlier keyframes are only found again after seeking back or looping
+        std::vector<float>::iterator iter = std::lower_bound( m_vecKeyframes.begin(), m_vecKeyframes.end(), m_fPos - VIDEO_EPSILON );
+
+        if ( iter == m_vecKeyframes.end() || *iter > m_fPos + VIDEO_EPSILON )
+        {
+            m_vecKeyframes.insert( iter, m_fPos );
+        }
+    }
+
+    float VPXDec::getKeyframe( float fPos )
+    {
+        std::vector<float>::iterator iter = std::upper_bound( m_vecKeyframes.begin(), m_vecKeyframes.end(), fPos + VIDEO_EPSILON );
+        return iter == m_vecKeyframes.begin() ? -1 : *( iter - 1 );
+    }
+
+    int VPXDec::readKeyframe( vpx_image_t** pData, bool& bDirty, float fTarget )
+    {
+        vpx_image_t* img = NULL;
+        *pData = NULL;
+        bDirty = false;
+
+        // a known keyframe ahead makes reading the frames in between unnecessary
+        float fKeyframe = getKeyframe( fTarget );
+        float fNext = peekPosition();
+
+        if ( fNext >= 0.0f && fKeyframe > fNext + VIDEO_EPSILON && m_input.kind == WEBM_FILE )
+        {
+            seek( fKeyframe, false );
+        }
+
+        while ( ( fNext = peekPosition() ) >= 0.0f && fNext <= fTarget )
+        {
+            // only the newest keyframe before the target is presented, so earlier known keyframes aren't decoded either
+            bool bDecode = isKeyframe() && getKeyframe( fTarget ) <= fNext + VIDEO_EPSILON;
+
+            if ( readFrame( bDecode ? &img : NULL, bDirty, !bDecode ) )
+            {
+                return EXIT_FAILURE;
+            }
+
+            if ( bDirty )
+            {
+                *pData = img;
+            }
+        }
+
+        bDirty = *pData != NULL;
+        return EXIT_SUCCESS;
+    }
+
+    float VPXDec::peekPosition()
+    {
+        // Custom End reached
+        if ( m_fEndAfter >= VIDEO_EPSILON && m_fPos >= m_fEndAfter )
+        {
+            return -1;
+        }
+
+        if ( !m_bPeeked )
+        {
+            if ( !isOpen() )
+            {
+                return -1;
+            }
+
+            m_fPeekPos = -1;
+            m_nPeekRet = read_frame( &m_input, &m_buf, &m_buf_sz, &m_buf_alloc_sz, &m_fPeekPos, &m_bPeekEnd );
+            m_bPeeked = true;
+
+            if ( m_fPeekPos < 0.0f )
+            {
+                m_fPeekPos = float( m_nFrameIn ) / getFPS();
+            }
+        }
+
+        return m_bPeekEnd || m_nPeekRet ? -1 : m_fPeekPos;
+    }
+
+    int VPXDec::readLiveFrames( vpx_image_t** pData, bool& bDirty, unsigned nMaxFrames, bool bDropDecode )
+    {
+        VPXDEC_TRACE( "readLiveFrames", m_nTraceTag );
+
+        int nFrames = 0;
+        bool bDecoded = false;
+        bool bPending = false;
+
+        // Nothing changed for now
+        bDirty = false;
+
+        if ( pData )
+        {
+            *pData = NULL;
+        }
+
+        // Decoder closed?
+        if ( !isOpen() )
+        {
+            return -1;
+        }
+
+        while ( nFrames < int( nMaxFrames ) )
+        {
+            float fCurrentPos = -1;
+            bool bEnd = false;
+            long nFallbackPos = m_input.kind == WEBM_STREAM ? 0 : ftell( m_infile );
+
+            if ( read_frame( &m_input, &m_buf, &m_buf_sz, &m_buf_alloc_sz, &fCurrentPos, &bEnd, true ) )
+            {
+                if ( !isOpen() ) // decoder closed?
+                {
+                    return -1;
+                }
+
+                if ( m_input.kind == WEBM_STREAM )
+                {
+                    if ( !bEnd ) // invalid stream data
+                    {
+                        return -1;
+                    }
+
+                    // jitter buffer empty, partially received elements stay in the demuxer
+                    m_buf = NULL;
+                    m_buf_sz = 0;
+                    break;
+                }
+
+                if ( !bEnd && !feof( m_infile ) ) // error
+                {
+                    return -1;
+                }
+
+                // no new data yet, the partially written frame is read again next time (also clears the end of file state)
+                fseek( m_infile, nFallbackPos, SEEK_SET );
+                m_buf = m_input.kind == WEBM_FILE ? NULL : m_buf;
+                m_buf_sz = 0;
+                break;
+            }
+
+            if ( m_nFrameIn == 0 && m_pBroadcast )
+            {
+                m_pBroadcast->OnStart();
+            }
+
+            ++nFrames;
+            m_nBytesRead += m_buf_sz;
+            m_fPos = fCurrentPos >= 0.0f ? fCurrentPos : float( m_nFrameIn ) / getFPS();
+            ++m_nFrameIn;
+
+            // Inter frames depend on the previous frames, so after a skipped decode only a keyframe can resume decoding
+            if ( bDropDecode || ( !isKeyframe() && ( m_bKeyframesOnly || m_bNeedKeyframe ) ) )
+            {
+                m_bNeedKeyframe = true;
+                ++m_nDecodesSkipped;
+                continue;
+            }
+
+            // Droppable frames are only decoded if they are the newest frame
+            signed char nLfDeltas[VP8_LF_DELTAS];
+
+            if ( vp8_frame_is_droppable( m_buf, m_buf_sz, m_nLfDeltas, nLfDeltas ) )
+            {
+                if ( bPending )
+                {
+                    ++m_nLiveSkipped;
+                }
+
+                m_vecPending.assign( m_buf, m_buf + m_buf_sz );
+                bPending = true;
+                continue;
+            }
+
+            if ( bPending )
+            {
+                ++m_nLiveSkipped;
+                bPending = false;
+            }
+
+            if ( vpx_codec_decode( &m_decoder, m_buf, m_buf_sz, NULL, 0 ) )
+            {
+                fprintf( stderr, "Failed to decode frame: %s\n", vpx_codec_error( &m_decoder ) );
+                return -1;
+            }
+
+            memcpy( m_nLfDeltas, nLfDeltas, sizeof( m_nLfDeltas ) );
+            ++m_nFramesDecoded;
+            m_bNeedKeyframe = false;
+            bDecoded = true;
+        }
+
+        // droppable frames don't change the loop filter deltas
+        if ( bPending )
+        {
+            if ( vpx_codec_decode( &m_decoder, &m_vecPending[0], unsigned( m_vecPending.size() ), NULL, 0 ) )
+            {
+                fprintf( stderr, "Failed to decode frame: %s\n", vpx_codec_error( &m_decoder ) );
+                return -1;
+            }
+
+            ++m_nFramesDecoded;
+            bDecoded = true;
+        }
+
+        // Output the newest decoded frame
+        if ( bDecoded && pData )
+        {
+            m_iter = NULL;
+
+            if ( ( m_img = vpx_codec_get_frame( &m_decoder, &m_iter ) ) != NULL )
+            {
+                ++m_nFrameOut;
+                *pData = m_img;
+                bDirty = true;
+            }
+        }
+
+        // Broadcast New Frame event to listeners
+        if ( m_pBroadcast && bDirty )
+        {
+            m_pBroadcast->OnFrame();
+        }
+
+        return nFrames;
+    }
+
+    size_t VPXDec::getMemoryUsage()
+    {
+        if ( !isOpen() )
+        {
+            return 0;
+        }
+
+        size_t nWidth = ( ( m_nWidth + 15 ) & ~15 ) + 2 * VP8_FRAME_BORDER;
+        size_t nHeight = ( ( m_nHeight + 15 ) & ~15 ) + 2 * VP8_FRAME_BORDER;
+
+        return VP8_FRAME_BUFFERS * nWidth * nHeight * 3 / 2 + m_buf_alloc_sz + m_vecPending.capacity() + m_vecKeyframes.capacity() * sizeof( float );
+    }
+
+    const char* VPXDec::getFile()
+    {
+        return m_sFile.c_str();
+    }
+
     bool VPXDec::isOpen()
     {
-        return m_infile && m_decoder.iface && gEnv->pSystem && !gEnv->pSystem->IsQuitting();
+        return m_infile && m_decoder.iface && pVPXDecIO->IsAvailable();
     }
 
     int VPXDec::cleanup()
@@ -1110,6 +1881,20 @@ fail:
 
         m_nCorrupted = 0;
         m_nFramesCorrupted = 0;
+        m_bNeedKeyframe = false;
+        m_bPeeked = false;
+        m_bPeekEnd = false;
+        m_nPeekRet = 0;
+        m_fPeekPos = -1;
+        m_bKeyframesOnly = false;
+        m_nDecodesSkipped = 0;
+        m_nFramesDecoded = 0;
+        m_nBytesRead = 0;
+        m_bLive = false;
+        m_nLiveSkipped = 0;
+        m_vecPending.clear();
+        m_vecKeyframes.clear();
+        memset( m_nLfDeltas, 0, sizeof( m_nLfDeltas ) );
         m_fPos = 0;
         m_fDuration = 0;
         m_nFrameIn = 0;
@@ -1135,12 +1920,14 @@ fail:
             nestegg_destroy( m_input.nestegg_ctx );
         }
 
-        if ( m_input.kind != WEBM_FILE )
+        // webm data is owned by the demuxers
+        if ( m_input.kind != WEBM_FILE && m_input.kind != WEBM_STREAM )
         {
             free( m_buf );
         }
 
         memset( &m_input, 0, sizeof( m_input ) );
+        m_stream.close();
 
         if ( m_infile )
         {
@@ -12,7 +12,12 @@
 #include <vpx/vp8dx.h>
 #endif
 
-#include <IPluginVideoplayer.h>
+#include <WebM/vpxdec_io.h>
+#include <WebM/vpxdec_stream.h>
+#include <WebM/vpxdec_trace.h>
+#include <string>
+#include <string.h>
+#include <vector>
 
 #include <tools_common.h>
 #include <nestegg/include/nestegg/nestegg.h>
@@ -30,6 +35,17 @@
 
 #pragma once
 
+// shared with IPluginVideoplayer.h, the decoder doesn't depend on the engine
+#ifndef RESBASE
+#define RESBASE 2 //!< Shift resolution by x in this case make resolution divisible by 4
+#endif
+#ifndef NANOSECOND
+#define NANOSECOND 1000000000.0f //!< Nanoseconds for internal usage 10 ^ 9
+#endif
+#ifndef VIDEO_EPSILON
+#define VIDEO_EPSILON 0.015f //!< Minimal duration to detect time differences in seconds
+#endif
+
 namespace VideoplayerPlugin
 {
     /**
@@ -39,7 +55,8 @@ namespace VideoplayerPlugin
     {
         RAW_FILE,
         IVF_FILE,
-        WEBM_FILE
+        WEBM_FILE,
+        WEBM_STREAM //!< live WebM demuxed as it arrives @see WebMStream
     };
 
     /**
@@ -54,9 +71,21 @@ namespace VideoplayerPlugin
         unsigned int    chunk;
         unsigned int    chunks;
         unsigned int    video_track;
+        WebMStream*     stream;
     };
 
+    /**
+    * @brief Duration of a video file read from its header, without decoding
+    * WebM uses the segment duration, IVF the frame count and timebase of the file header.
+    * @param sFile video file
+    * @return duration in seconds, -1 if unknown
+    */
+    float probeVPXDecDuration( const char* sFile );
+
 #define IVF_FRAME_HDR_SZ (sizeof(uint32_t) + sizeof(uint64_t))
+#define VP8_LF_DELTAS 8 //!< loop filter deltas (4 reference frame, 4 mode) that persist between frames
+#define VP8_FRAME_BUFFERS 4 //!< YV12 frame buffers of the decoder (last, golden, altref, new)
+#define VP8_FRAME_BORDER 32 //!< border in pixels around the 16 pixel aligned frame buffers
 #define RAW_FRAME_HDR_SZ (sizeof(uint32_t))
 
     /**
@@ -83,7 +112,7 @@ namespace VideoplayerPlugin
                                     m_bNoBlit,
                                     m_bPostProc;
 
-            string                  m_sFile;
+            std::string             m_sFile;
 
             int                     m_bECEnabled;
 
@@ -102,6 +131,7 @@ namespace VideoplayerPlugin
             int                     m_vp8_dbg_display_mv;
 
             struct input_ctx        m_input;
+            WebMStream              m_stream; //!< demuxer of live WebM inputs
             int                     m_nFramesCorrupted;
             int                     m_nDecFlags;
 
@@ -110,7 +140,24 @@ namespace VideoplayerPlugin
 
             int                     m_nCorrupted;
 
-            IVideoplayerEventListener*  m_pBroadcast;
+            bool                    m_bNeedKeyframe;
+
+            bool                    m_bPeeked; //!< the next frame was already read by peekPosition
+            bool                    m_bPeekEnd;
+            int                     m_nPeekRet;
+            float                   m_fPeekPos;
+
+            IVPXDecListener*        m_pBroadcast;
+
+            std::vector<float>      m_vecKeyframes; //!< keyframe index: sorted timestamps of the keyframes read so far
+
+            /**
+            * @brief Add the frame that was just read to the keyframe index if it is a keyframe
+            */
+            void indexKeyframe();
+
+            std::vector<uint8_t>    m_vecPending; //!< newest droppable live frame, only decoded if no newer frame arrives
+            signed char             m_nLfDeltas[VP8_LF_DELTAS]; //!< loop filter deltas of the last decoded live frame
 
         public:
             unsigned int m_nWidth; //!< video width
@@ -122,32 +169,93 @@ namespace VideoplayerPlugin
 
             float m_fLastReportedEnd; //!< last end reached
 
+            bool m_bKeyframesOnly; //!< only decode keyframes, other frames are read but not decoded
+            unsigned m_nDecodesSkipped; //!< frames that were read without decoding them
+            unsigned m_nFramesDecoded; //!< frames that were decoded
+            uint64_t m_nBytesRead; //!< compressed bytes of the frames read
+            int m_nTraceTag; //!< tag of the trace events of this decoder (video id, -1 none)
+
+            bool m_bLive; //!< live input, the end of the file only means that no new data arrived yet @see readLiveFrames
+            unsigned m_nLiveSkipped; //!< droppable live frames that were skipped without decoding them
+
             /**
             * @brief Open Video file
             * @param fStartAt custom start position
             * @param fEndAfter custom end position
             * @param pBroadcast event dispatcher.
+            * @param bLive live input (growing file or pipe), WebM is demuxed as it arrives without seeking
             * @return success (EXIT_SUCCESS)
             */
-            int open( char* fn, bool bLoop = false, float fStartAt = 0, float fEndAfter = 0, IVideoplayerEventListener* pBroadcast = NULL );
+            int open( char* fn, bool bLoop = false, float fStartAt = 0, float fEndAfter = 0, IVPXDecListener* pBroadcast = NULL, bool bLive = false );
 
             /**
             * @brief Read the next frame
             * @param[out] pData Pointer to Pointer that should hold the decoded planar YV12 raw data
             * @param[out] bDirty Set if new data was written.
-            * @param bDropDecode Only read data but don't decode/output it (sets implicit drop output)
+            * @param bDropDecode Only read data but don't decode/output it (sets implicit drop output), decoding resumes at the next keyframe
             * @param bDropOutput Read and decode data but don't output it
             * @attention dispatches some of the video events.
             * @return success
             */
             int readFrame( vpx_image_t** pData, bool& bDirty, bool bDropDecode = false, bool bDropOutput = false );
 
+            /**
+            * @brief Read all frames of a live input that arrived since the last call and output the newest one
+            * Reference frames are decoded without output, droppable frames are only decoded if no newer frame arrived.
+            * @param[out] pData Pointer to Pointer that should hold the newest decoded planar YV12 raw data (NULL to only decode)
+            * @param[out] bDirty Set if new data was written.
+            * @param nMaxFrames read at most x frames
+            * @param bDropDecode Only read data but don't decode/output it, decoding resumes at the next keyframe
+            * @attention dispatches some of the video events.
+            * @return frames read (0 if no new data arrived yet), -1 on error
+            */
+            int readLiveFrames( vpx_image_t** pData, bool& bDirty, unsigned nMaxFrames, bool bDropDecode = false );
+
+            /**
+            * @brief Trick mode: read up to a position but only decode and output the newest keyframe before it
+            * Inter frames are skipped without decoding, a known keyframe farther ahead is reached by seeking over the frames in between.
+            * @param[out] pData Pointer to Pointer that should hold the decoded keyframe (NULL if no keyframe was reached)
+            * @param[out] bDirty Set if new data was written.
+            * @param fTarget read all frames up to this position in seconds
+            * @attention dispatches some of the video events, the end is handled by the next readFrame.
+            * @return success
+            */
+            int readKeyframe( vpx_image_t** pData, bool& bDirty, float fTarget );
+
+            /**
+            * @brief Newest keyframe of the keyframe index at or before a position
+            * @param fPos position in seconds
+            * @return keyframe position in seconds, -1 if no keyframe is known
+            */
+            float getKeyframe( float fPos );
+
+            /**
+            * @brief Timestamp of the next frame without decoding it (the frame is read ahead and used by the next readFrame)
+            * @return position in seconds, -1 if the end is reached (or on errors)
+            */
+            float peekPosition();
+
             /**
             * @brief seek video stream
+            * @param bBroadcast dispatch the seek event (trick mode seeks over frames without resyncing the playback)
             * @attention only avaible in WebM format.
             * @return success
             */
-            int seek( float fTimepos = 0 );
+            int seek( float fTimepos = 0, bool bBroadcast = true );
+
+            /**
+            * @brief Continue decoding at a position without dispatching events (can run on a worker)
+            * Seeks to the keyframe before the position and decodes the frames in between without output,
+            * so the next readFrame returns the frame at the position.
+            * @return success
+            */
+            int resumeAt( float fTimepos );
+
+            /**
+            * @brief Was the last read frame a keyframe
+            * @return keyframe
+            */
+            bool isKeyframe();
 
             /**
             * @brief Retrieve the duration of the video file
@@ -167,6 +275,18 @@ namespace VideoplayerPlugin
             */
             float getFPS();
 
+            /**
+            * @brief Estimate the memory held by the decoder (frame buffers, read buffer, keyframe index)
+            * @return bytes, 0 if no file is open
+            */
+            size_t getMemoryUsage();
+
+            /**
+            * @brief Retrieve the path of the opened video file
+            * @return path, empty if no file is open
+            */
+            const char* getFile();
+
             /**
             * @brief Has the decoder currently a video file open
             * @return open
@@ -234,6 +354,19 @@ namespace VideoplayerPlugin
 
                 m_nCorrupted = 0;
                 m_nFramesCorrupted = 0;
+                m_bNeedKeyframe = false;
+                m_bPeeked = false;
+                m_bPeekEnd = false;
+                m_nPeekRet = 0;
+                m_fPeekPos = -1;
+                m_bKeyframesOnly = false;
+                m_nDecodesSkipped = 0;
+                m_nFramesDecoded = 0;
+                m_nBytesRead = 0;
+                m_nTraceTag = -1;
+                m_bLive = false;
+                m_nLiveSkipped = 0;
+                memset( m_nLfDeltas, 0, sizeof( m_nLfDeltas ) );
                 m_nDecFlags = 0;
 
                 m_nWidth  = 0;
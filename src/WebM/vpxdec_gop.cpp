@@ -0,0 +1,200 @@
+/* Videoplayer_Plugin - for licensing and copyright see license.txt */
+
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+
+#include <WebM/vpxdec_gop.h>
+
+namespace VideoplayerPlugin
+{
+    int VPXDecGOPCache::open( const char* sFile, float fStartAt, float fEndAfter )
+    {
+        close();
+
+        return m_decoder.open( ( char* )sFile, false, fStartAt, fEndAfter );
+    }
+
+    int VPXDecGOPCache::decode( float fEnd, size_t nBudget )
+    {
+        clear();
+
+        if ( !m_decoder.isOpen() )
+        {
+            return -1;
+        }
+
+        // cue seek lands on the keyframe before the position, without cues decoding has to start at the beginning
+        if ( m_decoder.seek( fEnd - VIDEO_EPSILON ) && m_decoder.seek( 0 ) )
+        {
+            return -1;
+        }
+
+        vpx_image_t* img = NULL;
+        bool bDirty;
+        float fNext;
+
+        while ( ( fNext = m_decoder.peekPosition() ) >= 0.0f && fNext < fEnd - VIDEO_EPSILON * 0.5f )
+        {
+            if ( m_decoder.readFrame( &img, bDirty ) )
+            {
+                break;
+            }
+
+            ++m_nDecoded;
+
+            if ( bDirty && img )
+            {
+                store( img, m_decoder.getPosition(), nBudget );
+            }
+        }
+
+        return int( m_queFrames.size() );
+    }
+
+    int VPXDecGOPCache::decodeStart( size_t nBudget, float* fResume )
+    {
+        clear();
+        *fResume = -1;
+
+        // seeking to 0 goes to the keyframe before the custom start
+        if ( !m_decoder.isOpen() || m_decoder.seek( 0 ) )
+        {
+            return -1;
+        }
+
+        vpx_image_t* img = NULL;
+        bool bDirty;
+        float fNext;
+
+        // like the main decoder the playback starts at the keyframe before the custom start
+        while ( ( fNext = m_decoder.peekPosition() ) >= 0.0f )
+        {
+            // the next GOP or a frame that doesn't fit anymore isn't cached (all frames have the same size)
+            if ( !m_queFrames.empty() && ( m_decoder.isKeyframe() || m_nBytes + m_queFrames.back().data.size() > nBudget ) )
+            {
+                *fResume = fNext;
+                break;
+            }
+
+            if ( m_decoder.readFrame( &img, bDirty ) )
+            {
+                break;
+            }
+
+            ++m_nDecoded;
+
+            if ( bDirty && img )
+            {
+                store( img, m_decoder.getPosition(), nBudget );
+            }
+        }
+
+        return int( m_queFrames.size() );
+    }
+
+    void VPXDecGOPCache::store( const vpx_image_t* img, float fPos, size_t nBudget )
+    {
+        size_t nRows[3];
+        size_t nSize = 0;
+
+        for ( int i = 0; i < 3; ++i )
+        {
+            nRows[i] = i == 0 ? img->d_h : ( img->d_h + img->y_chroma_shift ) >> img->y_chroma_shift;
+            nSize += nRows[i] * img->stride[i];
+        }
+
+        // only the newest frames are kept, the older ones are decoded again by the next decode
+        while ( !m_queFrames.empty() && m_nBytes + nSize > nBudget )
+        {
+            m_nBytes -= m_queFrames.front().data.size();
+            m_vecFree.push_back( std::vector<uint8_t>() );
+            m_vecFree.back().swap( m_queFrames.front().data );
+            m_queFrames.pop_front();
+        }
+
+        m_queFrames.push_back( SFrame() );
+        SFrame& frame = m_queFrames.back();
+
+        if ( !m_vecFree.empty() )
+        {
+            frame.data.swap( m_vecFree.back() );
+            m_vecFree.pop_back();
+        }
+
+        frame.data.resize( nSize );
+        frame.fPos = fPos;
+        frame.img = *img;
+        frame.img.img_data = NULL;
+        frame.img.img_data_owner = 0;
+        frame.img.self_allocd = 0;
+
+        uint8_t* pData = &frame.data[0];
+
+        for ( int i = 0; i < 3; ++i )
+        {
+            size_t nPlane = nRows[i] * img->stride[i];
+            memcpy( pData, img->planes[i], nPlane );
+            frame.img.planes[i] = pData;
+            pData += nPlane;
+        }
+
+        frame.img.planes[3] = NULL;
+        m_nBytes += nSize;
+    }
+
+    vpx_image_t* VPXDecGOPCache::getFrame( float fPos )
+    {
+        for ( std::deque<SFrame>::reverse_iterator iter = m_queFrames.rbegin(); iter != m_queFrames.rend(); ++iter )
+        {
+            if ( iter->fPos <= fPos + VIDEO_EPSILON * 0.5f )
+            {
+                return &iter->img;
+            }
+        }
+
+        return NULL;
+    }
+
+    float VPXDecGOPCache::getStart()
+    {
+        return m_queFrames.empty() ? -1 : m_queFrames.front().fPos;
+    }
+
+    float VPXDecGOPCache::getEnd()
+    {
+        return m_queFrames.empty() ? -1 : m_queFrames.back().fPos;
+    }
+
+    size_t VPXDecGOPCache::getBytes()
+    {
+        return m_nBytes;
+    }
+
+    void VPXDecGOPCache::clear()
+    {
+        while ( !m_queFrames.empty() )
+        {
+            m_vecFree.push_back( std::vector<uint8_t>() );
+            m_vecFree.back().swap( m_queFrames.front().data );
+            m_queFrames.pop_front();
+        }
+
+        m_nBytes = 0;
+    }
+
+    void VPXDecGOPCache::closeDecoder()
+    {
+        m_decoder.cleanup();
+        m_vecFree.clear();
+    }
+
+    void VPXDecGOPCache::close()
+    {
+        m_decoder.cleanup();
+        m_nDecoded = 0;
+        m_queFrames.clear();
+        m_vecFree.clear();
+        m_nBytes = 0;
+    }
+}
@@ -0,0 +1,107 @@
+/* Videoplayer_Plugin - for licensing and copyright see license.txt */
+
+#include <WebM/vpxdec_ext.h>
+#include <deque>
+
+#pragma once
+
+namespace VideoplayerPlugin
+{
+    /**
+    * @brief Decodes GOPs with an own decoder and keeps the decoded frames, so they can be presented without the main decoder
+    * Used for the reverse playback (GOPs before a position, presented backwards) and seamless looping (first GOP after the start).
+    * Uses an own decoder (and file handle), so it can fill the cache on a worker while the video keeps playing.
+    * The cache is bounded: if the frames don't fit into the budget only the newest ones are kept,
+    * the older ones are decoded again from the same keyframe by the next decode.
+    */
+    class VPXDecGOPCache
+    {
+        public:
+            unsigned m_nDecoded; //!< frames decoded into the cache (including decodes repeated because of the budget)
+
+            /**
+            * @brief Open the video with an own decoder
+            * @param fStartAt custom start position (frames before it are never cached)
+            * @param fEndAfter custom end position
+            * @return success (EXIT_SUCCESS), fails if the video can't be opened
+            */
+            int open( const char* sFile, float fStartAt = 0, float fEndAfter = 0 );
+
+            /**
+            * @brief Replace the cached frames with the frames before a position
+            * Seeks to the keyframe before the position and decodes forward, the newest frames that fit into the budget are kept.
+            * @param fEnd cache the frames before this position in seconds
+            * @param nBudget maximal bytes of the cached frames (at least one frame is kept)
+            * @return frames cached (0 if there are no frames before the position), -1 if the video can't be seeked
+            */
+            int decode( float fEnd, size_t nBudget );
+
+            /**
+            * @brief Replace the cached frames with the first GOP of the video (at the keyframe before the custom start)
+            * Decoding stops at the second keyframe or when the budget is full (the oldest frames are kept).
+            * @param nBudget maximal bytes of the cached frames (at least one frame is kept)
+            * @param[out] fResume position of the first frame after the cached ones, -1 if the cache reaches the end
+            * @return frames cached, -1 if the video can't be seeked
+            */
+            int decodeStart( size_t nBudget, float* fResume );
+
+            /**
+            * @brief Newest cached frame at or before a position
+            * @param fPos position in seconds
+            * @return frame (valid until the next decode), NULL if all cached frames are newer
+            */
+            vpx_image_t* getFrame( float fPos );
+
+            /**
+            * @brief Position of the oldest cached frame, older frames need the next decode
+            * @return position in seconds, -1 if nothing is cached
+            */
+            float getStart();
+
+            /**
+            * @brief Position of the newest cached frame
+            * @return position in seconds, -1 if nothing is cached
+            */
+            float getEnd();
+
+            /**
+            * @brief Bytes of the cached frames
+            */
+            size_t getBytes();
+
+            /**
+            * @brief Free the decoder but keep the cached frames (when no further decode is needed)
+            */
+            void closeDecoder();
+
+            /**
+            * @brief Free the cached frames and the decoder (resets the statistics)
+            */
+            void close();
+
+            VPXDecGOPCache()
+            {
+                m_nDecoded = 0;
+                m_nBytes = 0;
+            }
+
+        private:
+            /**
+            * @brief Decoded frame in the cache
+            */
+            struct SFrame
+            {
+                std::vector<uint8_t> data; //!< planes
+                vpx_image_t img; //!< image pointing to data
+                float fPos; //!< position in seconds
+            };
+
+            VPXDec m_decoder;
+            std::deque<SFrame> m_queFrames; //!< cached frames (oldest first)
+            std::vector< std::vector<uint8_t> > m_vecFree; //!< recycled plane buffers
+            size_t m_nBytes; //!< bytes in the cache
+
+            void clear(); //!< recycle all cached frames
+            void store( const vpx_image_t* img, float fPos, size_t nBudget ); //!< copy a decoded frame into the cache
+    };
+}
@@ -0,0 +1,98 @@
+/* Videoplayer_Plugin - for licensing and copyright see license.txt */
+
+#include <stdio.h>
+#include <stdarg.h>
+
+#pragma once
+
+// Engine independent interfaces of the decoder, the plugin redirects them to CryEngine (see CCE3DecoderIO)
+
+namespace VideoplayerPlugin
+{
+    /**
+    * @brief File access of the decoder
+    * The default implementation uses stdio.
+    */
+    struct IVPXDecIO
+    {
+        virtual FILE* Open( const char* sFile, const char* sMode ) = 0;
+        virtual size_t Read( void* pData, size_t nSize, size_t nCount, FILE* pFile ) = 0;
+        virtual int Seek( FILE* pFile, long nOffset, int nMode ) = 0;
+        virtual long Tell( FILE* pFile ) = 0;
+        virtual int Eof( FILE* pFile ) = 0;
+        virtual int Error( FILE* pFile ) = 0;
+        virtual int Close( FILE* pFile ) = 0;
+
+        /**
+        * @brief Read only the data that already arrived, without blocking (live inputs)
+        * A growing file or pipe at its end only means that no new data arrived yet.
+        * @return bytes read (0 if no new data arrived yet)
+        */
+        virtual size_t ReadAvailable( void* pData, size_t nSize, FILE* pFile ) = 0;
+
+        /**
+        * @brief Can files still be accessed
+        * @return false while the host is shutting down (decoding stops)
+        */
+        virtual bool IsAvailable() = 0;
+    };
+
+    /**
+    * @brief Severity of decoder messages
+    */
+    enum eVPXDecLogLevel
+    {
+        VLL_INFO,
+        VLL_WARNING,
+        VLL_ERROR,
+    };
+
+    /**
+    * @brief Message output of the decoder
+    * The default implementation writes to stderr.
+    */
+    struct IVPXDecLog
+    {
+        virtual void LogV( eVPXDecLogLevel eLevel, const char* sFormat, va_list args ) = 0;
+    };
+
+    /**
+    * @brief Events dispatched by the decoder
+    */
+    struct IVPXDecListener
+    {
+        virtual void OnStart() = 0; //!< first frame
+        virtual void OnFrame() = 0; //!< each output frame
+        virtual void OnSeek() = 0; //!< seek occurred
+        virtual void OnEnd() = 0; //!< end reached
+    };
+
+    /**
+    * @brief Set the file access of all decoders
+    * @param pIO implementation or NULL for stdio
+    */
+    void setVPXDecIO( IVPXDecIO* pIO );
+
+    /**
+    * @brief Retrieve the file access of all decoders
+    * @return current implementation (never NULL)
+    */
+    IVPXDecIO* getVPXDecIO();
+
+    /**
+    * @brief Retrieve the default file access (stdio, also reads local pipes)
+    * @return stdio implementation
+    */
+    IVPXDecIO* getVPXDecStdIO();
+
+    /**
+    * @brief Set the message output of all decoders
+    * @param pLog implementation or NULL for stderr
+    */
+    void setVPXDecLog( IVPXDecLog* pLog );
+
+    /**
+    * @brief Output a decoder message
+    */
+    void logVPXDec( eVPXDecLogLevel eLevel, const char* sFormat, ... );
+}
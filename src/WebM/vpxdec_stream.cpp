@@ -0,0 +1,695 @@
+/* Videoplayer_Plugin - for licensing and copyright see license.txt */
+
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+
+#include <WebM/vpxdec_io.h>
+#include <WebM/vpxdec_stream.h>
+#include <vpx_ports/vpx_timer.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+// EBML/Matroska element ids used by the demuxer
+#define EBML_ID_HEADER          0x1A45DFA3
+#define EBML_ID_SEGMENT         0x18538067
+#define EBML_ID_INFO            0x1549A966
+#define EBML_ID_TIMECODESCALE   0x2AD7B1
+#define EBML_ID_TRACKS          0x1654AE6B
+#define EBML_ID_TRACKENTRY      0xAE
+#define EBML_ID_TRACKNUMBER     0xD7
+#define EBML_ID_TRACKTYPE       0x83
+#define EBML_ID_CODECID         0x86
+#define EBML_ID_DEFAULTDURATION 0x23E383
+#define EBML_ID_VIDEO           0xE0
+#define EBML_ID_PIXELWIDTH      0xB0
+#define EBML_ID_PIXELHEIGHT     0xBA
+#define EBML_ID_CLUSTER         0x1F43B675
+#define EBML_ID_TIMECODE        0xE7
+#define EBML_ID_SIMPLEBLOCK     0xA3
+#define EBML_ID_BLOCKGROUP      0xA0
+#define EBML_ID_BLOCK           0xA1
+
+#define EBML_UNKNOWN_SIZE       (~uint64_t( 0 ))
+#define EBML_TRACK_VIDEO        1
+
+namespace VideoplayerPlugin
+{
+    /**
+    * @brief Read an EBML variable length integer
+    * @param[in] buf data
+    * @param[in] avail available data
+    * @param[out] value id (with length marker) or size (without length marker)
+    * @param[in] bId read an id
+    * @return length in bytes, 0 if more data is needed, -1 if invalid
+    */
+    static int ebml_read_vint( const uint8_t* buf, size_t avail, uint64_t* value, bool bId )
+    {
+        if ( avail < 1 )
+        {
+            return 0;
+        }
+
+        int len = 1;
+        uint8_t mask = 0x80;
+
+        while ( len <= 8 && !( buf[0] & mask ) )
+        {
+            ++len;
+            mask >>= 1;
+        }
+
+        if ( len > ( bId ? 4 : 8 ) )
+        {
+            return -1;
+        }
+
+        if ( avail < size_t( len ) )
+        {
+            return 0;
+        }
+
+        // all value bits set means unknown size
+        bool bUnknown = ( buf[0] & ( mask - 1 ) ) == mask - 1;
+        uint64_t v = bId ? buf[0] : buf[0] & ( mask - 1 );
+
+        for ( int i = 1; i < len; ++i )
+        {
+            bUnknown = bUnknown && buf[i] == 0xFF;
+            v = ( v << 8 ) | buf[i];
+        }
+
+        *value = !bId && bUnknown ? EBML_UNKNOWN_SIZE : v;
+        return len;
+    }
+
+    /**
+    * @brief Read an element header from complete data
+    * @param[in,out] buf data, moved to the next element
+    * @param[in] end end of data
+    * @param[out] id element id
+    * @param[out] data element data
+    * @param[out] size element size
+    * @return success
+    */
+    static bool ebml_read_element( const uint8_t*& buf, const uint8_t* end, uint32_t* id, const uint8_t** data, uint64_t* size )
+    {
+        uint64_t v;
+        int nId = ebml_read_vint( buf, end - buf, &v, true );
+
+        if ( nId <= 0 )
+        {
+            return false;
+        }
+
+        *id = uint32_t( v );
+        int nSize = ebml_read_vint( buf + nId, end - buf - nId, size, false );
+
+        if ( nSize <= 0 || *size > uint64_t( end - buf - nId - nSize ) )
+        {
+            return false;
+        }
+
+        *data = buf + nId + nSize;
+        buf = *data + *size;
+        return true;
+    }
+
+    /**
+    * @brief Unsigned integer element value
+    */
+    static uint64_t ebml_uint( const uint8_t* data, uint64_t size )
+    {
+        uint64_t v = 0;
+
+        for ( uint64_t i = 0; i < size && i < 8; ++i )
+        {
+            v = ( v << 8 ) | data[i];
+        }
+
+        return v;
+    }
+
+    /**
+    * @brief Can an element be a child of an open master element of unknown size
+    * Unknown size elements end with the first element that belongs to a higher level.
+    */
+    static bool ebml_is_child( uint32_t parent, uint32_t id )
+    {
+        switch ( parent )
+        {
+            case EBML_ID_SEGMENT:
+                return id != EBML_ID_HEADER && id != EBML_ID_SEGMENT;
+
+            case EBML_ID_CLUSTER:
+                // top level elements have 4 byte ids, cluster children are shorter
+                return id < 0x10000000;
+        }
+
+        return false;
+    }
+
+    int WebMStream::open( FILE* infile, float fTimeout )
+    {
+        close();
+        m_infile = infile;
+
+        vpx_usec_timer tWait;
+        vpx_usec_timer_start( &tWait );
+
+        // the header arrives first, frames don't need to be there yet
+        while ( !m_bHeader )
+        {
+            if ( pump() < 0 )
+            {
+                close();
+                return EXIT_FAILURE;
+            }
+
+            if ( m_bHeader )
+            {
+                break;
+            }
+
+            vpx_usec_timer_mark( &tWait );
+
+            if ( vpx_usec_timer_elapsed( &tWait ) > int64_t( fTimeout * 1000000 ) || !getVPXDecIO()->IsAvailable() )
+            {
+                logVPXDec( VLL_ERROR, "No WebM stream header received." );
+                close();
+                return EXIT_FAILURE;
+            }
+
+#if defined(_WIN32)
+            Sleep( 1 );
+#else
+            usleep( 1000 );
+#endif
+        }
+
+        return EXIT_SUCCESS;
+    }
+
+    int WebMStream::pump()
+    {
+        if ( !m_infile )
+        {
+            return -1;
+        }
+
+        while ( m_queFrames.size() < WEBM_STREAM_MAXFRAMES && m_nQueuedBytes < WEBM_STREAM_MAXBYTES )
+        {
+            size_t nOld = m_vecData.size();
+            m_vecData.resize( nOld + WEBM_STREAM_CHUNK );
+            size_t nRead = getVPXDecIO()->ReadAvailable( &m_vecData[nOld], WEBM_STREAM_CHUNK, m_infile );
+            m_vecData.resize( nOld + nRead );
+
+            if ( parse() < 0 )
+            {
+                return -1;
+            }
+
+            if ( nRead < WEBM_STREAM_CHUNK )
+            {
+                break; // no more data yet
+            }
+        }
+
+        // frames left in the data from a previous full jitter buffer
+        if ( parse() < 0 )
+        {
+            return -1;
+        }
+
+        return int( m_queFrames.size() );
+    }
+
+    int WebMStream::parse()
+    {
+        while ( m_queFrames.size() < WEBM_STREAM_MAXFRAMES && m_nQueuedBytes < WEBM_STREAM_MAXBYTES )
+        {
+            // discard skipped data as it arrives
+            if ( m_nSkip )
+            {
+                size_t nSkip = size_t( std::min<uint64_t>( m_nSkip, m_vecData.size() - m_nRead ) );
+                m_nRead += nSkip;
+                m_nSkip -= nSkip;
+
+                if ( m_nSkip )
+                {
+                    break;
+                }
+            }
+
+            uint64_t nPos = m_nOffset + m_nRead;
+
+            // leave finished master elements of known size
+            while ( !m_vecLevels.empty() && m_vecLevels.back().end != EBML_UNKNOWN_SIZE && nPos >= m_vecLevels.back().end )
+            {
+                m_vecLevels.pop_back();
+            }
+
+            size_t avail = m_vecData.size() - m_nRead;
+            const uint8_t* buf = avail ? &m_vecData[m_nRead] : NULL;
+            uint64_t id, size;
+
+            int nId = ebml_read_vint( buf, avail, &id, true );
+            int nSize = nId > 0 ? ebml_read_vint( buf + nId, avail - nId, &size, false ) : nId;
+
+            // not WebM
+            if ( nPos == 0 && nId != 0 && ( nId < 0 || id != EBML_ID_HEADER ) )
+            {
+                return -1;
+            }
+
+            if ( nId < 0 || nSize < 0 )
+            {
+                logVPXDec( VLL_ERROR, "Invalid WebM stream data at %llu.", ( unsigned long long )nPos );
+                return -1;
+            }
+
+            if ( nSize == 0 )
+            {
+                break; // element header didn't arrive yet
+            }
+
+            // leave master elements of unknown size at the first element of a higher level
+            while ( !m_vecLevels.empty() && m_vecLevels.back().end == EBML_UNKNOWN_SIZE && !ebml_is_child( m_vecLevels.back().id, uint32_t( id ) ) )
+            {
+                m_vecLevels.pop_back();
+            }
+
+            size_t nHeader = size_t( nId + nSize );
+            bool bMaster = id == EBML_ID_SEGMENT || id == EBML_ID_CLUSTER || id == EBML_ID_BLOCKGROUP;
+            bool bBuffered = id == EBML_ID_INFO || id == EBML_ID_TRACKS || id == EBML_ID_TIMECODE || id == EBML_ID_SIMPLEBLOCK || id == EBML_ID_BLOCK;
+
+            if ( size == EBML_UNKNOWN_SIZE && id != EBML_ID_SEGMENT && id != EBML_ID_CLUSTER )
+            {
+                logVPXDec( VLL_ERROR, "Unsupported WebM stream element %x of unknown size.", unsigned( id ) );
+                return -1;
+            }
+
+            if ( bMaster )
+            {
+                if ( id == EBML_ID_CLUSTER )
+                {
+                    m_nClusterTime = 0;
+                }
+
+                SLevel level = { uint32_t( id ), size == EBML_UNKNOWN_SIZE ? EBML_UNKNOWN_SIZE : nPos + nHeader + size };
+                m_vecLevels.push_back( level );
+                m_nRead += nHeader;
+                continue;
+            }
+
+            if ( !bBuffered )
+            {
+                if ( id == EBML_ID_HEADER )
+                {
+                    // chained stream (e.g. the muxer restarted), its tracks must match
+                    m_vecLevels.clear();
+                }
+
+                m_nRead += nHeader;
+                m_nSkip = size;
+                continue;
+            }
+
+            if ( size > WEBM_STREAM_MAXBYTES )
+            {
+                logVPXDec( VLL_ERROR, "WebM stream element %x too large (%llu).", unsigned( id ), ( unsigned long long )size );
+                return -1;
+            }
+
+            if ( avail < nHeader + size )
+            {
+                break; // element didn't arrive completely yet
+            }
+
+            const uint8_t* data = buf + nHeader;
+            bool bOk = true;
+
+            switch ( id )
+            {
+                case EBML_ID_INFO:
+                    bOk = parseInfo( data, size );
+                    break;
+
+                case EBML_ID_TRACKS:
+                    bOk = parseTracks( data, size );
+                    break;
+
+                case EBML_ID_TIMECODE:
+                    m_nClusterTime = ebml_uint( data, size );
+                    break;
+
+                default:
+                    bOk = !m_bHeader || parseBlock( data, size );
+            }
+
+            if ( !bOk )
+            {
+                return -1;
+            }
+
+            m_nRead += nHeader + size_t( size );
+        }
+
+        // keep only the data that isn't parsed yet
+        if ( m_nRead )
+        {
+            m_vecData.erase( m_vecData.begin(), m_vecData.begin() + m_nRead );
+            m_nOffset += m_nRead;
+            m_nRead = 0;
+        }
+
+        return int( m_queFrames.size() );
+    }
+
+    bool WebMStream::parseInfo( const uint8_t* data, uint64_t size )
+    {
+        const uint8_t* end = data + size;
+        uint32_t id;
+        const uint8_t* value;
+        uint64_t value_sz;
+
+        while ( data < end && ebml_read_element( data, end, &id, &value, &value_sz ) )
+        {
+            if ( id == EBML_ID_TIMECODESCALE )
+            {
+                m_nTimecodeScale = ebml_uint( value, value_sz );
+            }
+        }
+
+        if ( !m_nTimecodeScale )
+        {
+            m_nTimecodeScale = 1000000;
+        }
+
+        return true;
+    }
+
+    bool WebMStream::parseTracks( const uint8_t* data, uint64_t size )
+    {
+        const uint8_t* end = data + size;
+        uint32_t id;
+        const uint8_t* entry;
+        uint64_t entry_sz;
+
+        while ( data < end && ebml_read_element( data, end, &id, &entry, &entry_sz ) )
+        {
+            if ( id != EBML_ID_TRACKENTRY )
+            {
+                continue;
+            }
+
+            const uint8_t* entry_end = entry + entry_sz;
+            const uint8_t* value;
+            uint64_t value_sz;
+            uint64_t nNumber = 0, nType = 0, nDefaultDuration = 0;
+            unsigned int nWidth = 0, nHeight = 0;
+            bool bVP8 = false;
+
+            while ( entry < entry_end && ebml_read_element( entry, entry_end, &id, &value, &value_sz ) )
+            {
+                switch ( id )
+                {
+                    case EBML_ID_TRACKNUMBER:
+                        nNumber = ebml_uint( value, value_sz );
+                        break;
+
+                    case EBML_ID_TRACKTYPE:
+                        nType = ebml_uint( value, value_sz );
+                        break;
+
+                    case EBML_ID_CODECID:
+                        bVP8 = value_sz == 5 && memcmp( value, "V_VP8", 5 ) == 0;
+                        break;
+
+                    case EBML_ID_DEFAULTDURATION:
+                        nDefaultDuration = ebml_uint( value, value_sz );
+                        break;
+
+                    case EBML_ID_VIDEO:
+                    {
+                        const uint8_t* video_end = value + value_sz;
+                        const uint8_t* param;
+                        uint64_t param_sz;
+
+                        while ( value < video_end && ebml_read_element( value, video_end, &id, &param, &param_sz ) )
+                        {
+                            if ( id == EBML_ID_PIXELWIDTH )
+                            {
+                                nWidth = unsigned( ebml_uint( param, param_sz ) );
+                            }
+
+                            else if ( id == EBML_ID_PIXELHEIGHT )
+                            {
+                                nHeight = unsigned( ebml_uint( param, param_sz ) );
+                            }
+                        }
+                    }
+                    break;
+                }
+            }
+
+            // first VP8 video track
+            if ( nType == EBML_TRACK_VIDEO )
+            {
+                if ( !bVP8 )
+                {
+                    logVPXDec( VLL_ERROR, "Not VP8 video codec." );
+                    return false;
+                }
+
+                if ( m_bHeader && ( nWidth != m_nWidth || nHeight != m_nHeight ) )
+                {
+                    logVPXDec( VLL_ERROR, "WebM stream changed resolution." );
+                    return false;
+                }
+
+                m_nVideoTrack = nNumber;
+                m_nDefaultDuration = nDefaultDuration;
+                m_nWidth = nWidth;
+                m_nHeight = nHeight;
+                m_bHeader = true;
+                return true;
+            }
+        }
+
+        logVPXDec( VLL_ERROR, "No video track in WebM stream." );
+        return false;
+    }
+
+    bool WebMStream::parseBlock( const uint8_t* data, uint64_t size )
+    {
+        const uint8_t* end = data + size;
+        uint64_t nTrack;
+        int nTrackSz = ebml_read_vint( data, size, &nTrack, false );
+
+        if ( nTrackSz <= 0 || size < uint64_t( nTrackSz + 3 ) )
+        {
+            logVPXDec( VLL_ERROR, "Invalid WebM stream block." );
+            return false;
+        }
+
+        if ( nTrack != m_nVideoTrack )
+        {
+            return true; // other tracks (sound) are played separately
+        }
+
+        data += nTrackSz;
+        int16_t nRelative = int16_t( ( data[0] << 8 ) | data[1] );
+        uint8_t nFlags = data[2];
+        data += 3;
+
+        int64_t nTimecode = int64_t( m_nClusterTime ) + nRelative;
+        uint64_t tstamp = uint64_t( std::max<int64_t>( nTimecode, 0 ) ) * m_nTimecodeScale;
+
+        // lacing (several frames in one block, all get the block timestamp)
+        int nLacing = ( nFlags >> 1 ) & 3;
+
+        if ( !nLacing )
+        {
+            queueFrame( data, end - data, tstamp );
+            return true;
+        }
+
+        if ( data >= end )
+        {
+            return false;
+        }
+
+        unsigned nFrames = unsigned( *data++ ) + 1;
+        std::vector<uint64_t> vecSizes( nFrames, 0 );
+        uint64_t nTotal = 0;
+
+        for ( unsigned i = 0; i + 1 < nFrames; ++i )
+        {
+            switch ( nLacing )
+            {
+                case 1: // xiph
+                {
+                    uint8_t v;
+
+                    do
+                    {
+                        if ( data >= end )
+                        {
+                            return false;
+                        }
+
+                        v = *data++;
+                        vecSizes[i] += v;
+                    }
+                    while ( v == 0xFF );
+                }
+                break;
+
+                case 2: // fixed
+                    vecSizes[i] = ( end - data ) / nFrames;
+                    break;
+
+                case 3: // ebml, sizes after the first one are signed differences
+                {
+                    uint64_t v;
+                    int n = ebml_read_vint( data, end - data, &v, false );
+
+                    if ( n <= 0 || v == EBML_UNKNOWN_SIZE )
+                    {
+                        return false;
+                    }
+
+                    data += n;
+                    vecSizes[i] = i == 0 ? v : uint64_t( int64_t( vecSizes[i - 1] ) + int64_t( v ) - ( ( int64_t( 1 ) << ( 7 * n - 1 ) ) - 1 ) );
+                }
+                break;
+            }
+
+            nTotal += vecSizes[i];
+        }
+
+        if ( nTotal > uint64_t( end - data ) )
+        {
+            logVPXDec( VLL_ERROR, "Invalid WebM stream lacing." );
+            return false;
+        }
+
+        vecSizes[nFrames - 1] = ( end - data ) - nTotal;
+
+        for ( unsigned i = 0; i < nFrames; ++i )
+        {
+            queueFrame( data, size_t( vecSizes[i] ), tstamp );
+            data += vecSizes[i];
+        }
+
+        return true;
+    }
+
+    void WebMStream::queueFrame( const uint8_t* data, size_t size, uint64_t tstamp )
+    {
+        m_queFrames.push_back( SFrame() );
+        SFrame& frame = m_queFrames.back();
+
+        // reuse the buffers of decoded frames
+        if ( !m_vecFree.empty() )
+        {
+            frame.data.swap( m_vecFree.back() );
+            m_vecFree.pop_back();
+        }
+
+        frame.data.assign( data, data + size );
+        frame.tstamp = tstamp;
+        m_nQueuedBytes += size;
+
+        // framerate guessing like webm_guess_framerate (first second or 50 frames)
+        if ( m_nGuessFrames == 0 )
+        {
+            m_nGuessFirst = tstamp;
+        }
+
+        if ( m_nGuessFrames < 50 && tstamp - m_nGuessFirst < 1000000000 )
+        {
+            m_nGuessLast = tstamp;
+            ++m_nGuessFrames;
+        }
+    }
+
+    bool WebMStream::readFrame( uint8_t** buf, size_t* buf_sz, float* fTimeStamp )
+    {
+        if ( m_queFrames.empty() )
+        {
+            return false;
+        }
+
+        // the previous frame is done
+        if ( m_vecCurrent.capacity() )
+        {
+            m_vecFree.push_back( std::vector<uint8_t>() );
+            m_vecFree.back().swap( m_vecCurrent );
+        }
+
+        SFrame& frame = m_queFrames.front();
+        m_vecCurrent.swap( frame.data );
+        *fTimeStamp = float( double( frame.tstamp ) / 1000000000.0 );
+        m_nQueuedBytes -= m_vecCurrent.size();
+        m_queFrames.pop_front();
+
+        *buf = m_vecCurrent.empty() ? NULL : &m_vecCurrent[0];
+        *buf_sz = m_vecCurrent.size();
+        return true;
+    }
+
+    void WebMStream::getFramerate( unsigned int* fps_den, unsigned int* fps_num )
+    {
+        if ( m_nDefaultDuration )
+        {
+            *fps_num = 1000000000;
+            *fps_den = unsigned( std::min<uint64_t>( m_nDefaultDuration, 0xFFFFFFFF ) );
+        }
+
+        else if ( m_nGuessFrames >= 2 && m_nGuessLast > m_nGuessFirst )
+        {
+            *fps_num = ( m_nGuessFrames - 1 ) * 1000000;
+            *fps_den = unsigned( ( m_nGuessLast - m_nGuessFirst ) / 1000 );
+        }
+
+        else
+        {
+            *fps_num = 30; // until enough frames arrived
+            *fps_den = 1;
+        }
+    }
+
+    void WebMStream::close()
+    {
+        m_infile = NULL;
+        m_vecData.clear();
+        m_nRead = 0;
+        m_nOffset = 0;
+        m_nSkip = 0;
+        m_vecLevels.clear();
+
+        m_bHeader = false;
+        m_nVideoTrack = 0;
+        m_nTimecodeScale = 1000000;
+        m_nDefaultDuration = 0;
+        m_nClusterTime = 0;
+
+        m_queFrames.clear();
+        m_nQueuedBytes = 0;
+        m_vecFree.clear();
+        m_vecCurrent.clear();
+
+        m_nGuessFrames = 0;
+        m_nGuessFirst = 0;
+        m_nGuessLast = 0;
+
+        m_nWidth = 0;
+        m_nHeight = 0;
+    }
+}
@@ -0,0 +1,118 @@
+/* Videoplayer_Plugin - for licensing and copyright see license.txt */
+
+#include <stdio.h>
+#include <vpx/vpx_integer.h>
+#include <vector>
+#include <deque>
+
+#pragma once
+
+#define WEBM_STREAM_CHUNK (64 * 1024) //!< bytes read at once from a live input
+#define WEBM_STREAM_MAXFRAMES 64 //!< jitter buffer: maximal demuxed frames waiting for the decoder (reading pauses when full)
+#define WEBM_STREAM_MAXBYTES (32 * 1024 * 1024) //!< jitter buffer: maximal demuxed bytes, also the maximal size of a single element
+#define WEBM_STREAM_TIMEOUT 2.0f //!< seconds to wait for the stream header on open
+
+namespace VideoplayerPlugin
+{
+    /**
+    * @brief Incremental WebM demuxer for live inputs (growing files and pipes)
+    * Unlike nestegg it never seeks: the data is parsed as it arrives, so segments and clusters
+    * of unknown size (live muxers can't write the size in advance) are supported.
+    * Unsupported/unused elements (Cues, SeekHead, Tags, ...) are skipped without buffering them.
+    */
+    class WebMStream
+    {
+        public:
+            unsigned int m_nWidth; //!< video width
+            unsigned int m_nHeight; //!< video height
+
+            /**
+            * @brief Start demuxing and wait for the stream header (tracks)
+            * @param infile input, can't be seeked
+            * @param fTimeout seconds to wait for the header
+            * @return success (EXIT_SUCCESS), fails if the input isn't WebM/VP8
+            */
+            int open( FILE* infile, float fTimeout = WEBM_STREAM_TIMEOUT );
+
+            /**
+            * @brief Read the data that arrived without blocking and demux it into the jitter buffer
+            * @return frames waiting in the jitter buffer, -1 on invalid data
+            */
+            int pump();
+
+            /**
+            * @brief Take the oldest frame from the jitter buffer
+            * @param[out] buf frame data (valid until the next call)
+            * @param[out] buf_sz frame size
+            * @param[out] fTimeStamp presentation timestamp in seconds
+            * @return frame available
+            */
+            bool readFrame( uint8_t** buf, size_t* buf_sz, float* fTimeStamp );
+
+            /**
+            * @brief Framerate from the track default duration, else guessed from the timestamps that arrived so far
+            * @param[out] fps_den FPS denominator
+            * @param[out] fps_num FPS numerator
+            */
+            void getFramerate( unsigned int* fps_den, unsigned int* fps_num );
+
+            /**
+            * @brief Free all buffers
+            */
+            void close();
+
+            WebMStream()
+            {
+                m_infile = NULL;
+                close();
+            }
+
+        private:
+            /**
+            * @brief Demuxed frame waiting for the decoder
+            */
+            struct SFrame
+            {
+                std::vector<uint8_t> data;
+                uint64_t tstamp; //!< nanoseconds
+            };
+
+            /**
+            * @brief Open master element
+            */
+            struct SLevel
+            {
+                uint32_t id;
+                uint64_t end; //!< absolute end offset, ~0 for unknown size
+            };
+
+            FILE* m_infile;
+
+            std::vector<uint8_t> m_vecData; //!< received data that isn't parsed yet
+            size_t m_nRead; //!< parsed bytes of m_vecData
+            uint64_t m_nOffset; //!< absolute stream offset of m_vecData[0]
+            uint64_t m_nSkip; //!< bytes of a skipped element that didn't arrive yet
+
+            std::vector<SLevel> m_vecLevels; //!< open master elements (segment, cluster, block group)
+
+            bool m_bHeader; //!< tracks were parsed
+            uint64_t m_nVideoTrack; //!< track number of the VP8 track
+            uint64_t m_nTimecodeScale; //!< nanoseconds per timecode
+            uint64_t m_nDefaultDuration; //!< nanoseconds per frame (0 if unknown)
+            uint64_t m_nClusterTime; //!< timecode of the current cluster
+
+            std::deque<SFrame> m_queFrames; //!< jitter buffer
+            size_t m_nQueuedBytes; //!< bytes in the jitter buffer
+            std::vector< std::vector<uint8_t> > m_vecFree; //!< recycled frame buffers
+            std::vector<uint8_t> m_vecCurrent; //!< frame handed to the decoder
+
+            unsigned m_nGuessFrames; //!< frames used for framerate guessing
+            uint64_t m_nGuessFirst, m_nGuessLast; //!< timestamp range used for framerate guessing
+
+            int parse();
+            bool parseInfo( const uint8_t* data, uint64_t size );
+            bool parseTracks( const uint8_t* data, uint64_t size );
+            bool parseBlock( const uint8_t* data, uint64_t size );
+            void queueFrame( const uint8_t* data, size_t size, uint64_t tstamp );
+    };
+}
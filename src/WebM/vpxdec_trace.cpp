@@ -0,0 +1,164 @@
+/* Videoplayer_Plugin - for licensing and copyright see license.txt */
+
+#include <stdlib.h>
+#include <vpx_ports/vpx_timer.h>
+
+#include "vpxdec_trace.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#define VPXDEC_THREADLOCAL __declspec(thread)
+#else
+#include <pthread.h>
+#define VPXDEC_THREADLOCAL __thread
+#endif
+
+namespace VideoplayerPlugin
+{
+    /**
+    * @brief Completed scope
+    */
+    struct SVPXDecTraceEvent
+    {
+        const char* sName;
+        long long nBegin; //!< microseconds since the capture started
+        long long nDuration; //!< microseconds
+        unsigned long long nThread;
+        int nTag;
+        volatile long nGeneration; //!< written last, events of other captures or still being written are skipped
+    };
+
+    volatile long nVPXDecTraceCapture = 0;
+
+    static SVPXDecTraceEvent* pTraceEvents = NULL; //!< kept for the lifetime of the process (late scopes may still write)
+    static volatile long nTraceCount = 0; //!< events claimed in the buffer (can exceed its size)
+    static long nTraceGeneration = 0; //!< generation of the last capture
+    static vpx_usec_timer tTraceStart; //!< time the capture started
+    static VPXDEC_THREADLOCAL int nTraceTag = -1; //!< tag of the innermost scope of this thread
+
+    static long atomicIncrement( volatile long* pValue )
+    {
+#if defined(_WIN32)
+        return InterlockedIncrement( pValue );
+#else
+        return __sync_add_and_fetch( pValue, 1 );
+#endif
+    }
+
+    static unsigned long long currentThread()
+    {
+#if defined(_WIN32)
+        return GetCurrentThreadId();
+#else
+        return ( unsigned long long )pthread_self();
+#endif
+    }
+
+    static long long traceTime()
+    {
+        vpx_usec_timer tNow = tTraceStart;
+        vpx_usec_timer_mark( &tNow );
+        return vpx_usec_timer_elapsed( &tNow );
+    }
+
+    void startVPXDecTrace()
+    {
+        if ( !pTraceEvents )
+        {
+            pTraceEvents = ( SVPXDecTraceEvent* )calloc( VPXDEC_TRACE_EVENTS, sizeof( SVPXDecTraceEvent ) );
+
+            if ( !pTraceEvents )
+            {
+                return;
+            }
+        }
+
+        nVPXDecTraceCapture = 0;
+        nTraceCount = 0;
+        vpx_usec_timer_start( &tTraceStart );
+        nTraceGeneration = nTraceGeneration + 1 > 0 ? nTraceGeneration + 1 : 1;
+        nVPXDecTraceCapture = nTraceGeneration;
+    }
+
+    void stopVPXDecTrace()
+    {
+        nVPXDecTraceCapture = 0;
+    }
+
+    unsigned getVPXDecTraceDropped()
+    {
+        return nTraceCount > VPXDEC_TRACE_EVENTS ? unsigned( nTraceCount - VPXDEC_TRACE_EVENTS ) : 0;
+    }
+
+    unsigned writeVPXDecTrace( FILE* pFile )
+    {
+        if ( !pFile )
+        {
+            return 0;
+        }
+
+        unsigned nEvents = 0;
+        long nCount = nTraceCount < VPXDEC_TRACE_EVENTS ? nTraceCount : VPXDEC_TRACE_EVENTS;
+
+        fprintf( pFile, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n" );
+        fprintf( pFile, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"Videoplayer\"}}" );
+
+        for ( long i = 0; pTraceEvents && i < nCount; ++i )
+        {
+            const SVPXDecTraceEvent& e = pTraceEvents[i];
+
+            if ( e.nGeneration != nTraceGeneration )
+            {
+                continue;
+            }
+
+            fprintf( pFile, ",\n{\"name\":\"%s\",\"cat\":\"video\",\"ph\":\"X\",\"pid\":1,\"tid\":%llu,\"ts\":%lld,\"dur\":%lld", e.sName, e.nThread, e.nBegin, e.nDuration );
+
+            if ( e.nTag >= 0 )
+            {
+                fprintf( pFile, ",\"args\":{\"video\":%d}", e.nTag );
+            }
+
+            fprintf( pFile, "}" );
+            ++nEvents;
+        }
+
+        fprintf( pFile, "\n]}\n" );
+        return nEvents;
+    }
+
+    void CVPXDecTraceScope::begin( const char* sName, int nTag )
+    {
+        m_sName = sName;
+        m_nOuterTag = nTraceTag;
+        m_nTag = nTag >= 0 ? nTag : nTraceTag;
+        nTraceTag = m_nTag;
+        m_nBegin = traceTime();
+    }
+
+    void CVPXDecTraceScope::end()
+    {
+        nTraceTag = m_nOuterTag;
+
+        // the capture stopped or restarted meanwhile
+        if ( m_nGeneration != nVPXDecTraceCapture )
+        {
+            return;
+        }
+
+        long nIndex = atomicIncrement( &nTraceCount ) - 1;
+
+        if ( nIndex >= VPXDEC_TRACE_EVENTS )
+        {
+            return;
+        }
+
+        SVPXDecTraceEvent& e = pTraceEvents[nIndex];
+        e.sName = m_sName;
+        e.nBegin = m_nBegin;
+        e.nDuration = traceTime() - m_nBegin;
+        e.nThread = currentThread();
+        e.nTag = m_nTag;
+        e.nGeneration = m_nGeneration;
+    }
+}
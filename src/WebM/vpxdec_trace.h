@@ -0,0 +1,82 @@
+/* Videoplayer_Plugin - for licensing and copyright see license.txt */
+
+#include <stdio.h>
+
+#pragma once
+
+#define VPXDEC_TRACE_EVENTS (256 * 1024) //!< maximal events of one capture (the buffer is allocated by the first capture)
+
+namespace VideoplayerPlugin
+{
+    extern volatile long nVPXDecTraceCapture; //!< generation of the running capture, 0 while not capturing
+
+    /**
+    * @brief Start capturing trace events (discards the events of the last capture)
+    */
+    void startVPXDecTrace();
+
+    /**
+    * @brief Stop capturing trace events
+    */
+    void stopVPXDecTrace();
+
+    /**
+    * @brief Write the events of the last capture as Chrome trace event JSON (chrome://tracing)
+    * @param pFile output opened for writing
+    * @return events written
+    */
+    unsigned writeVPXDecTrace( FILE* pFile );
+
+    /**
+    * @brief Events of the last capture that didn't fit into the buffer
+    */
+    unsigned getVPXDecTraceDropped();
+
+    /**
+    * @brief Records the duration of a scope as trace event while capturing
+    * Costs a single check while not capturing. Nested scopes without a tag inherit the tag of the enclosing scope on the same thread.
+    * @see VPXDEC_TRACE
+    */
+    class CVPXDecTraceScope
+    {
+        public:
+            CVPXDecTraceScope( const char* sName, int nTag = -1 )
+            {
+                m_nGeneration = nVPXDecTraceCapture;
+
+                if ( m_nGeneration )
+                {
+                    begin( sName, nTag );
+                }
+            }
+
+            ~CVPXDecTraceScope()
+            {
+                if ( m_nGeneration )
+                {
+                    end();
+                }
+            }
+
+        private:
+            long m_nGeneration; //!< capture the scope began in (0 if none)
+            const char* m_sName; //!< event name (static string)
+            int m_nTag; //!< video id (-1 none)
+            int m_nOuterTag; //!< tag of the enclosing scope
+            long long m_nBegin; //!< microseconds since the capture started
+
+            void begin( const char* sName, int nTag );
+            void end();
+    };
+}
+
+#if defined(VP_DISABLE_TRACE)
+#define VPXDEC_TRACE( sName, nTag )
+#else
+/**
+* @brief Trace the rest of the current scope
+* @param sName static event name
+* @param nTag video id (-1 inherits the tag of the enclosing scope)
+*/
+#define VPXDEC_TRACE( sName, nTag ) VideoplayerPlugin::CVPXDecTraceScope vpxdecTraceScope( sName, nTag )
+#endif
@@ -0,0 +1,370 @@
+/* Videoplayer_Plugin - for licensing and copyright see license.txt */
+
+// vpbench - plays videos with the standalone decode library (no engine) and reports decode/convert performance
+// usage: vpbench [-n copies] [-f maxframes] [-rgba] [-noconvert] [-checksum] [-trace file.json] file.webm [file2.webm ...]
+
+#include <WebM/vpxdec_ext.h>
+#include <Renderer/CVideoRendererNull.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <sys/resource.h>
+#endif
+
+using namespace VideoplayerPlugin;
+
+#define MICROSECOND 1000000.0 //!< Microseconds in a second
+#define MILLISECOND 1000.0 //!< Milliseconds in a second
+
+/**
+* @brief Options of a benchmark run
+*/
+struct SBenchOptions
+{
+    unsigned nCopies; //!< each file is played this many times concurrently
+    unsigned nMaxFrames; //!< stop each stream after x frames (0 = until the end)
+    bool bConvert; //!< convert the frames with the null renderer of the plugin
+    bool bChecksum; //!< checksum the converted frames (vp_nullchecksum)
+    eByteOrder eOrder; //!< conversion byte order
+    const char* sTrace; //!< write a Chrome trace of the run to this file (NULL = off)
+
+    SBenchOptions()
+    {
+        sTrace = NULL;
+        nCopies = 1;
+        nMaxFrames = 0;
+        bConvert = true;
+        bChecksum = false;
+        eOrder = VBO_BGRA;
+    }
+};
+
+/**
+* @brief Result of one stream
+*/
+struct SBenchStream
+{
+    std::string sFile; //!< played file
+    int nId; //!< stream index (trace tag)
+    bool bOpened; //!< file could be opened
+    unsigned nWidth; //!< video width
+    unsigned nHeight; //!< video height
+    unsigned nFrames; //!< frames decoded and output
+    double fDecodeTime; //!< total decode time in seconds
+    double fConvertTime; //!< total conversion time in seconds
+    uint32_t nChecksum; //!< checksum of all converted frames (0 if disabled)
+    std::vector<float> vecFrameTimes; //!< decode + convert time of each frame in milliseconds
+
+    SBenchStream()
+    {
+        nId = -1;
+        bOpened = false;
+        nWidth = 0;
+        nHeight = 0;
+        nFrames = 0;
+        fDecodeTime = 0;
+        fConvertTime = 0;
+        nChecksum = 0;
+    }
+};
+
+/**
+* @brief Decode (and convert) a single stream as fast as possible
+*/
+static void runStream( SBenchStream* pStream, const SBenchOptions* pOptions )
+{
+    VPXDec decoder;
+
+    if ( decoder.open( ( char* )pStream->sFile.c_str() ) != EXIT_SUCCESS )
+    {
+        return;
+    }
+
+    pStream->bOpened = true;
+    decoder.m_nTraceTag = pStream->nId;
+    pStream->nWidth = decoder.m_nWidth;
+    pStream->nHeight = decoder.m_nHeight;
+
+    // the renderer of headless runs converts each frame into its memory without uploading it
+    CVideoRendererNull* pRenderer = NULL;
+
+    if ( pOptions->bConvert )
+    {
+        pRenderer = new CVideoRendererNull();
+
+        if ( !pRenderer->CreateResources( decoder.m_nWidth, decoder.m_nHeight, decoder.m_nWidth, decoder.m_nHeight ) )
+        {
+            pRenderer->Release();
+            pRenderer = NULL;
+        }
+
+        else
+        {
+            pRenderer->SetTraceTag( pStream->nId );
+        }
+    }
+
+    float fLastPos = -1;
+
+    while ( decoder.isOpen() && ( !pOptions->nMaxFrames || pStream->nFrames < pOptions->nMaxFrames ) )
+    {
+        vpx_image_t* img = NULL;
+        bool bDirty = false;
+
+        vpx_usec_timer tFrame;
+        vpx_usec_timer_start( &tFrame );
+
+        if ( decoder.readFrame( &img, bDirty ) != EXIT_SUCCESS )
+        {
+            break;
+        }
+
+        vpx_usec_timer_mark( &tFrame );
+        double fDecode = double( vpx_usec_timer_elapsed( &tFrame ) ) / MICROSECOND;
+        pStream->fDecodeTime += fDecode;
+
+        // without looping the position stops moving at the end
+        if ( !bDirty || !img )
+        {
+            if ( decoder.getPosition() == fLastPos )
+            {
+                break;
+            }
+
+            fLastPos = decoder.getPosition();
+            continue;
+        }
+
+        fLastPos = decoder.getPosition();
+
+        double fConvert = 0;
+
+        if ( pRenderer )
+        {
+            vpx_usec_timer_start( &tFrame );
+            pRenderer->RenderFrame( img );
+            vpx_usec_timer_mark( &tFrame );
+            fConvert = double( vpx_usec_timer_elapsed( &tFrame ) ) / MICROSECOND;
+            pStream->fConvertTime += fConvert;
+        }
+
+        ++pStream->nFrames;
+        pStream->vecFrameTimes.push_back( float( ( fDecode + fConvert ) * MILLISECOND ) );
+    }
+
+    if ( pRenderer )
+    {
+        unsigned nConverted;
+        float fConvertAvg, fConvertMax;
+        pStream->nChecksum = pRenderer->GetStats( nConverted, fConvertAvg, fConvertMax );
+        pRenderer->Release();
+    }
+}
+
+/**
+* @brief Peak memory of the process
+* @return kilobytes
+*/
+static unsigned long getPeakMemory()
+{
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS pmc;
+
+    if ( GetProcessMemoryInfo( GetCurrentProcess(), &pmc, sizeof( pmc ) ) )
+    {
+        return ( unsigned long )( pmc.PeakWorkingSetSize >> 10 );
+    }
+
+    return 0;
+#else
+    struct rusage usage;
+
+    if ( getrusage( RUSAGE_SELF, &usage ) == 0 )
+    {
+        return ( unsigned long )usage.ru_maxrss; // kilobytes on linux
+    }
+
+    return 0;
+#endif
+}
+
+/**
+* @brief Value at a percentile of sorted values
+*/
+static float percentile( const std::vector<float>& vecSorted, float fPercent )
+{
+    if ( vecSorted.empty() )
+    {
+        return 0;
+    }
+
+    size_t nIndex = size_t( fPercent / 100.0f * ( vecSorted.size() - 1 ) + 0.5f );
+    return vecSorted[std::min( nIndex, vecSorted.size() - 1 )];
+}
+
+static void usage()
+{
+    fprintf( stderr, "usage: vpbench [-n copies] [-f maxframes] [-rgba] [-noconvert] [-checksum] [-trace file.json] file.webm [file2.webm ...]\n" );
+    fprintf( stderr, "  -n copies    play each file this many times concurrently (default 1)\n" );
+    fprintf( stderr, "  -f frames    stop each stream after this many frames (default until the end)\n" );
+    fprintf( stderr, "  -rgba        convert to RGBA (DX11) instead of BGRA (DX9)\n" );
+    fprintf( stderr, "  -noconvert   only decode\n" );
+    fprintf( stderr, "  -checksum    checksum the converted frames (Adler-32, compare runs or builds)\n" );
+    fprintf( stderr, "  -trace file  write a Chrome trace event file of the run (chrome://tracing)\n" );
+}
+
+int main( int argc, char** argv )
+{
+    SBenchOptions options;
+    std::vector<std::string> vecFiles;
+
+    for ( int i = 1; i < argc; ++i )
+    {
+        if ( !strcmp( argv[i], "-n" ) && i + 1 < argc )
+        {
+            options.nCopies = std::max( atoi( argv[++i] ), 1 );
+        }
+
+        else if ( !strcmp( argv[i], "-f" ) && i + 1 < argc )
+        {
+            options.nMaxFrames = std::max( atoi( argv[++i] ), 0 );
+        }
+
+        else if ( !strcmp( argv[i], "-rgba" ) )
+        {
+            options.eOrder = VBO_RGBA;
+        }
+
+        else if ( !strcmp( argv[i], "-noconvert" ) )
+        {
+            options.bConvert = false;
+        }
+
+        else if ( !strcmp( argv[i], "-checksum" ) )
+        {
+            options.bChecksum = true;
+        }
+
+        else if ( !strcmp( argv[i], "-trace" ) && i + 1 < argc )
+        {
+            options.sTrace = argv[++i];
+        }
+
+        else if ( argv[i][0] == '-' )
+        {
+            usage();
+            return EXIT_FAILURE;
+        }
+
+        else
+        {
+            vecFiles.push_back( argv[i] );
+        }
+    }
+
+    if ( vecFiles.empty() )
+    {
+        usage();
+        return EXIT_FAILURE;
+    }
+
+    // the null renderer takes its settings from globals instead of the engine (set before any stream starts)
+    eStandaloneByteOrder = options.eOrder;
+    nStandaloneChecksum = options.bChecksum ? 1 : 0;
+
+    // one thread per stream, like concurrently playing videos
+    std::vector<SBenchStream> vecStreams( vecFiles.size() * options.nCopies );
+
+    for ( size_t i = 0; i < vecStreams.size(); ++i )
+    {
+        vecStreams[i].sFile = vecFiles[i % vecFiles.size()];
+        vecStreams[i].nId = int( i );
+    }
+
+    if ( options.sTrace )
+    {
+        startVPXDecTrace();
+    }
+
+    vpx_usec_timer tWall;
+    vpx_usec_timer_start( &tWall );
+
+    std::vector<std::thread> vecThreads;
+
+    for ( size_t i = 0; i < vecStreams.size(); ++i )
+    {
+        vecThreads.push_back( std::thread( runStream, &vecStreams[i], &options ) );
+    }
+
+    for ( size_t i = 0; i < vecThreads.size(); ++i )
+    {
+        vecThreads[i].join();
+    }
+
+    vpx_usec_timer_mark( &tWall );
+
+    if ( options.sTrace )
+    {
+        stopVPXDecTrace();
+
+        FILE* pTrace = fopen( options.sTrace, "w" );
+
+        if ( pTrace )
+        {
+            unsigned nEvents = writeVPXDecTrace( pTrace );
+            fclose( pTrace );
+            printf( "trace events(%u) dropped(%u) file(%s)\n", nEvents, getVPXDecTraceDropped(), options.sTrace );
+        }
+    }
+
+    double fWallTime = double( vpx_usec_timer_elapsed( &tWall ) ) / MICROSECOND;
+
+    // report
+    unsigned nFrames = 0;
+    double fDecodeTime = 0;
+    double fConvertTime = 0;
+    std::vector<float> vecFrameTimes;
+    int nRet = EXIT_SUCCESS;
+
+    printf( "%-4s %-32s %11s %7s %10s %10s %8s\n", "id", "file", "size", "frames", "decode fps", "convert fps", "checksum" );
+
+    for ( size_t i = 0; i < vecStreams.size(); ++i )
+    {
+        const SBenchStream& stream = vecStreams[i];
+
+        if ( !stream.bOpened )
+        {
+            printf( "%-4u %-32s failed to open\n", unsigned( i ), stream.sFile.c_str() );
+            nRet = EXIT_FAILURE;
+            continue;
+        }
+
+        printf( "%-4u %-32s %5ux%-5u %7u %10.1f %10.1f %08x\n", unsigned( i ), stream.sFile.c_str(), stream.nWidth, stream.nHeight, stream.nFrames,
+                stream.fDecodeTime > 0 ? stream.nFrames / stream.fDecodeTime : 0.0, stream.fConvertTime > 0 ? stream.nFrames / stream.fConvertTime : 0.0, stream.nChecksum );
+
+        nFrames += stream.nFrames;
+        fDecodeTime += stream.fDecodeTime;
+        fConvertTime += stream.fConvertTime;
+        vecFrameTimes.insert( vecFrameTimes.end(), stream.vecFrameTimes.begin(), stream.vecFrameTimes.end() );
+    }
+
+    std::sort( vecFrameTimes.begin(), vecFrameTimes.end() );
+
+    printf( "\nstreams(%u) frames(%u) wall(%.2fs) throughput(%.1ffps)\n", unsigned( vecStreams.size() ), nFrames, fWallTime, fWallTime > 0 ? nFrames / fWallTime : 0.0 );
+    printf( "decode(%.1ffps per stream) convert(%.1ffps per stream)\n", fDecodeTime > 0 ? nFrames / fDecodeTime : 0.0, fConvertTime > 0 ? nFrames / fConvertTime : 0.0 );
+    printf( "frame time p50(%.2fms) p90(%.2fms) p99(%.2fms) max(%.2fms)\n", percentile( vecFrameTimes, 50 ), percentile( vecFrameTimes, 90 ), percentile( vecFrameTimes, 99 ), percentile( vecFrameTimes, 100 ) );
+    printf( "peak memory(%luKB)\n", getPeakMemory() );
+
+    return nRet;
+}